@@ -19,12 +19,14 @@ Timothy Wood, April 2020
 #include "al/ui/al_PickableManager.hpp"
 #include "al/math/al_Random.hpp"
 
+#include "PointTree.h"
+
 using namespace al;
 
 // inherit from PickableBB
 struct CustomPickableBB : PickableBB {
 
-  std::vector<Vec3f> data;
+  PointTree data; // Indexed so picking doesn't test every point
   Mesh mesh;
   const float meshSize{ 0.02f };
   int hoverIndex, selectIndex;
@@ -37,16 +39,8 @@ struct CustomPickableBB : PickableBB {
     
     Hit intersect(Rayd r){
       auto ray = transformRayLocal(r);
-      double minT = std::numeric_limits<double>::max();
-      int minIndex = -1;
-      for (int i = 0; i < p->data.size(); i++) {
-        Vec3f& v = p->data[i];
-        auto t = ray.intersectSphere(v, p->meshSize);
-        if (t < minT && t > 0) {
-          minT = t;
-          minIndex = i;
-        }
-      }
+      // The closest sphere the ray hits, as intersectSphere() on every point
+      int minIndex = p->data.intersect(ray.o, ray.d).index;
       if (minIndex != -1) {
         return Hit(true, r, minIndex, this);
       } else
@@ -77,8 +71,9 @@ struct CustomPickableBB : PickableBB {
     addSphere(mesh, meshSize); // initialize mesh we will use to draw data points
 
     // generate random data points
+    data.radius(meshSize);
     for(int i=0; i < 100; i++){
-      data.push_back(Vec3f(rnd::uniform(), rnd::uniform(), rnd::uniform()));
+      data.insert(Vec3f(rnd::uniform(), rnd::uniform(), rnd::uniform()));
     }
   }
 
@@ -0,0 +1,164 @@
+// Picking speed of PointTree.h against the number of points
+//
+// Places points uniformly in the unit cube, with spheres sized like those of
+// customPickable.cpp scaled to the point density, and times:
+//  - "build": PointTree::build() on all points, and "insert" adding them
+//    one at a time, in microseconds per point,
+//  - ray picks from random points around the cube towards random points in
+//    it, as a mouse over the data would cast them, with the loop over every
+//    point that DataPickable::intersect() used to run ("loop") and with the
+//    tree ("tree"),
+//  - the nearest point to random points in the cube, the same two ways.
+// Rates are queries per second. "wrong" counts tree answers that differ
+// from the loop's.
+//
+// Usage (from the bin folder):
+//   point_tree_bench [seconds]
+//
+//   seconds  time spent per point count and query (default: 1)
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "al/math/al_Ray.hpp"
+#include "al/math/al_Vec.hpp"
+
+#include "PointTree.h"
+
+using namespace al;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed(Clock::time_point begin) {
+  return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// Runs query(i) for i = 0, 1, ... until seconds pass, returns queries/s
+template <class Query> double queryRate(double seconds, Query query) {
+  auto begin = Clock::now();
+  size_t n = 0;
+  do {
+    for (int k = 0; k < 16; k++) {
+      query(n++);
+    }
+  } while (elapsed(begin) < seconds);
+  return n / elapsed(begin);
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 1.0;
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> uniform(0, 1);
+  auto randomPoint = [&]() {
+    return Vec3f(uniform(random), uniform(random), uniform(random));
+  };
+
+  // Queries, the same for every point count
+  const int numQueries = 4096;
+  std::vector<Rayd> rays(numQueries);
+  std::vector<Vec3f> targets(numQueries);
+  for (int i = 0; i < numQueries; i++) {
+    // From within 3 cube widths of the center
+    Vec3f from = Vec3f(0.5f) + (randomPoint() - Vec3f(0.5f)) * 6;
+    Vec3f at = randomPoint();
+    rays[i] = Rayd(Vec3d(from.x, from.y, from.z),
+                   Vec3d(at.x - from.x, at.y - from.y, at.z - from.z));
+    targets[i] = randomPoint();
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(9) << "points" << std::setw(9) << "build"
+            << std::setw(9) << "insert" << std::setw(12) << "ray loop"
+            << std::setw(12) << "ray tree" << std::setw(7) << "wrong"
+            << std::setw(12) << "near loop" << std::setw(12) << "near tree"
+            << std::setw(7) << "wrong" << std::endl;
+
+  for (size_t n : {size_t(10000), size_t(100000), size_t(1000000)}) {
+    std::vector<Vec3f> data(n);
+    for (auto &p : data) {
+      p = randomPoint();
+    }
+    float radius = 0.02f * std::cbrt(100.0f / n);
+
+    PointTree tree;
+    tree.radius(radius);
+    auto begin = Clock::now();
+    tree.build(data.data(), n);
+    double build = elapsed(begin) * 1e6 / n;
+
+    PointTree inserted;
+    inserted.radius(radius);
+    begin = Clock::now();
+    for (auto &p : data) {
+      inserted.insert(p);
+    }
+    double insert = elapsed(begin) * 1e6 / n;
+
+    // The old DataPickable::intersect()
+    auto loopRay = [&](size_t q) {
+      Rayd ray = rays[q % numQueries];
+      double minT = std::numeric_limits<double>::max();
+      int minIndex = -1;
+      for (size_t i = 0; i < n; i++) {
+        auto t = ray.intersectSphere(Vec3d(data[i].x, data[i].y, data[i].z),
+                                     radius);
+        if (t < minT && t > 0) {
+          minT = t;
+          minIndex = int(i);
+        }
+      }
+      return minIndex;
+    };
+    auto loopNearest = [&](size_t q) {
+      const Vec3f &p = targets[q % numQueries];
+      double minD = std::numeric_limits<double>::max();
+      int minIndex = -1;
+      for (size_t i = 0; i < n; i++) {
+        double d = (data[i] - p).magSqr();
+        if (d < minD) {
+          minD = d;
+          minIndex = int(i);
+        }
+      }
+      return minIndex;
+    };
+
+    int sink = 0;
+    double rayLoop = queryRate(seconds, [&](size_t q) { sink += loopRay(q); });
+    double rayTree = queryRate(seconds, [&](size_t q) {
+      sink += tree.intersect(rays[q % numQueries].o, rays[q % numQueries].d)
+                  .index;
+    });
+    double nearLoop =
+        queryRate(seconds, [&](size_t q) { sink += loopNearest(q); });
+    double nearTree = queryRate(seconds, [&](size_t q) {
+      sink += tree.nearest(targets[q % numQueries]).index;
+    });
+
+    // Check a few hundred queries on both trees against the loops
+    int rayWrong = 0, nearWrong = 0;
+    for (size_t q = 0; q < 256; q++) {
+      int expected = loopRay(q);
+      rayWrong += tree.intersect(rays[q].o, rays[q].d).index != expected;
+      rayWrong += inserted.intersect(rays[q].o, rays[q].d).index != expected;
+      expected = loopNearest(q);
+      nearWrong += tree.nearest(targets[q]).index != expected;
+      nearWrong += inserted.nearest(targets[q]).index != expected;
+    }
+
+    std::cout << std::setw(9) << n << std::setw(9) << build << std::setw(9)
+              << insert << std::setw(12) << rayLoop << std::setw(12)
+              << rayTree << std::setw(7) << rayWrong << std::setw(12)
+              << nearLoop << std::setw(12) << nearTree << std::setw(7)
+              << nearWrong << (sink == 42 ? " " : "") << std::endl;
+  }
+  std::cout << std::endl << "build and insert in microseconds per point"
+            << std::endl;
+  return 0;
+}
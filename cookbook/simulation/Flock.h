@@ -0,0 +1,212 @@
+#pragma once
+#ifndef Flock_H
+#define Flock_H
+
+// The flock of flocking.cpp, for flocks of many thousands of boids.
+//
+// Comparing every pair of boids costs N^2 / 2 interactions per step, which
+// stops being interactive at a few thousand boids. Both interactions fall
+// off as Gaussians, exp(-(d / radius)^2), which are below 1e-4 past three
+// radii. So the flock ignores pairs further apart than cutoff(), three times
+// the larger of pushRadius and matchRadius. Every step the boids are sorted
+// into a uniform grid of cutoff() sized cells, and each boid only looks at
+// the boids in its own cell and the 8 around it.
+//
+// Boids are stored as separate arrays of x, y, vx and vy. Each boid's
+// interactions are summed from the positions and velocities at the start of
+// the step, so boids can be updated in any order and in parallel. The
+// velocity matching is the same weighted average as before, with the weights
+// of all neighbors normalized so they never add up to more than 1.
+//
+// The random hunting motion uses al::rnd, so it runs on the calling thread.
+//
+// Usage:
+//   Flock flock;
+//   flock.resize(10000);
+//   flock.size = std::sqrt(10000 / 32.0); // Keep the density of 32 boids
+//   flock.reset();
+//   ...
+//   flock.step(dt);                       // In onAnimate()
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "al/math/al_Random.hpp"
+#include "al/math/al_Vec.hpp"
+
+#include "ParallelFor.h"
+
+class Flock {
+public:
+  // Collision avoidance
+  float pushRadius{0.05f};
+  float pushStrength{1.0f};
+  // Velocity matching
+  float matchRadius{0.125f};
+  // Random "hunting" motion
+  float huntUrge{0.2f};
+  // Boids are kept inside [-size, size] on both axes
+  float size{1.0f};
+
+  std::vector<float> x, y, vx, vy;
+
+  // numThreads includes the calling thread. 0 uses one per core.
+  explicit Flock(unsigned int numThreads = 0) : mParallel(numThreads) {}
+
+  void resize(size_t count) {
+    x.resize(count);
+    y.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+  }
+
+  size_t count() const { return x.size(); }
+
+  void threads(unsigned int numThreads) { mParallel.threads(numThreads); }
+
+  // Randomizes positions uniformly inside a disc of radius size, and
+  // velocities inside the unit disc
+  void reset() {
+    for (size_t i = 0; i < count(); i++) {
+      auto pos = al::rnd::ball<al::Vec2f>() * size;
+      auto vel = al::rnd::ball<al::Vec2f>();
+      x[i] = pos.x;
+      y[i] = pos.y;
+      vx[i] = vel.x;
+      vy[i] = vel.y;
+    }
+  }
+
+  // Distance past which boids don't interact
+  float cutoff() const { return 3.0f * std::max(pushRadius, matchRadius); }
+
+  void step(double dt) {
+    sortIntoGrid();
+    interact();
+    hunt();
+    for (size_t i = 0; i < count(); i++) {
+      x[i] += vx[i] * float(dt);
+      y[i] += vy[i] * float(dt);
+    }
+  }
+
+private:
+  // Counting sort of the boids by cell. mStart[c] is the first sorted boid of
+  // cell c, and the sorted copies of the boid arrays are laid out so that
+  // each cell's boids are contiguous.
+  void sortIntoGrid() {
+    mCellSize = cutoff();
+    mCells = std::max(1, int(std::ceil(2.0f * size / mCellSize)));
+    size_t n = count();
+    mCell.resize(n);
+    mStart.assign(size_t(mCells) * mCells + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+      mCell[i] = cellX(x[i]) + mCells * cellX(y[i]);
+      mStart[mCell[i] + 1]++;
+    }
+    for (size_t c = 1; c < mStart.size(); c++) {
+      mStart[c] += mStart[c - 1];
+    }
+    mOrder.resize(n);
+    mSx.resize(n);
+    mSy.resize(n);
+    mSvx.resize(n);
+    mSvy.resize(n);
+    mFill.assign(mStart.begin(), mStart.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+      int s = mFill[mCell[i]]++;
+      mOrder[s] = int(i);
+      mSx[s] = x[i];
+      mSy[s] = y[i];
+      mSvx[s] = vx[i];
+      mSvy[s] = vy[i];
+    }
+  }
+
+  int cellX(float v) const {
+    int c = int((v + size) / mCellSize);
+    return std::min(std::max(c, 0), mCells - 1);
+  }
+
+  // Sums each boid's push and velocity matching over its neighbors, in
+  // parallel, and writes the results back in the original order
+  void interact() {
+    const float cutoff2 = mCellSize * mCellSize;
+    const float pushCutoff2 = 9.0f * pushRadius * pushRadius;
+    const float invPush2 = 1.0f / (pushRadius * pushRadius);
+    const float invMatch2 = 1.0f / (matchRadius * matchRadius);
+    mParallel(count(), 512, [&](size_t begin, size_t end) {
+      for (size_t s = begin; s < end; s++) {
+        float xi = mSx[s], yi = mSy[s], vxi = mSvx[s], vyi = mSvy[s];
+        int cell = mCell[mOrder[s]];
+        int cx = cell % mCells, cy = cell / mCells;
+        float px = 0, py = 0;          // Push
+        float mx = 0, my = 0, w = 0;   // Velocity matching
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, mCells - 1);
+             ny++) {
+          for (int nx = std::max(cx - 1, 0);
+               nx <= std::min(cx + 1, mCells - 1); nx++) {
+            int c = nx + mCells * ny;
+            for (int j = mStart[c]; j < mStart[c + 1]; j++) {
+              float dx = xi - mSx[j], dy = yi - mSy[j];
+              float d2 = dx * dx + dy * dy;
+              if (d2 >= cutoff2 || size_t(j) == s) {
+                continue;
+              }
+              float nearness = 0.5f * std::exp(-d2 * invMatch2);
+              mx += nearness * (mSvx[j] - vxi);
+              my += nearness * (mSvy[j] - vyi);
+              w += nearness;
+              if (d2 < pushCutoff2 && d2 > 0) {
+                float push = std::exp(-d2 * invPush2) * pushStrength /
+                             std::sqrt(d2);
+                px += dx * push;
+                py += dy * push;
+              }
+              // TODO: Flock centering
+            }
+          }
+        }
+        float norm = 1.0f / std::max(w, 1.0f);
+        int i = mOrder[s];
+        x[i] = xi + px;
+        y[i] = yi + py;
+        vx[i] = vxi + mx * norm;
+        vy[i] = vyi + my * norm;
+      }
+    });
+  }
+
+  // Random walk and bouncing off the box
+  void hunt() {
+    for (size_t i = 0; i < count(); i++) {
+      auto hunt = al::rnd::ball<al::Vec2f>();
+      // Use cubed distribution to make small jumps more frequent
+      hunt *= hunt.magSqr();
+      vx[i] += hunt.x * huntUrge;
+      vy[i] += hunt.y * huntUrge;
+      if (x[i] > size || x[i] < -size) {
+        x[i] = x[i] > 0 ? size : -size;
+        vx[i] = -vx[i];
+      }
+      if (y[i] > size || y[i] < -size) {
+        y[i] = y[i] > 0 ? size : -size;
+        vy[i] = -vy[i];
+      }
+    }
+  }
+
+  ParallelFor mParallel;
+
+  // Grid
+  float mCellSize{1.0f};
+  int mCells{1};
+  std::vector<int> mCell;  // Cell of each boid
+  std::vector<int> mStart; // First sorted boid of each cell, and the total
+  std::vector<int> mFill;
+  std::vector<int> mOrder; // Original index of each sorted boid
+  std::vector<float> mSx, mSy, mSvx, mSvy;
+};
+
+#endif // Flock_H
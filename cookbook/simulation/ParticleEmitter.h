@@ -0,0 +1,183 @@
+#pragma once
+#ifndef ParticleEmitter_H
+#define ParticleEmitter_H
+
+// The emitter of particleSystem.cpp, for a million particles or more.
+//
+// Particles are stored as separate arrays per coordinate, so moving them is
+// a few straight loops over floats that run 4 or 8 particles at a time. The
+// particles are cut into chunks that are moved on all cores. Each chunk also
+// writes its particles' positions and colors to the caller's vertex and
+// color arrays while they are in cache. The caller allocates those arrays
+// once, for example a mesh resized to count() vertices, so nothing is
+// allocated per frame.
+//
+// New particles replace the oldest ones, in a ring. They are set up on the
+// calling thread, so emit() can use al::rnd.
+//
+// The colors get a noise value per particle and frame, from a hash of the
+// two. This keeps the flicker of calling rnd::uniform() per particle without
+// the shared random state.
+//
+// Usage:
+//   ParticleEmitter emitter;
+//   emitter.resize(1000000);
+//   mesh.vertices().resize(emitter.count());
+//   mesh.colors().resize(emitter.count());
+//   ...
+//   // In onAnimate()
+//   emitter.update(
+//       40, [&](size_t i) { emitter.x[i] = 0; ... }, // Set up new ones
+//       mesh.vertices().data(), mesh.colors().data(),
+//       [](float age, float noise) { return al::Color(1, 1, 1, 1 - age); });
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "al/graphics/al_Color.hpp"
+#include "al/math/al_Vec.hpp"
+
+#include "ParallelFor.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define EMITTER_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define EMITTER_NEON
+#endif
+
+namespace particles {
+
+// Semi-implicit Euler step of one coordinate: v += a, then p += v
+inline void integrate(float *p, float *v, const float *a, int n) {
+  int i = 0;
+#if defined(__AVX__)
+  for (; i + 8 <= n; i += 8) {
+    __m256 vel = _mm256_add_ps(_mm256_loadu_ps(v + i), _mm256_loadu_ps(a + i));
+    _mm256_storeu_ps(v + i, vel);
+    _mm256_storeu_ps(p + i, _mm256_add_ps(_mm256_loadu_ps(p + i), vel));
+  }
+#endif
+#if defined(EMITTER_SSE)
+  for (; i + 4 <= n; i += 4) {
+    __m128 vel = _mm_add_ps(_mm_loadu_ps(v + i), _mm_loadu_ps(a + i));
+    _mm_storeu_ps(v + i, vel);
+    _mm_storeu_ps(p + i, _mm_add_ps(_mm_loadu_ps(p + i), vel));
+  }
+#elif defined(EMITTER_NEON)
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t vel = vaddq_f32(vld1q_f32(v + i), vld1q_f32(a + i));
+    vst1q_f32(v + i, vel);
+    vst1q_f32(p + i, vaddq_f32(vld1q_f32(p + i), vel));
+  }
+#endif
+  for (; i < n; i++) {
+    v[i] += a[i];
+    p[i] += v[i];
+  }
+}
+
+// Uniform value in [0, 1) from a hash of particle and frame
+inline float noise(uint32_t particle, uint32_t frame) {
+  uint32_t h = particle * 0x9e3779b1u ^ frame * 0x85ebca6bu;
+  h ^= h >> 16;
+  h *= 0x7feb352du;
+  h ^= h >> 15;
+  h *= 0x846ca68bu;
+  h ^= h >> 16;
+  return float(h >> 8) * (1.0f / 16777216.0f);
+}
+
+} // namespace particles
+
+class ParticleEmitter {
+public:
+  // Position, velocity and acceleration
+  std::vector<float> x, y, z;
+  std::vector<float> vx, vy, vz;
+  std::vector<float> ax, ay, az;
+  // Frames times births per frame since emitted
+  std::vector<int> age;
+
+  // numThreads includes the calling thread. 0 uses one per core.
+  explicit ParticleEmitter(unsigned int numThreads = 0)
+      : mParallel(numThreads) {}
+
+  // Resizes to count particles, all at rest at the origin and old enough to
+  // be invisible
+  void resize(size_t count) {
+    for (auto *v : {&x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az}) {
+      v->assign(count, 0.0f);
+    }
+    age.assign(count, int(count));
+    mTap = 0;
+  }
+
+  size_t count() const { return x.size(); }
+
+  void threads(unsigned int numThreads) { mParallel.threads(numThreads); }
+
+  // Moves every particle one step and ages it by births. Then replaces the
+  // births oldest particles, calling emit(i) to set up each one. If vertices
+  // isn't null, also writes each particle's position there and
+  // shade(age / count(), noise) to colors.
+  template <class Emit, class Shade>
+  void update(int births, Emit &&emit, al::Vec3f *vertices, al::Color *colors,
+              Shade &&shade) {
+    size_t n = count();
+    if (n == 0) {
+      return;
+    }
+    const float ageScale = 1.0f / n;
+    mFrame++;
+    auto write = [&](size_t i) {
+      vertices[i] = al::Vec3f(x[i], y[i], z[i]);
+      colors[i] =
+          shade(age[i] * ageScale, particles::noise(uint32_t(i), mFrame));
+    };
+
+    mParallel(n, 4096, [&](size_t begin, size_t end) {
+      int len = int(end - begin);
+      particles::integrate(&x[begin], &vx[begin], &ax[begin], len);
+      particles::integrate(&y[begin], &vy[begin], &ay[begin], len);
+      particles::integrate(&z[begin], &vz[begin], &az[begin], len);
+      for (size_t i = begin; i < end; i++) {
+        age[i] += births;
+      }
+      if (vertices) {
+        for (size_t i = begin; i < end; i++) {
+          write(i);
+        }
+      }
+    });
+
+    for (int b = 0; b < births; b++) {
+      emit(mTap);
+      age[mTap] = 0;
+      if (vertices) {
+        write(mTap);
+      }
+      if (++mTap >= n) {
+        mTap = 0;
+      }
+    }
+  }
+
+  // Same, without writing positions and colors
+  template <class Emit> void update(int births, Emit &&emit) {
+    update(births, emit, nullptr, nullptr,
+           [](float, float) { return al::Color(); });
+  }
+
+private:
+  ParallelFor mParallel;
+  size_t mTap{0};      // Oldest particle
+  uint32_t mFrame{0};
+};
+
+#endif // ParticleEmitter_H
@@ -0,0 +1,289 @@
+#pragma once
+#ifndef WaveField_H
+#define WaveField_H
+
+// The wave equation of waveEquation.cpp, for grids of a few million cells.
+//
+// The field wraps around at its edges. Each plane has one halo cell around
+// it, and each step starts by copying the opposite edges into the halo. The
+// stencil can then read its left, right, lower and upper neighbors
+// everywhere without wrapping indices per cell, so a row is a single loop
+// that runs 4 or 8 cells at a time.
+//
+// Rows are split into tiles of rowsPerTile, which the threads take in any
+// order. A row of 2048 cells is 8 KB, so the three rows a tile reads and the
+// row it writes stay in cache, and splitting rows further wouldn't save
+// memory traffic.
+//
+// step() can also write the heights and normals of a surface mesh in the
+// same pass. The normal comes from the central differences of the heights
+// the stencil already loaded, so the mesh doesn't need generateNormals().
+// The mesh shows the field at the start of the step.
+//
+// Usage:
+//   WaveField field;
+//   field.resize(1024, 1024);
+//   field.spacing = 2.0f / (1024 - 1); // For addSurface(mesh, 1024, 1024)
+//   field.displace(i, j, 0.5f);        // Drop something in
+//   ...
+//   // In onAnimate()
+//   field.step(mesh.vertices().data(), mesh.normals().data());
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "al/math/al_Vec.hpp"
+
+#include "ParallelFor.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define WAVE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define WAVE_NEON
+#endif
+
+namespace wave {
+
+// Stencil constants for one step
+struct Coefficients {
+  float center; // decay * (2 - 4 * velocity)
+  float sides;  // decay * velocity
+  float decay;
+  float slope;  // 1 / (2 * spacing), 0 to skip normals
+};
+
+// Steps one row of n cells. below, row and above are the current field at
+// rows j - 1, j and j + 1, with halo cells at [-1] and [n]. prev holds the
+// previous step and gets the next one. With a slope, also writes the normal
+// of the current field to normalX, normalY and normalZ.
+inline void stepRow(const float *below, const float *row, const float *above,
+                    float *prev, int n, const Coefficients &k, float *normalX,
+                    float *normalY, float *normalZ) {
+  int i = 0;
+  const bool normals = k.slope != 0.0f;
+#if defined(__AVX__)
+  {
+    const __m256 center = _mm256_set1_ps(k.center);
+    const __m256 sides = _mm256_set1_ps(k.sides);
+    const __m256 decay = _mm256_set1_ps(k.decay);
+    const __m256 slope = _mm256_set1_ps(k.slope);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    for (; i + 8 <= n; i += 8) {
+      __m256 c = _mm256_loadu_ps(row + i);
+      __m256 l = _mm256_loadu_ps(row + i - 1);
+      __m256 r = _mm256_loadu_ps(row + i + 1);
+      __m256 d = _mm256_loadu_ps(below + i);
+      __m256 u = _mm256_loadu_ps(above + i);
+      __m256 sum = _mm256_add_ps(_mm256_add_ps(l, r), _mm256_add_ps(d, u));
+      __m256 next = _mm256_add_ps(_mm256_mul_ps(center, c),
+                                  _mm256_mul_ps(sides, sum));
+      next = _mm256_sub_ps(next,
+                           _mm256_mul_ps(decay, _mm256_loadu_ps(prev + i)));
+      _mm256_storeu_ps(prev + i, next);
+      if (normals) {
+        __m256 gx = _mm256_mul_ps(_mm256_sub_ps(r, l), slope);
+        __m256 gy = _mm256_mul_ps(_mm256_sub_ps(u, d), slope);
+        __m256 len = _mm256_sqrt_ps(_mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(gx, gx), _mm256_mul_ps(gy, gy)), one));
+        __m256 inv = _mm256_div_ps(one, len);
+        _mm256_storeu_ps(normalX + i,
+                         _mm256_xor_ps(_mm256_mul_ps(gx, inv), sign));
+        _mm256_storeu_ps(normalY + i,
+                         _mm256_xor_ps(_mm256_mul_ps(gy, inv), sign));
+        _mm256_storeu_ps(normalZ + i, inv);
+      }
+    }
+  }
+#endif
+#if defined(WAVE_SSE2)
+  {
+    const __m128 center = _mm_set1_ps(k.center);
+    const __m128 sides = _mm_set1_ps(k.sides);
+    const __m128 decay = _mm_set1_ps(k.decay);
+    const __m128 slope = _mm_set1_ps(k.slope);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= n; i += 4) {
+      __m128 c = _mm_loadu_ps(row + i);
+      __m128 l = _mm_loadu_ps(row + i - 1);
+      __m128 r = _mm_loadu_ps(row + i + 1);
+      __m128 d = _mm_loadu_ps(below + i);
+      __m128 u = _mm_loadu_ps(above + i);
+      __m128 sum = _mm_add_ps(_mm_add_ps(l, r), _mm_add_ps(d, u));
+      __m128 next = _mm_add_ps(_mm_mul_ps(center, c), _mm_mul_ps(sides, sum));
+      next = _mm_sub_ps(next, _mm_mul_ps(decay, _mm_loadu_ps(prev + i)));
+      _mm_storeu_ps(prev + i, next);
+      if (normals) {
+        __m128 gx = _mm_mul_ps(_mm_sub_ps(r, l), slope);
+        __m128 gy = _mm_mul_ps(_mm_sub_ps(u, d), slope);
+        __m128 len = _mm_sqrt_ps(_mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(gx, gx), _mm_mul_ps(gy, gy)), one));
+        __m128 inv = _mm_div_ps(one, len);
+        _mm_storeu_ps(normalX + i, _mm_xor_ps(_mm_mul_ps(gx, inv), sign));
+        _mm_storeu_ps(normalY + i, _mm_xor_ps(_mm_mul_ps(gy, inv), sign));
+        _mm_storeu_ps(normalZ + i, inv);
+      }
+    }
+  }
+#elif defined(WAVE_NEON)
+  {
+    const float32x4_t center = vdupq_n_f32(k.center);
+    const float32x4_t sides = vdupq_n_f32(k.sides);
+    const float32x4_t decay = vdupq_n_f32(k.decay);
+    const float32x4_t slope = vdupq_n_f32(k.slope);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    for (; i + 4 <= n; i += 4) {
+      float32x4_t c = vld1q_f32(row + i);
+      float32x4_t l = vld1q_f32(row + i - 1);
+      float32x4_t r = vld1q_f32(row + i + 1);
+      float32x4_t d = vld1q_f32(below + i);
+      float32x4_t u = vld1q_f32(above + i);
+      float32x4_t sum = vaddq_f32(vaddq_f32(l, r), vaddq_f32(d, u));
+      float32x4_t next =
+          vaddq_f32(vmulq_f32(center, c), vmulq_f32(sides, sum));
+      next = vsubq_f32(next, vmulq_f32(decay, vld1q_f32(prev + i)));
+      vst1q_f32(prev + i, next);
+      if (normals) {
+        float32x4_t gx = vmulq_f32(vsubq_f32(r, l), slope);
+        float32x4_t gy = vmulq_f32(vsubq_f32(u, d), slope);
+        float32x4_t len = vsqrtq_f32(
+            vaddq_f32(vaddq_f32(vmulq_f32(gx, gx), vmulq_f32(gy, gy)), one));
+        float32x4_t inv = vdivq_f32(one, len);
+        vst1q_f32(normalX + i, vnegq_f32(vmulq_f32(gx, inv)));
+        vst1q_f32(normalY + i, vnegq_f32(vmulq_f32(gy, inv)));
+        vst1q_f32(normalZ + i, inv);
+      }
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    float sum = (row[i - 1] + row[i + 1]) + (below[i] + above[i]);
+    prev[i] = (k.center * row[i] + k.sides * sum) - k.decay * prev[i];
+    if (normals) {
+      float gx = (row[i + 1] - row[i - 1]) * k.slope;
+      float gy = (above[i] - below[i]) * k.slope;
+      float inv = 1.0f / std::sqrt(gx * gx + gy * gy + 1.0f);
+      normalX[i] = -(gx * inv);
+      normalY[i] = -(gy * inv);
+      normalZ[i] = inv;
+    }
+  }
+}
+
+} // namespace wave
+
+class WaveField {
+public:
+  // Decay factor of waves, in (0, 1]
+  float decay{0.96f};
+  // Velocity of wave propagation, in (0, 0.5]
+  float velocity{0.5f};
+  // Distance between cells, for the normals
+  float spacing{1.0f};
+  // Rows each thread takes at a time
+  int rowsPerTile{16};
+
+  // numThreads includes the calling thread. 0 uses one per core.
+  explicit WaveField(unsigned int numThreads = 0) : mParallel(numThreads) {}
+
+  // Resizes to nx by ny cells, all 0
+  void resize(int nx, int ny) {
+    mNx = std::max(nx, 1);
+    mNy = std::max(ny, 1);
+    mStride = mNx + 2;
+    for (auto &plane : mPlanes) {
+      plane.assign(size_t(mStride) * (mNy + 2), 0.0f);
+    }
+  }
+
+  int nx() const { return mNx; }
+  int ny() const { return mNy; }
+
+  void threads(unsigned int numThreads) { mParallel.threads(numThreads); }
+
+  void clear() { resize(mNx, mNy); }
+
+  // Current height of cell (i, j)
+  float at(int i, int j) const { return mPlanes[mCurrent][index(i, j)]; }
+
+  // Raises cell (i, j), wrapping around the edges. Both steps are raised
+  // so the displacement starts at rest.
+  void displace(int i, int j, float v) {
+    i = ((i % mNx) + mNx) % mNx;
+    j = ((j % mNy) + mNy) % mNy;
+    mPlanes[0][index(i, j)] += v;
+    mPlanes[1][index(i, j)] += v;
+  }
+
+  // Advances the field one step
+  void step() { step(nullptr, nullptr); }
+
+  // Advances the field one step, and writes the current heights to the z of
+  // vertices and the normals of the surface to normals, nx() * ny() of each
+  // in rows
+  void step(al::Vec3f *vertices, al::Vec3f *normals) {
+    wrapHalo();
+    float *current = mPlanes[mCurrent].data();
+    float *prev = mPlanes[1 - mCurrent].data();
+    wave::Coefficients k;
+    k.center = decay * (2.0f - 4.0f * velocity);
+    k.sides = decay * velocity;
+    k.decay = decay;
+    k.slope = vertices ? 0.5f / spacing : 0.0f;
+    size_t tile = size_t(std::max(rowsPerTile, 1));
+    mNormals.resize(3 * size_t(mNx) * ((mNy + tile - 1) / tile));
+    mParallel(size_t(mNy), tile, [&](size_t begin, size_t end) {
+      float *normalX = &mNormals[3 * size_t(mNx) * (begin / tile)];
+      float *normalY = normalX + mNx;
+      float *normalZ = normalY + mNx;
+      for (int j = int(begin); j < int(end); j++) {
+        const float *row = current + index(0, j);
+        wave::stepRow(row - mStride, row, row + mStride, prev + index(0, j),
+                      mNx, k, normalX, normalY, normalZ);
+        if (vertices) {
+          al::Vec3f *v = vertices + size_t(mNx) * j;
+          al::Vec3f *n = normals + size_t(mNx) * j;
+          for (int i = 0; i < mNx; i++) {
+            v[i].z = row[i];
+            n[i] = al::Vec3f(normalX[i], normalY[i], normalZ[i]);
+          }
+        }
+      }
+    });
+    mCurrent = 1 - mCurrent;
+  }
+
+private:
+  size_t index(int i, int j) const { return size_t(j + 1) * mStride + i + 1; }
+
+  // Copies the opposite edges of the current plane into its halo
+  void wrapHalo() {
+    float *plane = mPlanes[mCurrent].data();
+    for (int j = 0; j < mNy; j++) {
+      plane[index(-1, j)] = plane[index(mNx - 1, j)];
+      plane[index(mNx, j)] = plane[index(0, j)];
+    }
+    std::copy(plane + index(-1, mNy - 1), plane + index(-1, mNy - 1) + mStride,
+              plane + index(-1, -1));
+    std::copy(plane + index(-1, 0), plane + index(-1, 0) + mStride,
+              plane + index(-1, mNy));
+  }
+
+  ParallelFor mParallel;
+
+  int mNx{0}, mNy{0};
+  int mStride{2};                    // Floats per row, halo included
+  std::vector<float> mPlanes[2];     // Current and previous step
+  int mCurrent{0};
+  std::vector<float> mNormals;       // Rows of normal x, y and z per tile
+};
+
+#endif // WaveField_H
@@ -15,6 +15,12 @@ calculating the "nearness" of flockmates. This is done primarily to avoid
 infinities, but also to give smoother motions. Lastly, we give each boid a
 random walk motion which helps both dissolve and redirect the flocks.
 
+The flock itself lives in Flock.h. Boids only interact with the boids within
+a cutoff distance, found through a uniform grid, and the interactions are
+computed on all cores, so the flock can have tens of thousands of boids. The
+number of boids can be passed on the command line; the box grows with it so
+the boids stay as dense as the original 32 boids in a 2 x 2 box.
+
 [1] Reynolds, C. W. (1987). Flocks, herds, and schools: A distributed behavioral
     model. Computer Graphics, 21(4):25–34.
 
@@ -22,103 +28,50 @@ Author:
 Lance Putnam, Oct. 2014
 */
 
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 
 #include "al/app/al_App.hpp"
 #include "al/graphics/al_Shapes.hpp"
 #include "al/math/al_Functions.hpp"
 #include "al/math/al_Random.hpp"
 
-using namespace al;
-
-// A "boid" (play on bird) is one member of a flock.
-class Boid {
- public:
-  // Each boid has a position and velocity.
-  Vec2d pos, vel;
+#include "Flock.h"
 
-  // Update position based on velocity and delta time
-  void update(double dt) { pos += vel * dt; }
-};
+using namespace al;
 
 struct MyApp : public App {
-  static const int Nb = 32;  // Number of boids
-  Boid boids[Nb];
+  int Nb = 32;  // Number of boids ("boid" is a play on bird)
+  Flock flock;
   Mesh heads, tails;
   Mesh box;
 
   void onCreate() {
+    // Keep the density of 32 boids in a 2 x 2 box
+    flock.size = std::sqrt(Nb / 32.0f);
+    flock.resize(Nb);
+
+    float s = flock.size;
     box.primitive(Mesh::LINE_LOOP);
-    box.vertex(-1, -1);
-    box.vertex(1, -1);
-    box.vertex(1, 1);
-    box.vertex(-1, 1);
-    nav().pullBack(4);
+    box.vertex(-s, -s);
+    box.vertex(s, -s);
+    box.vertex(s, s);
+    box.vertex(-s, s);
+    nav().pullBack(4 * s);
 
     resetBoids();
   }
 
-  // Randomize boid positions/velocities uniformly inside unit disc
-  void resetBoids() {
-    for (auto& b : boids) {
-      b.pos = rnd::ball<Vec2f>();
-      b.vel = rnd::ball<Vec2f>();
-    }
-  }
+  // Randomize boid positions uniformly inside a disc filling the box, and
+  // velocities inside the unit disc
+  void resetBoids() { flock.reset(); }
 
   void onAnimate(double dt_ms) {
     double dt = dt_ms;
 
-    // Compute boid-boid interactions
-    for (int i = 0; i < Nb - 1; ++i) {
-      for (int j = i + 1; j < Nb; ++j) {
-        // printf("checking boids %d and %d\n", i,j);
-
-        auto ds = boids[i].pos - boids[j].pos;
-        auto dist = ds.mag();
-
-        // Collision avoidance
-        double pushRadius = 0.05;
-        double pushStrength = 1;
-        double push = exp(-al::pow2(dist / pushRadius)) * pushStrength;
-
-        auto pushVector = ds.normalized() * push;
-        boids[i].pos += pushVector;
-        boids[j].pos -= pushVector;
-
-        // Velocity matching
-        double matchRadius = 0.125;
-        double nearness = exp(-al::pow2(dist / matchRadius));
-        Vec2d veli = boids[i].vel;
-        Vec2d velj = boids[j].vel;
-
-        // Take a weighted average of velocities according to nearness
-        boids[i].vel = veli * (1 - 0.5 * nearness) + velj * (0.5 * nearness);
-        boids[j].vel = velj * (1 - 0.5 * nearness) + veli * (0.5 * nearness);
-
-        // TODO: Flock centering
-      }
-    }
-
-    // Update boid independent behaviors
-    for (auto& b : boids) {
-      // Random "hunting" motion
-      float huntUrge = 0.2f;
-      auto hunt = rnd::ball<Vec2f>();
-      // Use cubed distribution to make small jumps more frequent
-      hunt *= hunt.magSqr();
-      b.vel += hunt * huntUrge;
-
-      // Bound boid into a box
-      if (b.pos.x > 1 || b.pos.x < -1) {
-        b.pos.x = b.pos.x > 0 ? 1 : -1;
-        b.vel.x = -b.vel.x;
-      }
-      if (b.pos.y > 1 || b.pos.y < -1) {
-        b.pos.y = b.pos.y > 0 ? 1 : -1;
-        b.vel.y = -b.vel.y;
-      }
-    }
+    // Interactions, random motion and bounding, then update positions
+    flock.step(dt);
 
     // Generate meshes
     heads.reset();
@@ -127,14 +80,15 @@ struct MyApp : public App {
     tails.reset();
     tails.primitive(Mesh::LINES);
 
-    for (size_t i = 0; i < Nb; ++i) {
-      boids[i].update(dt);
+    for (int i = 0; i < Nb; ++i) {
+      Vec2f pos(flock.x[i], flock.y[i]);
+      Vec2f vel(flock.vx[i], flock.vy[i]);
 
-      heads.vertex(boids[i].pos);
+      heads.vertex(pos);
       heads.color(HSV(float(i) / Nb * 0.3f + 0.3f, 0.7f));
 
-      tails.vertex(boids[i].pos);
-      tails.vertex(boids[i].pos - boids[i].vel.normalized(0.07));
+      tails.vertex(pos);
+      tails.vertex(pos - vel.normalized(0.07));
 
       tails.color(heads.colors()[i]);
       tails.color(RGB(0.5));
@@ -166,7 +120,12 @@ struct MyApp : public App {
   }
 };
 
-int main() {
-  MyApp().start();
+// Usage: flocking [number of boids]
+int main(int argc, char* argv[]) {
+  MyApp app;
+  if (argc > 1) {
+    app.Nb = std::max(1, std::atoi(argv[1]));
+  }
+  app.start();
   return 0;
 }
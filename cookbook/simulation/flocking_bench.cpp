@@ -0,0 +1,124 @@
+// Steps per second of the flocking simulation against the number of boids
+//
+// Runs the flock of flocking.cpp without graphics, at the density of the
+// original 32 boids in a 2 x 2 box:
+//  - "pairs": every pair of boids, one thread, as flocking.cpp used to do
+//    (only up to 10000 boids, it takes minutes per step beyond),
+//  - "grid 1": Flock.h on one thread,
+//  - "grid N": Flock.h on one thread per core.
+//
+// Usage (from the bin folder):
+//   flocking_bench [seconds]
+//
+//   seconds  time spent per boid count and path (default: 2)
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "al/math/al_Functions.hpp"
+#include "al/math/al_Random.hpp"
+
+#include "Flock.h"
+
+using namespace al;
+
+const double dt = 1.0 / 60.0;
+
+// One step of the original onAnimate(), on the flock's arrays
+void stepPairs(Flock &flock) {
+  int n = int(flock.count());
+  auto &x = flock.x, &y = flock.y, &vx = flock.vx, &vy = flock.vy;
+  for (int i = 0; i < n - 1; ++i) {
+    for (int j = i + 1; j < n; ++j) {
+      Vec2d ds(x[i] - x[j], y[i] - y[j]);
+      auto dist = ds.mag();
+
+      double push = exp(-al::pow2(dist / flock.pushRadius)) * flock.pushStrength;
+      auto pushVector = ds.normalized() * push;
+      x[i] += pushVector.x;
+      y[i] += pushVector.y;
+      x[j] -= pushVector.x;
+      y[j] -= pushVector.y;
+
+      double nearness = exp(-al::pow2(dist / flock.matchRadius));
+      Vec2d veli(vx[i], vy[i]);
+      Vec2d velj(vx[j], vy[j]);
+      Vec2d newi = veli * (1 - 0.5 * nearness) + velj * (0.5 * nearness);
+      Vec2d newj = velj * (1 - 0.5 * nearness) + veli * (0.5 * nearness);
+      vx[i] = newi.x;
+      vy[i] = newi.y;
+      vx[j] = newj.x;
+      vy[j] = newj.y;
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    auto hunt = rnd::ball<Vec2f>();
+    hunt *= hunt.magSqr();
+    vx[i] += hunt.x * flock.huntUrge;
+    vy[i] += hunt.y * flock.huntUrge;
+    if (x[i] > flock.size || x[i] < -flock.size) {
+      x[i] = x[i] > 0 ? flock.size : -flock.size;
+      vx[i] = -vx[i];
+    }
+    if (y[i] > flock.size || y[i] < -flock.size) {
+      y[i] = y[i] > 0 ? flock.size : -flock.size;
+      vy[i] = -vy[i];
+    }
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+  }
+}
+
+template <class Step>
+double stepRate(Flock &flock, double seconds, Step step) {
+  flock.reset();
+  int steps = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  while (elapsed < seconds || steps < 2) {
+    step();
+    steps++;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+  return steps / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 2.0;
+  unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << "Steps per second, " << cores << " threads for grid N."
+            << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(8) << "boids" << std::setw(12) << "pairs"
+            << std::setw(12) << "grid 1" << std::setw(12) << "grid N"
+            << std::endl;
+  for (int boids : {1000, 3000, 10000, 30000, 100000}) {
+    Flock flock;
+    flock.resize(boids);
+    flock.size = std::sqrt(boids / 32.0f);
+
+    std::cout << std::setw(8) << boids;
+    if (boids <= 10000) {
+      std::cout << std::setw(12)
+                << stepRate(flock, seconds, [&]() { stepPairs(flock); });
+    } else {
+      std::cout << std::setw(12) << "-";
+    }
+    flock.threads(1);
+    std::cout << std::setw(12)
+              << stepRate(flock, seconds, [&]() { flock.step(dt); });
+    flock.threads(cores);
+    std::cout << std::setw(12)
+              << stepRate(flock, seconds, [&]() { flock.step(dt); })
+              << std::endl;
+  }
+  return 0;
+}
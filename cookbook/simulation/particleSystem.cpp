@@ -5,85 +5,67 @@ Description:
 This demonstrates how to build a particle system with a simple fountain-like
 behavior.
 
+The particles live in ParticleEmitter.h, which moves them on all cores and
+writes them straight into the vertex and color buffers of a mesh that keeps
+its size, so the fountain can have a million particles. The number of
+particles can be passed on the command line.
+
 Author(s):
 Lance Putnam, 4/25/2011
 */
 
 #include "al/app/al_App.hpp"
+#include "al/graphics/al_VAOMesh.hpp"
 #include "al/math/al_Random.hpp"
 
-using namespace al;
-
-struct Particle {
-  Vec3f pos, vel, acc;
-  int age = 0;
-
-  void update(int ageInc) {
-    vel += acc;
-    pos += vel;
-    age += ageInc;
-  }
-};
-
-template <int N> struct Emitter {
-  Particle particles[N];
-  int tap = 0;
-
-  Emitter() {
-    for (auto &p : particles)
-      p.age = N;
-  }
-
-  template <int M> void update() {
-    for (auto &p : particles)
-      p.update(M);
-
-    for (int i = 0; i < M; ++i) {
-      auto &p = particles[tap];
-
-      // fountain
-      if (rnd::prob(0.95)) {
-        p.vel.set(rnd::uniform(-0.1, -0.05), rnd::uniform(0.12, 0.14),
-                  rnd::uniform(0.01));
-        p.acc.set(0, -0.002, 0);
+#include "ParticleEmitter.h"
 
-        // spray
-      } else {
-        p.vel.set(rnd::uniformS(0.01), rnd::uniformS(0.01),
-                  rnd::uniformS(0.01));
-        p.acc.set(0, 0, 0);
-      }
-      p.pos.set(4, -2, 0);
-
-      p.age = 0;
-      ++tap;
-      if (tap >= N)
-        tap = 0;
-    }
-  }
-
-  int size() { return N; }
-};
+using namespace al;
 
 struct MyApp : public App {
-  Emitter<8000> em1;
-  Mesh mesh;
-
-  void onCreate() { nav().pullBack(16); }
+  int numParticles = 8000;
+  ParticleEmitter em1;
+  VAOMesh mesh;
 
-  void onAnimate(double dt) {
-    em1.update<40>();
-
-    mesh.reset();
+  void onCreate() {
+    em1.resize(numParticles);
     mesh.primitive(Mesh::POINTS);
+    mesh.vertices().resize(em1.count());
+    mesh.colors().resize(em1.count());
+    nav().pullBack(16);
+  }
 
-    for (int i = 0; i < em1.size(); ++i) {
-      Particle &p = em1.particles[i];
-      float age = float(p.age) / em1.size();
-
-      mesh.vertex(p.pos);
-      mesh.color(HSV(0.6, rnd::uniform(), (1 - age) * 0.4));
-    }
+  void onAnimate(double dt) {
+    // A particle lives for 200 frames
+    int births = std::max(1, numParticles / 200);
+    em1.update(
+        births,
+        [&](size_t i) {
+          // fountain
+          if (rnd::prob(0.95)) {
+            em1.vx[i] = rnd::uniform(-0.1, -0.05);
+            em1.vy[i] = rnd::uniform(0.12, 0.14);
+            em1.vz[i] = rnd::uniform(0.01);
+            em1.ax[i] = 0;
+            em1.ay[i] = -0.002;
+            em1.az[i] = 0;
+
+            // spray
+          } else {
+            em1.vx[i] = rnd::uniformS(0.01);
+            em1.vy[i] = rnd::uniformS(0.01);
+            em1.vz[i] = rnd::uniformS(0.01);
+            em1.ax[i] = em1.ay[i] = em1.az[i] = 0;
+          }
+          em1.x[i] = 4;
+          em1.y[i] = -2;
+          em1.z[i] = 0;
+        },
+        mesh.vertices().data(), mesh.colors().data(),
+        [](float age, float noise) {
+          return Color(HSV(0.6, noise, (1 - age) * 0.4));
+        });
+    mesh.update();
   }
 
   void onDraw(Graphics &g) {
@@ -95,4 +77,11 @@ struct MyApp : public App {
   }
 };
 
-int main() { MyApp().start(); }
+// Usage: particleSystem [number of particles]
+int main(int argc, char *argv[]) {
+  MyApp app;
+  if (argc > 1) {
+    app.numParticles = std::max(200, std::atoi(argv[1]));
+  }
+  app.start();
+}
@@ -0,0 +1,159 @@
+// Frame time of the particle fountain against the number of particles
+//
+// Runs the particle and mesh updates of particleSystem.cpp without
+// graphics, with a particle lifetime of 200 frames:
+//  - "structs": the array of particle structs particleSystem.cpp used to
+//    update, refilling the mesh with mesh.reset() and a rnd::uniform() per
+//    color every frame,
+//  - "arrays 1": ParticleEmitter.h on one thread, writing into a mesh sized
+//    once,
+//  - "arrays N": ParticleEmitter.h on one thread per core.
+//
+// Usage (from the bin folder):
+//   particle_emitter_bench [seconds]
+//
+//   seconds  time spent per particle count and path (default: 2)
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "al/graphics/al_Mesh.hpp"
+#include "al/math/al_Random.hpp"
+
+#include "ParticleEmitter.h"
+
+using namespace al;
+
+// The original Particle and Emitter, with the particles on the heap
+struct Particle {
+  Vec3f pos, vel, acc;
+  int age = 0;
+
+  void update(int ageInc) {
+    vel += acc;
+    pos += vel;
+    age += ageInc;
+  }
+};
+
+struct Structs {
+  std::vector<Particle> particles;
+  int tap = 0;
+
+  Structs(int n) : particles(n) {
+    for (auto &p : particles)
+      p.age = n;
+  }
+
+  void update(int births) {
+    for (auto &p : particles)
+      p.update(births);
+    for (int i = 0; i < births; ++i) {
+      auto &p = particles[tap];
+      if (rnd::prob(0.95)) {
+        p.vel.set(rnd::uniform(-0.1, -0.05), rnd::uniform(0.12, 0.14),
+                  rnd::uniform(0.01));
+        p.acc.set(0, -0.002, 0);
+      } else {
+        p.vel.set(rnd::uniformS(0.01), rnd::uniformS(0.01),
+                  rnd::uniformS(0.01));
+        p.acc.set(0, 0, 0);
+      }
+      p.pos.set(4, -2, 0);
+      p.age = 0;
+      if (++tap >= int(particles.size()))
+        tap = 0;
+    }
+  }
+
+  void write(Mesh &mesh) {
+    mesh.reset();
+    mesh.primitive(Mesh::POINTS);
+    for (auto &p : particles) {
+      float age = float(p.age) / particles.size();
+      mesh.vertex(p.pos);
+      mesh.color(HSV(0.6, rnd::uniform(), (1 - age) * 0.4));
+    }
+  }
+};
+
+void emit(ParticleEmitter &em, size_t i) {
+  if (rnd::prob(0.95)) {
+    em.vx[i] = rnd::uniform(-0.1, -0.05);
+    em.vy[i] = rnd::uniform(0.12, 0.14);
+    em.vz[i] = rnd::uniform(0.01);
+    em.ax[i] = 0;
+    em.ay[i] = -0.002;
+    em.az[i] = 0;
+  } else {
+    em.vx[i] = rnd::uniformS(0.01);
+    em.vy[i] = rnd::uniformS(0.01);
+    em.vz[i] = rnd::uniformS(0.01);
+    em.ax[i] = em.ay[i] = em.az[i] = 0;
+  }
+  em.x[i] = 4;
+  em.y[i] = -2;
+  em.z[i] = 0;
+}
+
+// Milliseconds per frame
+template <class Frame> double frameTime(double seconds, Frame frame) {
+  int frames = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  while (elapsed < seconds || frames < 2) {
+    frame();
+    frames++;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+  return 1000.0 * elapsed / frames;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 2.0;
+  unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << "Milliseconds per frame, " << cores
+            << " threads for arrays N." << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(10) << "particles" << std::setw(12) << "structs"
+            << std::setw(12) << "arrays 1" << std::setw(12) << "arrays N"
+            << std::endl;
+  for (int n : {8000, 100000, 1000000}) {
+    int births = n / 200;
+    Mesh mesh;
+    std::cout << std::setw(10) << n;
+
+    Structs structs(n);
+    std::cout << std::setw(12) << frameTime(seconds, [&]() {
+      structs.update(births);
+      structs.write(mesh);
+    });
+
+    ParticleEmitter emitter;
+    emitter.resize(n);
+    mesh.reset();
+    mesh.primitive(Mesh::POINTS);
+    mesh.vertices().resize(n);
+    mesh.colors().resize(n);
+    auto shade = [](float age, float noise) {
+      return Color(HSV(0.6, noise, (1 - age) * 0.4));
+    };
+    for (unsigned int threads : {1u, cores}) {
+      emitter.threads(threads);
+      std::cout << std::setw(12) << frameTime(seconds, [&]() {
+        emitter.update(births, [&](size_t i) { emit(emitter, i); },
+                       mesh.vertices().data(), mesh.colors().data(), shade);
+      });
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
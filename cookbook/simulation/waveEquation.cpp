@@ -17,6 +17,11 @@ The simulation adds random Gaussian-shaped drops to simulate water droplets
 falling into a pool. A minor artifact is increased rippling along the wavefronts
 in the x and y directions.
 
+The field itself lives in WaveField.h. It is updated in tiles of rows on all
+cores, and the same pass writes the heights and normals of the mesh, so the
+grid can have millions of cells. The grid size can be passed on the command
+line.
+
 See also: http://locklessinc.com/articles/wave_eqn/
 
 Author:
@@ -26,24 +31,28 @@ Lance Putnam, Oct. 2014
 #include "al/app/al_App.hpp"
 #include "al/graphics/al_Shapes.hpp"
 #include "al/math/al_Random.hpp"
+
+#include "WaveField.h"
+
 using namespace al;
 
 struct MyApp : public App {
-  static const int Nx = 256, Ny = Nx;
-  float wave[Nx * Ny * 2];  // Values of wave for current and previous time step
-  int zcurr = 0;            // The current "plane" coordinate representing time
-  float decay = 0.96f;      // Decay factor of waves, in (0, 1]
-  float velocity = 0.5f;    // Velocity of wave propagation, in (0, 0.5]
+  int Nx = 256, Ny = Nx;
+  WaveField wave;           // Values of wave for current and previous time step
 
   Mesh mesh;
   Light light;
   Material mtrl;
 
   void onCreate() {
-    for (auto& v : wave) v = 0;
+    wave.resize(Nx, Ny);
+    wave.decay = 0.96f;     // Decay factor of waves, in (0, 1]
+    wave.velocity = 0.5f;   // Velocity of wave propagation, in (0, 0.5]
+    wave.spacing = 2.0f / (Nx - 1);
 
     // Add a tessellated plane
     addSurface(mesh, Nx, Ny);
+    mesh.generateNormals();
 
     nav().pullBack(4);
 
@@ -52,14 +61,7 @@ struct MyApp : public App {
     mtrl.shininess(30);
   }
 
-  int indexAt(int x, int y, int z) {
-    // return (z*Nx + y)*Ny + x;
-    return (y * Nx + x) * 2 + z;  // may give slightly faster accessing
-  }
-
   void onAnimate(double /*dt*/) {
-    int zprev = 1 - zcurr;
-
     // Add some random droplets
     for (int k = 0; k < 3; ++k) {
       if (rnd::prob(0.01)) {
@@ -71,45 +73,14 @@ struct MyApp : public App {
             float x = float(i) / 4;
             float y = float(j) / 4;
             float v = 0.5 * exp(-(x * x + y * y) / (0.5 * 0.5));
-            wave[indexAt(ix + i, iy + j, zcurr)] += v;
-            wave[indexAt(ix + i, iy + j, zprev)] += v;
+            wave.displace(ix + i, iy + j, v);
           }
         }
       }
     }
 
-    // Update wave equation
-    for (int j = 0; j < Ny; ++j) {
-      for (int i = 0; i < Nx; ++i) {
-        // Neighbor indices; wrap toroidally
-        int im1 = i != 0 ? i - 1 : Nx - 1;
-        int ip1 = i != Nx - 1 ? i + 1 : 0;
-        int jm1 = j != 0 ? j - 1 : Ny - 1;
-        int jp1 = j != Nx - 1 ? j + 1 : 0;
-
-        // Get neighborhood of samples
-        auto vp = wave[indexAt(i, j, zprev)];    // previous value
-        auto vc = wave[indexAt(i, j, zcurr)];    // current value
-        auto vl = wave[indexAt(im1, j, zcurr)];  // neighbor left
-        auto vr = wave[indexAt(ip1, j, zcurr)];  // neighbor right
-        auto vd = wave[indexAt(i, jm1, zcurr)];  // neighbor up
-        auto vu = wave[indexAt(i, jp1, zcurr)];  // neighbor down
-
-        // Compute next value of wave equation at (i,j)
-        auto val =
-            2 * vc - vp + velocity * ((vl - 2 * vc + vr) + (vd - 2 * vc + vu));
-
-        // Store in previous value since we don't need it again
-        wave[indexAt(i, j, zprev)] = val * decay;
-
-        int idx = j * Nx + i;
-        mesh.vertices()[idx].z = val;
-      }
-    }
-
-    mesh.generateNormals();
-
-    zcurr = zprev;
+    // Update wave equation, and the mesh heights and normals with it
+    wave.step(mesh.vertices().data(), mesh.normals().data());
   }
 
   void onDraw(Graphics& g) {
@@ -122,4 +93,11 @@ struct MyApp : public App {
   }
 };
 
-int main() { MyApp().start(); }
+// Usage: waveEquation [grid size]
+int main(int argc, char* argv[]) {
+  MyApp app;
+  if (argc > 1) {
+    app.Nx = app.Ny = std::max(16, std::atoi(argv[1]));
+  }
+  app.start();
+}
@@ -0,0 +1,126 @@
+// Steps per second of the wave equation simulation against the grid size
+//
+// Runs the field and mesh updates of waveEquation.cpp without graphics,
+// with a droplet every step:
+//  - "loop": the single threaded loop waveEquation.cpp used to run, wrapping
+//    neighbor indices per cell, followed by mesh.generateNormals() (only up
+//    to 1024 x 1024, its normals take seconds beyond),
+//  - "tiles 1": WaveField.h on one thread,
+//  - "tiles N": WaveField.h on one thread per core.
+// Both paths update the mesh vertices and normals every step.
+//
+// Usage (from the bin folder):
+//   wave_equation_bench [seconds]
+//
+//   seconds  time spent per grid size and path (default: 2)
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "al/graphics/al_Mesh.hpp"
+#include "al/graphics/al_Shapes.hpp"
+
+#include "WaveField.h"
+
+using namespace al;
+
+const float decay = 0.96f;
+const float velocity = 0.5f;
+
+// The original onAnimate(), minus the droplets
+struct Loop {
+  int Nx, Ny;
+  std::vector<float> wave;
+  int zcurr = 0;
+
+  Loop(int n) : Nx(n), Ny(n), wave(2 * n * n, 0.0f) {}
+
+  int indexAt(int x, int y, int z) { return (y * Nx + x) * 2 + z; }
+
+  void step(Mesh &mesh) {
+    int zprev = 1 - zcurr;
+    for (int j = 0; j < Ny; ++j) {
+      for (int i = 0; i < Nx; ++i) {
+        int im1 = i != 0 ? i - 1 : Nx - 1;
+        int ip1 = i != Nx - 1 ? i + 1 : 0;
+        int jm1 = j != 0 ? j - 1 : Ny - 1;
+        int jp1 = j != Nx - 1 ? j + 1 : 0;
+        auto vp = wave[indexAt(i, j, zprev)];
+        auto vc = wave[indexAt(i, j, zcurr)];
+        auto vl = wave[indexAt(im1, j, zcurr)];
+        auto vr = wave[indexAt(ip1, j, zcurr)];
+        auto vd = wave[indexAt(i, jm1, zcurr)];
+        auto vu = wave[indexAt(i, jp1, zcurr)];
+        auto val =
+            2 * vc - vp + velocity * ((vl - 2 * vc + vr) + (vd - 2 * vc + vu));
+        wave[indexAt(i, j, zprev)] = val * decay;
+        mesh.vertices()[j * Nx + i].z = val;
+      }
+    }
+    mesh.generateNormals();
+    zcurr = zprev;
+  }
+};
+
+template <class Step> double stepRate(double seconds, Step step) {
+  int steps = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  while (elapsed < seconds || steps < 2) {
+    step();
+    steps++;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+  return steps / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 2.0;
+  unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << "Steps per second, " << cores << " threads for tiles N."
+            << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(6) << "grid" << std::setw(12) << "loop"
+            << std::setw(12) << "tiles 1" << std::setw(12) << "tiles N"
+            << std::endl;
+  for (int n : {256, 512, 1024, 2048}) {
+    Mesh mesh;
+    addSurface(mesh, n, n);
+    mesh.generateNormals();
+
+    std::cout << std::setw(6) << n;
+    if (n <= 1024) {
+      Loop loop(n);
+      std::cout << std::setw(12) << stepRate(seconds, [&]() {
+        loop.wave[loop.indexAt(n / 2, n / 2, loop.zcurr)] += 0.5f;
+        loop.step(mesh);
+      });
+    } else {
+      std::cout << std::setw(12) << "-";
+    }
+
+    WaveField field;
+    field.resize(n, n);
+    field.decay = decay;
+    field.velocity = velocity;
+    field.spacing = 2.0f / (n - 1);
+    for (unsigned int threads : {1u, cores}) {
+      field.threads(threads);
+      std::cout << std::setw(12) << stepRate(seconds, [&]() {
+        field.displace(n / 2, n / 2, 0.5f);
+        field.step(mesh.vertices().data(), mesh.normals().data());
+      });
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#ifndef BlockProcessing_H
+#define BlockProcessing_H
+
+// Helpers for rendering voices a block at a time instead of pulling one
+// sample at a time through io().
+//
+// A voice renders its buffer in chunks of at most chunkSize frames kept on
+// the stack. Within a chunk each unit generator is run into its own buffer
+// with generate(), the buffers are combined with multiply() and scale(), and
+// the result is panned into the output with mixStereo(). multiply(), scale()
+// and mixStereo() use AVX, SSE2 or NEON when the compiler targets them.
+//
+// Usage, inside onProcess(AudioIOData &io):
+//   float g1, g2;
+//   mPan(1.f, g1, g2); // Pan gains for this block
+//   block::forEachChunk(io, [&](int frame, int n) {
+//     float s[block::chunkSize], env[block::chunkSize];
+//     block::generate(mOsc, s, n);
+//     block::generate(mAmpEnv, env, n);
+//     block::multiply(s, env, n);
+//     block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s,
+//                      g1, g2, n);
+//   });
+
+#include <algorithm>
+
+#include "al/io/al_AudioIOData.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BLOCKPROCESSING_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BLOCKPROCESSING_NEON
+#endif
+
+namespace block {
+
+const int chunkSize = 256;
+
+// Calls func(frame, n) for consecutive chunks covering the frames of io that
+// are still to be rendered, then leaves io at the end of the buffer.
+template <class Func> void forEachChunk(al::AudioIOData &io, Func func) {
+  int frame = io.frame() + 1; // io.frame() is one before the next frame
+  int frames = io.framesPerBuffer();
+  while (frame < frames) {
+    int n = std::min(frames - frame, chunkSize);
+    func(frame, n);
+    frame += n;
+  }
+  io.frame(frames);
+}
+
+// buf[i] = gen() for a Gamma oscillator, envelope or noise generator
+template <class Gen> inline void generate(Gen &gen, float *buf, int n) {
+  for (int i = 0; i < n; i++) {
+    buf[i] = gen();
+  }
+}
+
+// Feeds buf to an envelope follower (or any other one-input unit)
+template <class Unit> inline void follow(Unit &unit, const float *buf, int n) {
+  for (int i = 0; i < n; i++) {
+    unit(buf[i]);
+  }
+}
+
+// dst[i] *= src[i]
+inline void multiply(float *dst, const float *src, int n) {
+  int i = 0;
+#if defined(__AVX__)
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i),
+                                            _mm256_loadu_ps(src + i)));
+  }
+#elif defined(BLOCKPROCESSING_SSE2)
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps(dst + i,
+                  _mm_mul_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+  }
+#elif defined(BLOCKPROCESSING_NEON)
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(dst + i, vmulq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] *= src[i];
+  }
+}
+
+// dst[i] *= s
+inline void scale(float *dst, float s, int n) {
+  int i = 0;
+#if defined(__AVX__)
+  const __m256 s8 = _mm256_set1_ps(s);
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), s8));
+  }
+#elif defined(BLOCKPROCESSING_SSE2)
+  const __m128 s4 = _mm_set1_ps(s);
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), s4));
+  }
+#elif defined(BLOCKPROCESSING_NEON)
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(dst + i), s));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] *= s;
+  }
+}
+
+// out0[i] += src[i] * g0 and out1[i] += src[i] * g1, e.g. with the gains
+// from gam::Pan
+inline void mixStereo(float *out0, float *out1, const float *src, float g0,
+                      float g1, int n) {
+  int i = 0;
+#if defined(__AVX__)
+  const __m256 a = _mm256_set1_ps(g0), b = _mm256_set1_ps(g1);
+  for (; i + 8 <= n; i += 8) {
+    __m256 s = _mm256_loadu_ps(src + i);
+    _mm256_storeu_ps(out0 + i,
+                     _mm256_add_ps(_mm256_loadu_ps(out0 + i), _mm256_mul_ps(s, a)));
+    _mm256_storeu_ps(out1 + i,
+                     _mm256_add_ps(_mm256_loadu_ps(out1 + i), _mm256_mul_ps(s, b)));
+  }
+#elif defined(BLOCKPROCESSING_SSE2)
+  const __m128 a = _mm_set1_ps(g0), b = _mm_set1_ps(g1);
+  for (; i + 4 <= n; i += 4) {
+    __m128 s = _mm_loadu_ps(src + i);
+    _mm_storeu_ps(out0 + i, _mm_add_ps(_mm_loadu_ps(out0 + i), _mm_mul_ps(s, a)));
+    _mm_storeu_ps(out1 + i, _mm_add_ps(_mm_loadu_ps(out1 + i), _mm_mul_ps(s, b)));
+  }
+#elif defined(BLOCKPROCESSING_NEON)
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t s = vld1q_f32(src + i);
+    vst1q_f32(out0 + i, vaddq_f32(vld1q_f32(out0 + i), vmulq_n_f32(s, g0)));
+    vst1q_f32(out1 + i, vaddq_f32(vld1q_f32(out1 + i), vmulq_n_f32(s, g1)));
+  }
+#endif
+  for (; i < n; i++) {
+    out0[i] += src[i] * g0;
+    out1[i] += src[i] * g1;
+  }
+}
+
+} // namespace block
+
+#endif // BlockProcessing_H
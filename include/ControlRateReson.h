@@ -0,0 +1,139 @@
+#pragma once
+#ifndef ControlRateReson_H
+#define ControlRateReson_H
+
+// Two-pole resonator whose center frequency and bandwidth are modulated at
+// control rate.
+//
+// Setting a gam::Reson<> every sample recomputes its coefficients, cosine
+// and exponential included, at audio rate. This filter instead asks for a new
+// frequency and bandwidth once every controlPeriod() samples and ramps the
+// coefficients linearly to them over the period, so the response moves
+// smoothly without zipper noise. A two-pole filter stays stable along a
+// straight line between two stable coefficient sets, so the ramp is always
+// stable.
+//
+// Gamma envelopes that drive the filter should run in controlDomain(), so
+// each call advances them by one control period and their lengths stay in
+// seconds.
+//
+// The response matches gam::Reson<>: poles at radius exp(-pi * bw / sr) and
+// angle 2 * pi * freq / sr, gain normalized to about 1 at the center.
+//
+// Usage:
+//   ControlRateReson res;
+//   res.sampleRate(48000);
+//   cfEnv.domain(res.controlDomain());
+//   bwEnv.domain(res.controlDomain());
+//   ...
+//   res.process(buffer, n, [&]() { return cfEnv(); },
+//               [&]() { return bwEnv(); });
+
+#include <cmath>
+
+#include "Gamma/Domain.h"
+
+class ControlRateReson {
+public:
+  ControlRateReson() { updateControlDomain(); }
+
+  void sampleRate(double sampleRate) {
+    if (sampleRate != mSampleRate) {
+      mSampleRate = sampleRate;
+      updateControlDomain();
+    }
+  }
+  double sampleRate() const { return mSampleRate; }
+
+  // Samples between control points. 1 updates every sample like
+  // gam::Reson<>.
+  void controlPeriod(int samples) {
+    mControlPeriod = samples > 0 ? samples : 1;
+    updateControlDomain();
+  }
+  int controlPeriod() const { return mControlPeriod; }
+
+  // Domain running at the control rate, for the modulating envelopes
+  gam::Domain &controlDomain() { return mControlDomain; }
+
+  // Clears the filter state. The coefficients then start from the next
+  // values of the modulation instead of ramping from the old ones.
+  void reset() {
+    mY1 = mY2 = 0.0f;
+    mCountdown = 0;
+    mFirst = true;
+  }
+
+  // Filters buf in place. freq() and width() return the center frequency and
+  // bandwidth in Hz at the next control point. They are called once for the
+  // point at the start after reset(), then once for each control period.
+  template <class Freq, class Width>
+  void process(float *buf, int n, Freq &&freq, Width &&width) {
+    if (mFirst && n > 0) {
+      // Each period ramps towards the point at its end, so the coefficients
+      // follow the modulation without lagging behind it
+      float f = freq();
+      float w = width();
+      setCoefficients(f, w);
+      mFirst = false;
+    }
+    for (int i = 0; i < n; i++) {
+      if (mCountdown == 0) {
+        float f = freq();
+        float w = width();
+        nextControlPoint(f, w);
+      }
+      float y = mC0 * buf[i] + mC1 * mY1 + mC2 * mY2;
+      mY2 = mY1;
+      mY1 = y;
+      buf[i] = y;
+      mC0 += mDC0;
+      mC1 += mDC1;
+      mC2 += mDC2;
+      mCountdown--;
+    }
+  }
+
+private:
+  static void coefficients(float freq, float width, double sampleRate,
+                           float &c0, float &c1, float &c2) {
+    double r = std::exp(-M_PI * width / sampleRate);
+    double theta = 2.0 * M_PI * freq / sampleRate;
+    c0 = float((1.0 - r * r) * std::sin(theta));
+    c1 = float(2.0 * r * std::cos(theta));
+    c2 = float(-r * r);
+  }
+
+  void setCoefficients(float freq, float width) {
+    coefficients(freq, width, mSampleRate, mC0, mC1, mC2);
+  }
+
+  // Ramps from the current coefficients to the ones for freq and width over
+  // the next control period
+  void nextControlPoint(float freq, float width) {
+    float c0, c1, c2;
+    coefficients(freq, width, mSampleRate, c0, c1, c2);
+    float scale = 1.0f / mControlPeriod;
+    mDC0 = (c0 - mC0) * scale;
+    mDC1 = (c1 - mC1) * scale;
+    mDC2 = (c2 - mC2) * scale;
+    mCountdown = mControlPeriod;
+  }
+
+  void updateControlDomain() {
+    mControlDomain.spu(mSampleRate / mControlPeriod);
+  }
+
+  double mSampleRate{44100.0};
+  int mControlPeriod{32};
+  gam::Domain mControlDomain;
+
+  // Current coefficients and their increment per sample
+  float mC0{0}, mC1{0}, mC2{0};
+  float mDC0{0}, mDC1{0}, mDC2{0};
+  float mY1{0}, mY2{0};
+  int mCountdown{0};
+  bool mFirst{true};
+};
+
+#endif // ControlRateReson_H
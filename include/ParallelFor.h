@@ -0,0 +1,142 @@
+#pragma once
+#ifndef ParallelFor_H
+#define ParallelFor_H
+
+// Runs a loop over an index range on a pool of worker threads.
+//
+// The range is cut into chunks of a given grain. The calling thread and the
+// workers take chunks from a shared counter until none are left, so uneven
+// chunks balance out. operator() returns once every chunk is done. The
+// workers are started once and sleep between loops, so a loop costs a wake
+// up rather than a thread start.
+//
+// The loop body must only write to data owned by its own chunk.
+//
+// Usage:
+//   ParallelFor parallel;  // One thread per core, the caller included
+//   parallel(count, 256, [&](size_t begin, size_t end) {
+//     for (size_t i = begin; i < end; i++) {
+//       ...
+//     }
+//   });
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ParallelFor {
+public:
+  // numThreads includes the calling thread. 0 uses one per core.
+  explicit ParallelFor(unsigned int numThreads = 0) { threads(numThreads); }
+
+  ~ParallelFor() { stopWorkers(); }
+
+  void threads(unsigned int numThreads) {
+    if (numThreads == 0) {
+      numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    stopWorkers();
+    std::unique_lock<std::mutex> lk(mJobLock);
+    mNumThreads = numThreads;
+    mRunning = true;
+    // New workers wait for the next loop, not one that already ran
+    for (unsigned int i = 1; i < mNumThreads; i++) {
+      mWorkers.emplace_back(
+          [this, generation = mJobGeneration]() { workerFunction(generation); });
+    }
+  }
+
+  unsigned int threads() const { return mNumThreads; }
+
+  // Calls body(begin, end) for consecutive chunks of at most grain indices
+  // covering [0, count)
+  template <class Body> void operator()(size_t count, size_t grain, Body &&body) {
+    grain = std::max<size_t>(grain, 1);
+    if (mWorkers.empty() || count <= grain) {
+      for (size_t begin = 0; begin < count; begin += grain) {
+        body(begin, std::min(begin + grain, count));
+      }
+      return;
+    }
+    {
+      std::unique_lock<std::mutex> lk(mJobLock);
+      mBody = &body;
+      mInvoke = [](void *b, size_t begin, size_t end) {
+        (*static_cast<typename std::remove_reference<Body>::type *>(b))(begin,
+                                                                        end);
+      };
+      mCount = count;
+      mGrain = grain;
+      mNextChunk = 0;
+      mWorkersDone = 0;
+      mJobGeneration++;
+    }
+    mJobCondition.notify_all();
+    runChunks(); // The caller works too
+    // Wait for every worker, not just for the last chunk, so no worker still
+    // holds the body when this returns
+    while (mWorkersDone.load(std::memory_order_acquire) < mWorkers.size()) {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  void runChunks() {
+    size_t chunk;
+    while ((chunk = mNextChunk.fetch_add(1)) * mGrain < mCount) {
+      size_t begin = chunk * mGrain;
+      mInvoke(mBody, begin, std::min(begin + mGrain, mCount));
+    }
+  }
+
+  void workerFunction(uint64_t generation) {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lk(mJobLock);
+        mJobCondition.wait(lk, [&]() {
+          return !mRunning || mJobGeneration != generation;
+        });
+        if (!mRunning) {
+          return;
+        }
+        generation = mJobGeneration;
+      }
+      runChunks();
+      mWorkersDone.fetch_add(1, std::memory_order_release);
+    }
+  }
+
+  void stopWorkers() {
+    {
+      std::unique_lock<std::mutex> lk(mJobLock);
+      mRunning = false;
+    }
+    mJobCondition.notify_all();
+    for (auto &worker : mWorkers) {
+      worker.join();
+    }
+    mWorkers.clear();
+  }
+
+  unsigned int mNumThreads{1};
+  std::vector<std::thread> mWorkers;
+  std::mutex mJobLock;
+  std::condition_variable mJobCondition;
+  uint64_t mJobGeneration{0};
+  bool mRunning{false};
+
+  // The current loop, set under mJobLock before the workers wake up
+  void *mBody{nullptr};
+  void (*mInvoke)(void *, size_t, size_t){nullptr};
+  size_t mCount{0};
+  size_t mGrain{1};
+  std::atomic<size_t> mNextChunk{0};
+  std::atomic<size_t> mWorkersDone{0};
+};
+
+#endif // ParallelFor_H
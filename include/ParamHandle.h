@@ -0,0 +1,28 @@
+#pragma once
+#ifndef ParamHandle_H
+#define ParamHandle_H
+
+// Handle to an internal trigger parameter of a SynthVoice.
+//
+// getInternalParameterValue() searches the voice's parameters by name on
+// every call, which in onProcess() means string compares on the audio
+// thread every block. A ParamHandle is bound once in init() to the
+// parameter createInternalTriggerParameter() returns and then reads the
+// value directly.
+//
+// Usage:
+//   ParamHandle pFrequency;
+//   pFrequency.bind(createInternalTriggerParameter("frequency", 440, 20, 5000));
+//   float freq = pFrequency.get();           // In onProcess()
+
+#include <memory>
+
+#include "al/ui/al_Parameter.hpp"
+
+struct ParamHandle {
+  al::Parameter *param = nullptr;
+  void bind(std::shared_ptr<al::Parameter> p) { param = p.get(); }
+  float get() const { return param->get(); }
+};
+
+#endif // ParamHandle_H
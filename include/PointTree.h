@@ -0,0 +1,367 @@
+#pragma once
+#ifndef PointTree_H
+#define PointTree_H
+
+// Bounding volume tree over points, for picking and hovering.
+//
+// Picking a point out of a data set by testing the ray against a sphere
+// around every point costs a test per point per mouse move, which stops
+// being interactive somewhere past a few hundred thousand points. PointTree
+// splits the points at the median of the longest axis of their bounds,
+// down to leaves of a few points, and keeps the bounds of each node. A ray
+// only visits the nodes its path crosses, nearest first, and stops at nodes
+// farther than the closest hit so far; a nearest point query skips nodes
+// farther than the closest point so far. Both take about log N node visits.
+//
+// Points can be added one at a time. They are kept in a few trees of
+// doubling sizes: an insert lands in a small list that is searched point by
+// point, and when the list is full it is merged with the trees of the sizes
+// below it into one new tree. Each point is rebuilt into O(log N) trees over
+// its lifetime, and a query searches O(log N) trees.
+//
+// intersect() gives the same point as testing every point with
+// al::Ray::intersectSphere() and keeping the smallest positive t. Queries
+// don't change the tree, so many threads can query at once.
+//
+// Usage:
+//   PointTree points;
+//   points.radius(0.02f);                 // Sphere around each point
+//   points.build(data.data(), data.size());
+//   points.insert(Vec3f(0.5f, 0.5f, 0.5f));
+//   auto hit = points.intersect(ray.o, ray.d);    // hit.index, -1 if none
+//   auto closest = points.nearest(Vec3f(0, 0, 0)); // .t is the distance
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+#include "al/math/al_Vec.hpp"
+
+class PointTree {
+public:
+  struct Hit {
+    int index{-1}; // Point hit, -1 for none
+    double t{0};   // Along the ray, or distance for nearest()
+  };
+
+  // Radius of the sphere around each point that rays hit
+  void radius(float radius) { mRadius = std::max(radius, 0.0f); }
+  float radius() const { return mRadius; }
+
+  // Points per leaf, at least 1. Takes effect for trees built after it.
+  void leafSize(int points) { mLeafSize = std::max(points, 1); }
+
+  size_t size() const { return mPoints.size(); }
+
+  const al::Vec3f &operator[](size_t i) const { return mPoints[i]; }
+
+  void clear() {
+    mPoints.clear();
+    mPending.clear();
+    mLevels.clear();
+  }
+
+  // Replaces the points with n copied from points, in one tree
+  void build(const al::Vec3f *points, size_t n) {
+    clear();
+    mPoints.assign(points, points + n);
+    std::vector<int> indices(n);
+    for (size_t i = 0; i < n; i++) {
+      indices[i] = int(i);
+    }
+    size_t level = 0;
+    while (levelSize(level) < n) {
+      level++;
+    }
+    mLevels.resize(level + 1);
+    buildLevel(mLevels[level], indices);
+  }
+
+  // Adds a point and returns its index
+  int insert(const al::Vec3f &point) {
+    int index = int(mPoints.size());
+    mPoints.push_back(point);
+    mPending.push_back(index);
+    if (mPending.size() < pendingSize) {
+      return index;
+    }
+    // Carry the full list up like a binary counter
+    std::vector<int> carry;
+    carry.swap(mPending);
+    for (size_t level = 0;; level++) {
+      if (level == mLevels.size()) {
+        mLevels.emplace_back();
+      }
+      Level &l = mLevels[level];
+      if (l.indices.empty() && carry.size() <= levelSize(level)) {
+        buildLevel(l, carry);
+        break;
+      }
+      carry.insert(carry.end(), l.indices.begin(), l.indices.end());
+      l = Level();
+    }
+    return index;
+  }
+
+  // The first point whose sphere the ray from origin along direction hits,
+  // at the smallest t > 0
+  template <class Vec>
+  Hit intersect(const Vec &origin, const Vec &direction) const {
+    Ray ray;
+    for (int k = 0; k < 3; k++) {
+      ray.o[k] = double(origin[k]);
+      ray.d[k] = double(direction[k]);
+      ray.inverse[k] = 1.0 / ray.d[k];
+    }
+    ray.a = ray.d[0] * ray.d[0] + ray.d[1] * ray.d[1] + ray.d[2] * ray.d[2];
+    Hit best;
+    best.t = DBL_MAX;
+    for (int i : mPending) {
+      sphere(ray, i, best);
+    }
+    for (auto &level : mLevels) {
+      intersect(level, ray, best);
+    }
+    if (best.index < 0) {
+      best.t = 0;
+    }
+    return best;
+  }
+
+  // The closest point to point, if any is within maxDistance
+  Hit nearest(const al::Vec3f &point, float maxDistance = FLT_MAX) const {
+    Hit best;
+    best.t = double(maxDistance) * maxDistance;
+    for (int i : mPending) {
+      closer(point, i, best);
+    }
+    for (auto &level : mLevels) {
+      nearest(level, point, best);
+    }
+    best.t = best.index < 0 ? 0 : std::sqrt(best.t);
+    return best;
+  }
+
+private:
+  static const size_t pendingSize = 64;
+
+  struct Node {
+    al::Vec3f low, high;
+    int begin, end; // Points, in the level's order
+    int right;      // Second child, -1 for a leaf. The first follows this.
+  };
+
+  struct Level {
+    std::vector<Node> nodes;
+    std::vector<al::Vec3f> points; // Copies, in leaf order
+    std::vector<int> indices;
+  };
+
+  struct Ray {
+    double o[3], d[3], inverse[3], a;
+  };
+
+  size_t levelSize(size_t level) const { return pendingSize << level; }
+
+  void buildLevel(Level &level, std::vector<int> &indices) {
+    level.indices.swap(indices);
+    level.nodes.clear();
+    level.nodes.reserve(2 * level.indices.size() / mLeafSize + 1);
+    if (!level.indices.empty()) {
+      buildNode(level, 0, int(level.indices.size()));
+    }
+    level.points.resize(level.indices.size());
+    for (size_t i = 0; i < level.indices.size(); i++) {
+      level.points[i] = mPoints[level.indices[i]];
+    }
+  }
+
+  void buildNode(Level &level, int begin, int end) {
+    int node = int(level.nodes.size());
+    level.nodes.push_back(Node());
+    al::Vec3f low(FLT_MAX), high(-FLT_MAX);
+    for (int i = begin; i < end; i++) {
+      const al::Vec3f &p = mPoints[level.indices[i]];
+      for (int k = 0; k < 3; k++) {
+        low[k] = std::min(low[k], p[k]);
+        high[k] = std::max(high[k], p[k]);
+      }
+    }
+    level.nodes[node] = Node{low, high, begin, end, -1};
+    if (end - begin <= mLeafSize) {
+      return;
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; k++) {
+      if (high[k] - low[k] > high[axis] - low[axis]) {
+        axis = k;
+      }
+    }
+    int middle = begin + (end - begin) / 2;
+    auto first = level.indices.begin();
+    std::nth_element(first + begin, first + middle, first + end,
+                     [&](int a, int b) {
+                       return mPoints[a][axis] < mPoints[b][axis];
+                     });
+    buildNode(level, begin, middle);
+    level.nodes[node].right = int(level.nodes.size());
+    buildNode(level, middle, end);
+  }
+
+  // Where the ray enters the node's bounds grown by the radius, or DBL_MAX
+  // if it misses them or they are behind it
+  double enter(const Node &node, const Ray &ray) const {
+    double tNear = -DBL_MAX, tFar = DBL_MAX;
+    for (int k = 0; k < 3; k++) {
+      double low = double(node.low[k]) - mRadius;
+      double high = double(node.high[k]) + mRadius;
+      if (ray.d[k] == 0) {
+        if (ray.o[k] < low || ray.o[k] > high) {
+          return DBL_MAX;
+        }
+        continue;
+      }
+      double t0 = (low - ray.o[k]) * ray.inverse[k];
+      double t1 = (high - ray.o[k]) * ray.inverse[k];
+      tNear = std::max(tNear, std::min(t0, t1));
+      tFar = std::min(tFar, std::max(t0, t1));
+    }
+    return tNear <= tFar && tFar > 0 ? tNear : DBL_MAX;
+  }
+
+  // al::Ray::intersectSphere(), keeping the hit if it is the closest yet
+  void sphere(const Ray &ray, const al::Vec3f &center, int index,
+              Hit &best) const {
+    double oc[3];
+    for (int k = 0; k < 3; k++) {
+      oc[k] = ray.o[k] - double(center[k]);
+    }
+    double b = 2 * (ray.d[0] * oc[0] + ray.d[1] * oc[1] + ray.d[2] * oc[2]);
+    double c = oc[0] * oc[0] + oc[1] * oc[1] + oc[2] * oc[2] -
+               double(mRadius) * mRadius;
+    double det = b * b - 4 * ray.a * c;
+    double t = -1;
+    if (det > 0) {
+      double t1 = (-b - std::sqrt(det)) / (2 * ray.a);
+      double t2 = (-b + std::sqrt(det)) / (2 * ray.a);
+      t = t1 > 0 ? t1 : t2;
+    } else if (det == 0) {
+      t = -b / (2 * ray.a);
+    }
+    if (t > 0 && (t < best.t || (t == best.t && index < best.index))) {
+      best.t = t;
+      best.index = index;
+    }
+  }
+
+  void sphere(const Ray &ray, int index, Hit &best) const {
+    sphere(ray, mPoints[index], index, best);
+  }
+
+  void intersect(const Level &level, const Ray &ray, Hit &best) const {
+    if (level.nodes.empty()) {
+      return;
+    }
+    int stack[128];
+    int top = 0;
+    if (enter(level.nodes[0], ray) <= best.t) {
+      stack[top++] = 0;
+    }
+    while (top > 0) {
+      const Node &node = level.nodes[stack[--top]];
+      if (node.right < 0) {
+        for (int i = node.begin; i < node.end; i++) {
+          sphere(ray, level.points[i], level.indices[i], best);
+        }
+        continue;
+      }
+      int left = int(&node - level.nodes.data()) + 1;
+      double tLeft = enter(level.nodes[left], ray);
+      double tRight = enter(level.nodes[node.right], ray);
+      // Push the farther child first, so the nearer one is searched first
+      int children[2] = {left, node.right};
+      double ts[2] = {tLeft, tRight};
+      int nearer = tLeft <= tRight ? 0 : 1;
+      for (int c : {1 - nearer, nearer}) {
+        if (ts[c] != DBL_MAX && ts[c] <= best.t) {
+          stack[top++] = children[c];
+        }
+      }
+    }
+  }
+
+  static double distance2(const al::Vec3f &a, const al::Vec3f &b) {
+    double d = 0;
+    for (int k = 0; k < 3; k++) {
+      double e = double(a[k]) - b[k];
+      d += e * e;
+    }
+    return d;
+  }
+
+  // Squared distance from the point to the node's bounds
+  static double distance2(const Node &node, const al::Vec3f &p) {
+    double d = 0;
+    for (int k = 0; k < 3; k++) {
+      double e = std::max({double(node.low[k]) - p[k], 0.0,
+                           double(p[k]) - node.high[k]});
+      d += e * e;
+    }
+    return d;
+  }
+
+  void closer(const al::Vec3f &point, const al::Vec3f &p, int index,
+              Hit &best) const {
+    double d = distance2(point, p);
+    if (d < best.t || (d == best.t && index < best.index)) {
+      best.t = d;
+      best.index = index;
+    }
+  }
+
+  void closer(const al::Vec3f &point, int index, Hit &best) const {
+    closer(point, mPoints[index], index, best);
+  }
+
+  void nearest(const Level &level, const al::Vec3f &point, Hit &best) const {
+    if (level.nodes.empty()) {
+      return;
+    }
+    int stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const Node &node = level.nodes[stack[--top]];
+      if (distance2(node, point) > best.t) {
+        continue;
+      }
+      if (node.right < 0) {
+        for (int i = node.begin; i < node.end; i++) {
+          closer(point, level.points[i], level.indices[i], best);
+        }
+        continue;
+      }
+      int left = int(&node - level.nodes.data()) + 1;
+      // Search the closer child first
+      if (distance2(level.nodes[left], point) <
+          distance2(level.nodes[node.right], point)) {
+        stack[top++] = node.right;
+        stack[top++] = left;
+      } else {
+        stack[top++] = left;
+        stack[top++] = node.right;
+      }
+    }
+  }
+
+  float mRadius{0};
+  int mLeafSize{8};
+  std::vector<al::Vec3f> mPoints;
+  std::vector<int> mPending; // Not in a tree yet
+  std::vector<Level> mLevels;
+};
+
+#endif // PointTree_H
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef SequenceEndTime_H
+#define SequenceEndTime_H
+
+// Length of a .synthSequence file, for rendering it offline.
+//
+// A render that isn't driven by a clock has to know when to stop, and the
+// sequencer only tells once the last event has been played. sequenceEndTime()
+// scans the file for the time at which its last event ends instead. Lines
+// starting with '@' carry absolute start times, lines starting with '+' are
+// relative to the previous event.
+//
+// Usage:
+//   double endTime = sequenceEndTime("integrated.synthSequence"); // Seconds
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// Latest end time of the events in the file, 0 if it has none
+inline double sequenceEndTime(const std::string &path) {
+  std::ifstream f(path);
+  std::string line;
+  double time = 0.0;
+  double end = 0.0;
+  while (std::getline(f, line)) {
+    if (line.size() < 2 || (line[0] != '@' && line[0] != '+')) {
+      continue;
+    }
+    std::istringstream ss(line.substr(1));
+    double start = 0.0, duration = 0.0;
+    if (!(ss >> start >> duration)) {
+      continue;
+    }
+    time = (line[0] == '@') ? start : time + start;
+    if (time + duration > end) {
+      end = time + duration;
+    }
+  }
+  return end;
+}
+
+#endif // SequenceEndTime_H
@@ -0,0 +1,159 @@
+#pragma once
+#ifndef WavetableBank_H
+#define WavetableBank_H
+
+// Oscillator wavetables shared by every voice in the process.
+//
+// The tutorial voices used to add their partials to global tables in init(),
+// which runs once per voice allocated. Allocating polyphony rebuilt the same
+// tables over and over, and each pass added to what was already there. The
+// bank builds every table once, the first time get() is called, and never
+// changes them afterwards. Voices refer to a wave by its ID, which matches the
+// "table" parameter of the voices (plus DIN for the AM voices).
+//
+// Each wave is kept as a set of band-limited tables: one with its lowest
+// partial, one with its two lowest, and so on up to one with all of them.
+// table() picks the richest table whose highest partial stays below Nyquist
+// for the given fundamental, so high notes don't alias. The choice goes by
+// the wave's own partials, so a wave whose partials start high (TB_3, TB_4,
+// DIN) keeps sounding as long as any of them fits. A fundamental so high
+// that not even the lowest partial fits gets a silent table.
+//
+// get() builds the bank the first time it is called, so call it once before
+// audio starts (voices do it in init()).
+//
+// Usage:
+//   // In init()
+//   WavetableBank::get();
+//   // On trigger
+//   mOsc.source(WavetableBank::get().table(WavetableBank::SAW, frequency));
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "Gamma/Domain.h"
+#include "Gamma/Oscillator.h"
+
+class WavetableBank {
+public:
+  enum Wave {
+    SAW = 0,
+    SQUARE,
+    IMPULSE,
+    SINE,
+    PULSE,
+    TB_1, // Harmonics 1, 4, 7, 11, 15 and 18
+    TB_2, // Harmonics 3 to 16
+    TB_3, // Harmonics 10 to 135
+    TB_4, // Harmonics 20 to 27
+    DIN,
+    NUM_WAVES
+  };
+
+  static const int tableSize = 2048;
+
+  static WavetableBank &get() {
+    static WavetableBank bank;
+    return bank;
+  }
+
+  // Table for wave, band limited for a fundamental of frequency Hz at
+  // gam::sampleRate(). Out of range waves give SINE. The table must not be
+  // written to. It is not const only because gam::Osc::source() takes a
+  // non-const reference.
+  gam::ArrayPow2<float> &table(int wave, float frequency) {
+    return *level(wave, frequency, gam::sampleRate()).table;
+  }
+
+  // Table for wave with all its partials
+  gam::ArrayPow2<float> &table(int wave) {
+    return *mLevels[validWave(wave)].back().table;
+  }
+
+  // Highest harmonic in the table that table(wave, frequency) gives at
+  // sampleRate
+  float maxHarmonic(int wave, float frequency, double sampleRate) const {
+    return level(wave, frequency, sampleRate).maxHarmonic;
+  }
+
+  // Number of distinct tables kept
+  size_t numTables() const { return mTables.size(); }
+
+private:
+  struct Partial {
+    float amplitude;
+    float harmonic;
+  };
+
+  struct Level {
+    float maxHarmonic; // Highest partial in the table
+    gam::ArrayPow2<float> *table;
+  };
+
+  // Richest table of wave without partials at or above Nyquist, or the
+  // silent one if every table has one
+  const Level &level(int wave, float frequency, double sampleRate) const {
+    const std::vector<Level> &levels = mLevels[validWave(wave)];
+    if (frequency <= 0.0f) {
+      return levels.back();
+    }
+    double limit = 0.5 * sampleRate / frequency;
+    for (size_t i = levels.size(); i > 0; i--) {
+      if (levels[i - 1].maxHarmonic < limit) {
+        return levels[i - 1];
+      }
+    }
+    return mSilence;
+  }
+
+  WavetableBank() {
+    std::vector<Partial> partials[NUM_WAVES];
+    for (int h = 1; h <= 9; h++) {
+      partials[SAW].push_back({1.0f / h, float(h)});
+      partials[SQUARE].push_back({1.0f / (2 * h - 1), float(2 * h - 1)});
+      partials[IMPULSE].push_back({1.0f, float(h)});
+    }
+    partials[SINE] = {{1, 1}};
+    partials[PULSE] = {{1, 1},   {1, 2},   {1, 3},   {1, 4},
+                       {0.7, 5}, {0.5, 6}, {0.3, 7}, {0.1, 8}};
+    partials[TB_1] = {{1, 1},    {0.4, 4},   {0.65, 7},
+                      {0.3, 11}, {0.18, 15}, {0.08, 18}};
+    partials[TB_2] = {{0.5, 3},  {0.8, 4},  {0.7, 7},  {1, 8},
+                      {0.3, 11}, {0.4, 12}, {0.2, 15}, {0.12, 16}};
+    partials[TB_3] = {{1, 10},    {0.7, 27},   {0.45, 54},
+                      {0.3, 81},  {0.15, 108}, {0.08, 135}};
+    partials[TB_4] = {{0.2, 20}, {0.4, 21}, {0.6, 22}, {1, 23},
+                      {0.7, 24}, {0.5, 25}, {0.3, 26}, {0.1, 27}};
+    partials[DIN] = partials[TB_3];
+
+    mTables.emplace_back(unsigned(tableSize), 0.0f);
+    mSilence = {0.0f, &mTables.back()};
+    for (int wave = 0; wave < NUM_WAVES; wave++) {
+      std::sort(partials[wave].begin(), partials[wave].end(),
+                [](const Partial &a, const Partial &b) {
+                  return a.harmonic < b.harmonic;
+                });
+      // One table per partial, holding it and every partial below it
+      std::vector<float> amps, harmonics;
+      for (auto &p : partials[wave]) {
+        amps.push_back(p.amplitude);
+        harmonics.push_back(p.harmonic);
+        mTables.emplace_back(unsigned(tableSize), 0.0f);
+        gam::addSines(mTables.back(), amps.data(), harmonics.data(),
+                      int(amps.size()));
+        mLevels[wave].push_back({p.harmonic, &mTables.back()});
+      }
+    }
+  }
+
+  static int validWave(int wave) {
+    return wave >= 0 && wave < NUM_WAVES ? wave : int(SINE);
+  }
+
+  std::deque<gam::ArrayPow2<float>> mTables; // Addresses never change
+  std::vector<Level> mLevels[NUM_WAVES];     // By highest partial, rising
+  Level mSilence;
+};
+
+#endif // WavetableBank_H
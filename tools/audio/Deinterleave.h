@@ -0,0 +1,178 @@
+#pragma once
+#ifndef Deinterleave_H
+#define Deinterleave_H
+
+// Mixes interleaved sound file frames into separate output buffers.
+//
+// deinterleaveGainAdd() does out[c][i] += gain * in[i * channels + c] for all
+// channels c in one pass. Mono and stereo and 4 channel files, the common
+// cases for stems, use SSE or NEON shuffles (and AVX for mono). Other channel
+// counts use AVX2 gathers if available, or a scalar loop otherwise.
+//
+// Usage:
+//   float *outs[2] = {io.outBuffer(4), io.outBuffer(5)};
+//   deinterleaveGainAdd(outs, buffer, 2, gain, framesRead);
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define DEINTERLEAVE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DEINTERLEAVE_NEON
+#endif
+
+namespace deinterleave {
+
+// out[i] += gain * in[i * stride]
+inline void gainAddStrided(float *out, const float *in, int stride, float gain,
+                           int begin, int end) {
+  for (int i = begin; i < end; i++) {
+    out[i] += gain * in[i * stride];
+  }
+}
+
+// out[i] += gain * in[i]
+inline void gainAdd(float *out, const float *in, float gain, int frames) {
+  int i = 0;
+#if defined(__AVX__)
+  const __m256 g8 = _mm256_set1_ps(gain);
+  for (; i + 8 <= frames; i += 8) {
+    _mm256_storeu_ps(out + i,
+                     _mm256_add_ps(_mm256_loadu_ps(out + i),
+                                   _mm256_mul_ps(_mm256_loadu_ps(in + i), g8)));
+  }
+#elif defined(DEINTERLEAVE_SSE2)
+  const __m128 g4 = _mm_set1_ps(gain);
+  for (; i + 4 <= frames; i += 4) {
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i),
+                                      _mm_mul_ps(_mm_loadu_ps(in + i), g4)));
+  }
+#elif defined(DEINTERLEAVE_NEON)
+  for (; i + 4 <= frames; i += 4) {
+    vst1q_f32(out + i,
+              vmlaq_n_f32(vld1q_f32(out + i), vld1q_f32(in + i), gain));
+  }
+#endif
+  gainAddStrided(out, in, 1, gain, i, frames);
+}
+
+// Accumulates a vector into out + i, unless out is nullptr
+#if defined(DEINTERLEAVE_SSE2)
+inline void addTo(float *out, int i, __m128 v) {
+  if (out) {
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), v));
+  }
+}
+#elif defined(DEINTERLEAVE_NEON)
+inline void addTo(float *out, int i, float32x4_t v) {
+  if (out) {
+    vst1q_f32(out + i, vaddq_f32(vld1q_f32(out + i), v));
+  }
+}
+#endif
+
+// Two channels, four frames at a time. Returns the first frame not done.
+inline int gainAdd2(float *const *out, const float *in, float gain,
+                    int frames) {
+  int i = 0;
+#if defined(DEINTERLEAVE_SSE2)
+  const __m128 g4 = _mm_set1_ps(gain);
+  for (; i + 4 <= frames; i += 4) {
+    __m128 a = _mm_loadu_ps(in + 2 * i);
+    __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+    addTo(out[0], i, _mm_mul_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), g4));
+    addTo(out[1], i, _mm_mul_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), g4));
+  }
+#elif defined(DEINTERLEAVE_NEON)
+  for (; i + 4 <= frames; i += 4) {
+    float32x4x2_t v = vld2q_f32(in + 2 * i);
+    addTo(out[0], i, vmulq_n_f32(v.val[0], gain));
+    addTo(out[1], i, vmulq_n_f32(v.val[1], gain));
+  }
+#endif
+  return i;
+}
+
+// Four channels, four frames at a time. Returns the first frame not done.
+inline int gainAdd4(float *const *out, const float *in, float gain,
+                    int frames) {
+  int i = 0;
+#if defined(DEINTERLEAVE_SSE2)
+  const __m128 g4 = _mm_set1_ps(gain);
+  for (; i + 4 <= frames; i += 4) {
+    __m128 c0 = _mm_loadu_ps(in + 4 * i);
+    __m128 c1 = _mm_loadu_ps(in + 4 * i + 4);
+    __m128 c2 = _mm_loadu_ps(in + 4 * i + 8);
+    __m128 c3 = _mm_loadu_ps(in + 4 * i + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    addTo(out[0], i, _mm_mul_ps(c0, g4));
+    addTo(out[1], i, _mm_mul_ps(c1, g4));
+    addTo(out[2], i, _mm_mul_ps(c2, g4));
+    addTo(out[3], i, _mm_mul_ps(c3, g4));
+  }
+#elif defined(DEINTERLEAVE_NEON)
+  for (; i + 4 <= frames; i += 4) {
+    float32x4x4_t v = vld4q_f32(in + 4 * i);
+    for (int c = 0; c < 4; c++) {
+      addTo(out[c], i, vmulq_n_f32(v.val[c], gain));
+    }
+  }
+#endif
+  return i;
+}
+
+// Any number of channels, eight frames at a time with AVX2 gathers. Returns
+// the first frame not done for channel c.
+inline int gainAddGather(float *out, const float *in, int channels, int c,
+                         float gain, int frames) {
+  int i = 0;
+#if defined(__AVX2__)
+  const __m256i index =
+      _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                         _mm256_set1_epi32(channels));
+  const __m256 g8 = _mm256_set1_ps(gain);
+  for (; i + 8 <= frames; i += 8) {
+    __m256 v = _mm256_i32gather_ps(in + i * channels + c, index, 4);
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i),
+                                            _mm256_mul_ps(v, g8)));
+  }
+#endif
+  return i;
+}
+
+} // namespace deinterleave
+
+// out[c][i] += gain * in[i * channels + c] for c in [0, channels) and i in
+// [0, frames). Channels whose out[c] is nullptr are skipped. Output buffers
+// may repeat, but must not overlap in.
+inline void deinterleaveGainAdd(float *const *out, const float *in,
+                                int channels, float gain, int frames) {
+  using namespace deinterleave;
+  if (channels == 1) {
+    if (out[0]) {
+      gainAdd(out[0], in, gain, frames);
+    }
+    return;
+  }
+  int done = 0;
+  if (channels == 2) {
+    done = gainAdd2(out, in, gain, frames);
+  } else if (channels == 4) {
+    done = gainAdd4(out, in, gain, frames);
+  }
+  for (int c = 0; c < channels; c++) {
+    if (out[c]) {
+      int begin = done;
+      if (begin == 0) {
+        begin = gainAddGather(out[c], in, channels, c, gain, frames);
+      }
+      gainAddStrided(out[c], in + c, channels, gain, begin, frames);
+    }
+  }
+}
+
+#endif // Deinterleave_H
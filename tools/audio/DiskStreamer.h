@@ -0,0 +1,414 @@
+#pragma once
+#ifndef DiskStreamer_H
+#define DiskStreamer_H
+
+// Streams any number of sound files from disk with a single I/O thread.
+//
+// Each stream has a ring buffer holding prefetchSeconds() of audio ahead of
+// the read position. The I/O thread keeps the rings topped up, always serving
+// the emptiest stream first, and reads in large chunks that fall on chunk
+// boundaries of the file. The audio thread only copies out of the rings in
+// read(), which never blocks, locks or allocates. When a ring runs dry before
+// the end of its file the read comes up short and the stream's underrun
+// counter is increased.
+//
+// Seeks never interrupt playback. requestSeek() has the I/O thread pre-roll
+// every stream from the new position into a second, standby ring while the
+// current audio keeps playing, and applySeek() switches all streams over at
+// once at the start of a block, so stems stay sample aligned. The I/O thread
+// keeps topping up the active rings during the pre-roll too, moving the
+// file between the two positions as it goes.
+//
+// A stream can be a mono stem or an interleaved multichannel file. read()
+// returns interleaved frames in both cases.
+//
+// Usage:
+//   DiskStreamer streamer;
+//   streamer.prefetchSeconds(4.0);
+//   int stem = streamer.addStream("stem01.wav");
+//   ...
+//   streamer.start();
+//   // In onSound():
+//   streamer.applySeek();
+//   int framesRead = streamer.read(stem, buffer, io.framesPerBuffer());
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+class DiskStreamer {
+public:
+  ~DiskStreamer() {
+    stop();
+    for (auto &stream : mStreams) {
+      sf_close(stream->file);
+    }
+  }
+
+  // Seconds of audio kept ready ahead of the read position of every stream.
+  // Must be set before start().
+  void prefetchSeconds(double seconds) { mPrefetchSeconds = seconds; }
+  double prefetchSeconds() const { return mPrefetchSeconds; }
+
+  // Opens a sound file as a new stream and returns its index, or -1 if the
+  // file can't be opened. All streams must be added before start().
+  int addStream(const std::string &path, bool loop = false) {
+    auto stream = std::make_unique<Stream>();
+    stream->file = sf_open(path.c_str(), SFM_READ, &stream->info);
+    if (!stream->file) {
+      std::cerr << "ERROR: DiskStreamer: " << sf_strerror(nullptr)
+                << std::endl;
+      return -1;
+    }
+    stream->loop = loop;
+    mStreams.push_back(std::move(stream));
+    return int(mStreams.size()) - 1;
+  }
+
+  int numStreams() const { return int(mStreams.size()); }
+  int channels(int stream) const { return mStreams[stream]->info.channels; }
+  double frameRate(int stream) const {
+    return mStreams[stream]->info.samplerate;
+  }
+  int64_t frames(int stream) const { return mStreams[stream]->info.frames; }
+
+  // Allocates the rings, fills them and starts the I/O thread.
+  void start() {
+    if (mRunning) {
+      return;
+    }
+    size_t maxChunk = 0;
+    for (auto &stream : mStreams) {
+      int channels = stream->info.channels;
+      stream->capacity = std::max<int64_t>(
+          int64_t(mPrefetchSeconds * stream->info.samplerate),
+          4 * minChunkFrames);
+      stream->chunkFrames = std::max<int64_t>(
+          int64_t(minChunkFrames),
+          std::min<int64_t>(readChunkBytes / (channels * sizeof(float)),
+                            stream->capacity / 4));
+      for (auto &ring : stream->rings) {
+        ring.data.resize(stream->capacity * channels);
+      }
+      maxChunk = std::max<size_t>(maxChunk, stream->chunkFrames * channels);
+    }
+    mReadBuffer.resize(maxChunk);
+    // Prime every active ring so playback starts without underruns
+    for (auto &stream : mStreams) {
+      while (fillChunk(*stream, stream->rings[0])) {
+      }
+    }
+    mRunning = true;
+    mThread = std::thread([this]() { ioThreadFunction(); });
+  }
+
+  void stop() {
+    if (!mRunning) {
+      return;
+    }
+    {
+      std::unique_lock<std::mutex> lk(mLock);
+      mRunning = false;
+    }
+    mCondition.notify_one();
+    mThread.join();
+  }
+
+  // Audio thread. Copies up to numFrames interleaved frames of the stream
+  // into buffer and returns the number of frames copied.
+  int read(int index, float *buffer, int numFrames) {
+    Stream &stream = *mStreams[index];
+    Ring &ring = stream.rings[stream.active.load(std::memory_order_relaxed)];
+    uint64_t readCount = ring.readCount.load(std::memory_order_relaxed);
+    uint64_t available =
+        ring.writeCount.load(std::memory_order_acquire) - readCount;
+    int framesRead = int(std::min<uint64_t>(available, numFrames));
+
+    int channels = stream.info.channels;
+    int64_t start = int64_t(readCount % stream.capacity);
+    int64_t firstPart = std::min<int64_t>(framesRead, stream.capacity - start);
+    std::copy_n(ring.data.data() + start * channels, firstPart * channels,
+                buffer);
+    std::copy_n(ring.data.data(), (framesRead - firstPart) * channels,
+                buffer + firstPart * channels);
+    ring.readCount.store(readCount + framesRead, std::memory_order_release);
+
+    uint64_t endCount = ring.endCount.load(std::memory_order_acquire);
+    if (framesRead < numFrames && readCount + framesRead != endCount) {
+      stream.underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return framesRead;
+  }
+
+  // Asks the I/O thread to pre-roll all streams from the given frame into
+  // their standby rings. Reads keep returning audio from the current
+  // position until applySeek() switches over. Never blocks, so it can be
+  // called from the audio thread, which must then be the only caller.
+  void requestSeek(int64_t frame) {
+    mSeekTarget.store(frame, std::memory_order_relaxed);
+    mSeekRequest.store(mSeekRequest.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+  }
+
+  // Audio thread. Switches every stream to its standby ring at once if the
+  // last requested seek has been pre-rolled, so all streams continue from the
+  // same frame on the next read(). Call at the start of a block. Returns true
+  // if the switch happened.
+  bool applySeek() {
+    uint64_t request = mSeekRequest.load(std::memory_order_relaxed);
+    if (request == mSeekApplied ||
+        mSeekReady.load(std::memory_order_acquire) != request) {
+      return false;
+    }
+    for (auto &stream : mStreams) {
+      stream->active.store(1 - stream->active.load(std::memory_order_relaxed),
+                           std::memory_order_release);
+    }
+    mSeekApplied = request;
+    return true;
+  }
+
+  // Audio thread. True between requestSeek() and the applySeek() that
+  // carries it out.
+  bool seekPending() const {
+    return mSeekRequest.load(std::memory_order_relaxed) != mSeekApplied;
+  }
+
+  // Frame of the last requested seek
+  int64_t seekTarget() const {
+    return mSeekTarget.load(std::memory_order_relaxed);
+  }
+
+  // Frame position of the next frame returned by read()
+  int64_t position(int index) const {
+    const Stream &stream = *mStreams[index];
+    const Ring &ring =
+        stream.rings[stream.active.load(std::memory_order_acquire)];
+    int64_t position = ring.startFrame.load(std::memory_order_relaxed) +
+                       int64_t(ring.readCount.load(std::memory_order_relaxed));
+    if (stream.loop && stream.info.frames > 0) {
+      position %= stream.info.frames;
+    }
+    return position;
+  }
+
+  // Number of reads that came up short before the end of the file
+  uint64_t underruns(int stream) const {
+    return mStreams[stream]->underruns.load(std::memory_order_relaxed);
+  }
+
+  uint64_t totalUnderruns() const {
+    uint64_t total = 0;
+    for (auto &stream : mStreams) {
+      total += stream->underruns.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+private:
+  static const int64_t minChunkFrames = 1024;
+  static const int64_t readChunkBytes = 1 << 18; // 256 KiB per disk read
+
+  struct Ring {
+    std::vector<float> data; // Interleaved frames
+
+    // Frames written and read since the ring was reset, owned by the I/O
+    // thread and the audio thread respectively
+    std::atomic<uint64_t> writeCount{0};
+    std::atomic<uint64_t> readCount{0};
+    // writeCount at the end of a non-looping file
+    std::atomic<uint64_t> endCount{UINT64_MAX};
+    // File frame at count 0
+    std::atomic<int64_t> startFrame{0};
+    int64_t filePosition{0}; // I/O thread: file frame of the next write
+  };
+
+  // Each stream has two rings. The audio thread reads the active one. A seek
+  // resets the other one, the standby ring, and the I/O thread fills it from
+  // the new position while the active ring keeps playing. applySeek() then
+  // swaps them for all streams in the same block.
+  struct Stream {
+    SNDFILE *file{nullptr};
+    SF_INFO info{};
+    bool loop{false};
+
+    Ring rings[2];
+    int64_t capacity{0}; // Frames per ring
+    int64_t chunkFrames{0};
+
+    std::atomic<int> active{0}; // Switched by the audio thread
+    int standby{-1};            // I/O thread: ring being pre-rolled, or -1
+    int64_t filePosition{0};    // I/O thread: where the file is
+
+    std::atomic<uint64_t> underruns{0};
+  };
+
+  // Reads one chunk into the ring if there is room for it. Returns false when
+  // there is nothing to do for this ring.
+  bool fillChunk(Stream &stream, Ring &ring) {
+    uint64_t writeCount = ring.writeCount.load(std::memory_order_relaxed);
+    if (ring.endCount.load(std::memory_order_relaxed) != UINT64_MAX) {
+      return false;
+    }
+    uint64_t used = writeCount - ring.readCount.load(std::memory_order_acquire);
+    int64_t space = stream.capacity - int64_t(used);
+    // Read up to the next chunk boundary of the file, so reads stay aligned
+    int64_t frames = stream.chunkFrames - ring.filePosition % stream.chunkFrames;
+    if (space < frames) {
+      return false;
+    }
+
+    // During a pre-roll the two rings take turns reading the file
+    if (stream.filePosition != ring.filePosition) {
+      sf_seek(stream.file, ring.filePosition, SEEK_SET);
+      stream.filePosition = ring.filePosition;
+    }
+    int channels = stream.info.channels;
+    int64_t framesRead =
+        sf_readf_float(stream.file, mReadBuffer.data(), frames);
+    ring.filePosition += framesRead;
+    stream.filePosition += framesRead;
+    if (framesRead < frames) {
+      if (stream.loop && stream.info.frames > 0) {
+        sf_seek(stream.file, 0, SEEK_SET);
+        ring.filePosition = 0; // Next read starts a new chunk
+        stream.filePosition = 0;
+      } else {
+        ring.endCount.store(writeCount + framesRead, std::memory_order_release);
+      }
+    }
+
+    int64_t start = int64_t(writeCount % stream.capacity);
+    int64_t firstPart = std::min<int64_t>(framesRead, stream.capacity - start);
+    std::copy_n(mReadBuffer.data(), firstPart * channels,
+                ring.data.data() + start * channels);
+    std::copy_n(mReadBuffer.data() + firstPart * channels,
+                (framesRead - firstPart) * channels, ring.data.data());
+    ring.writeCount.store(writeCount + framesRead, std::memory_order_release);
+    return framesRead > 0;
+  }
+
+  // I/O thread. Resets the standby ring of every stream to start at the seek
+  // target. The audio thread never reads a standby ring, and it only
+  // switches rings for the latest request, so the reset is safe.
+  void prepareSeek() {
+    int64_t target = mSeekTarget.load(std::memory_order_relaxed);
+    for (auto &stream : mStreams) {
+      int64_t frame = std::max<int64_t>(0, target);
+      if (stream->loop && stream->info.frames > 0) {
+        frame %= stream->info.frames;
+      } else {
+        frame = std::min<int64_t>(frame, stream->info.frames);
+      }
+      stream->standby = 1 - stream->active.load(std::memory_order_acquire);
+      Ring &ring = stream->rings[stream->standby];
+      ring.writeCount.store(0, std::memory_order_relaxed);
+      ring.readCount.store(0, std::memory_order_relaxed);
+      ring.endCount.store(UINT64_MAX, std::memory_order_relaxed);
+      ring.startFrame.store(frame, std::memory_order_relaxed);
+      ring.filePosition = frame;
+    }
+  }
+
+  // I/O thread. True when every standby ring holds a quarter of its capacity
+  // or the whole rest of its file.
+  bool prerolled() const {
+    for (auto &stream : mStreams) {
+      const Ring &ring = stream->rings[stream->standby];
+      if (ring.endCount.load(std::memory_order_relaxed) == UINT64_MAX &&
+          int64_t(ring.writeCount.load(std::memory_order_relaxed)) <
+              stream->capacity / 4) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void ioThreadFunction() {
+    uint64_t seekPrepared = 0;
+    bool prerolling = false;
+    while (true) {
+      uint64_t request = mSeekRequest.load(std::memory_order_acquire);
+      if (request != seekPrepared) {
+        prepareSeek();
+        seekPrepared = request;
+        prerolling = true;
+      }
+      if (prerolling && prerolled()) {
+        mSeekReady.store(request, std::memory_order_release);
+        prerolling = false;
+      }
+      // Serve the emptiest ring first, of the active rings and, until the
+      // audio thread switches to them, the standby rings. A standby ring
+      // counts as a quarter fuller than it is: a seek is pre-rolled ahead of
+      // topping up the active rings, but not while one of them is close to
+      // running dry, which would be heard.
+      Stream *emptiest = nullptr;
+      Ring *emptiestRing = nullptr;
+      double lowestFill = 2.0;
+      for (auto &stream : mStreams) {
+        int active = stream->active.load(std::memory_order_acquire);
+        if (stream->standby == active) {
+          stream->standby = -1; // Switched to
+        }
+        for (int r : {active, stream->standby}) {
+          if (r < 0) {
+            continue;
+          }
+          Ring &ring = stream->rings[r];
+          uint64_t used = ring.writeCount.load(std::memory_order_relaxed) -
+                          ring.readCount.load(std::memory_order_acquire);
+          double fill = double(used) / stream->capacity +
+                        (r == stream->standby ? 0.25 : 0.0);
+          if (fill < lowestFill &&
+              ring.endCount.load(std::memory_order_relaxed) == UINT64_MAX &&
+              stream->capacity - int64_t(used) >= stream->chunkFrames) {
+            lowestFill = fill;
+            emptiest = stream.get();
+            emptiestRing = &ring;
+          }
+        }
+      }
+      if (emptiest && fillChunk(*emptiest, *emptiestRing)) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lk(mLock);
+      if (!mRunning) {
+        return;
+      }
+      mCondition.wait_for(lk, std::chrono::milliseconds(5));
+      if (!mRunning) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Stream>> mStreams;
+  double mPrefetchSeconds{2.0};
+  std::vector<float> mReadBuffer; // I/O thread
+
+  // Seek handshake: requests are counted by the audio thread, the I/O
+  // thread publishes the last one it has pre-rolled
+  std::atomic<uint64_t> mSeekRequest{0};
+  std::atomic<int64_t> mSeekTarget{0};
+  std::atomic<uint64_t> mSeekReady{0};
+  uint64_t mSeekApplied{0}; // Audio thread
+
+  bool mRunning{false};
+  std::thread mThread;
+  std::mutex mLock;
+  std::condition_variable mCondition;
+};
+
+#endif // DiskStreamer_H
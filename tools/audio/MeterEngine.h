@@ -0,0 +1,550 @@
+#pragma once
+#ifndef MeterEngine_H
+#define MeterEngine_H
+
+// Peak, RMS, true peak and short-term loudness of up to 64 output channels,
+// measured on a separate thread.
+//
+// The sphere tools used to find each channel's peak with a scalar loop in
+// the audio callback. Each extra measurement would have added to the
+// callback. Here the audio thread only copies its output blocks into a
+// lock-free ring in write(). That copy costs the same whatever is measured,
+// and it never locks or allocates. A meter thread reads the ring and
+// measures:
+//  - peak: the largest absolute sample over the last update period,
+//  - RMS: over the last 300 ms,
+//  - true peak: the peak after 4x oversampling with the 48 tap
+//    interpolator of ITU-R BS.1770,
+//  - short-term loudness: K-weighted mean square over the last 3 s, per
+//    channel and for all channels together (every channel weighted 1).
+// Peak, RMS and true peak use SSE/AVX or NEON reductions. The K-weighting
+// filters are recursive, so they run one sample at a time.
+//
+// Every 1 / updateRate seconds the thread publishes a MeterValues through a
+// triple buffer. values() returns the latest one without waiting. If the
+// meter thread falls behind, the frames that don't fit in the ring are
+// dropped and counted in overruns().
+//
+// MeterValues is a plain struct, so it can go in a distributed app's shared
+// state as is.
+//
+// Usage:
+//   MeterEngine meters;
+//   meters.start(60, 48000);                // Before audio starts
+//   ...
+//   meters.write(io);                       // In onSound()
+//   ...
+//   state().meterValues = meters.values();  // In onAnimate()
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define METER_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define METER_NEON
+#endif
+
+struct MeterValues {
+  static const int maxChannels = 64;
+
+  int numChannels{0};
+  // Meter sizes as drawn by the sphere meters: 0.01 below -60 dBFS peak,
+  // up to 0.31 at 0 dBFS, falling back slowly
+  float display[maxChannels]{0};
+  float peak[maxChannels]{0};          // dBFS
+  float rms[maxChannels]{0};           // dBFS
+  float truePeak[maxChannels]{0};      // dBTP
+  float shortTermLufs[maxChannels]{0}; // LUFS
+  float shortTermLufsTotal{0};         // LUFS, all channels
+};
+
+namespace meter {
+
+// Largest |x[i]|
+inline float absMax(const float *x, int n) {
+  int i = 0;
+  float result = 0.0f;
+#if defined(__AVX__)
+  const __m256 mask8 = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 max8 = _mm256_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    max8 = _mm256_max_ps(max8, _mm256_and_ps(_mm256_loadu_ps(x + i), mask8));
+  }
+  __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(max8),
+                           _mm256_extractf128_ps(max8, 1));
+#elif defined(METER_SSE2)
+  const __m128 mask4 = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 max4 = _mm_setzero_ps();
+  for (; i + 4 <= n; i += 4) {
+    max4 = _mm_max_ps(max4, _mm_and_ps(_mm_loadu_ps(x + i), mask4));
+  }
+#elif defined(METER_NEON)
+  float32x4_t max4 = vdupq_n_f32(0.0f);
+  for (; i + 4 <= n; i += 4) {
+    max4 = vmaxq_f32(max4, vabsq_f32(vld1q_f32(x + i)));
+  }
+  result = vmaxvq_f32(max4);
+#endif
+#if defined(METER_SSE2)
+  max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+  max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 1));
+  result = _mm_cvtss_f32(max4);
+#endif
+  for (; i < n; i++) {
+    result = std::max(result, std::fabs(x[i]));
+  }
+  return result;
+}
+
+// Sum of x[i]^2. Summed in float per lane, which is plenty for one update
+// period.
+inline float sumSquares(const float *x, int n) {
+  int i = 0;
+  float result = 0.0f;
+#if defined(__AVX__)
+  __m256 sum8 = _mm256_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_loadu_ps(x + i);
+    sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(v, v));
+  }
+  __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8),
+                           _mm256_extractf128_ps(sum8, 1));
+#elif defined(METER_SSE2)
+  __m128 sum4 = _mm_setzero_ps();
+  for (; i + 4 <= n; i += 4) {
+    __m128 v = _mm_loadu_ps(x + i);
+    sum4 = _mm_add_ps(sum4, _mm_mul_ps(v, v));
+  }
+#elif defined(METER_NEON)
+  float32x4_t sum4 = vdupq_n_f32(0.0f);
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t v = vld1q_f32(x + i);
+    sum4 = vmlaq_f32(sum4, v, v);
+  }
+  result = vaddvq_f32(sum4);
+#endif
+#if defined(METER_SSE2)
+  sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+  sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+  result = _mm_cvtss_f32(sum4);
+#endif
+  for (; i < n; i++) {
+    result += x[i] * x[i];
+  }
+  return result;
+}
+
+// Largest |sum over k of h[k] * x[i - k]| for i in [0, n). x must be
+// preceded by taps - 1 samples of history.
+inline float firAbsMax(const float *x, int n, const float *h, int taps) {
+  int i = 0;
+  float result = 0.0f;
+#if defined(__AVX__)
+  const __m256 mask8 = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 max8 = _mm256_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    __m256 acc = _mm256_setzero_ps();
+    for (int k = 0; k < taps; k++) {
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(h[k]),
+                                             _mm256_loadu_ps(x + i - k)));
+    }
+    max8 = _mm256_max_ps(max8, _mm256_and_ps(acc, mask8));
+  }
+  __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(max8),
+                           _mm256_extractf128_ps(max8, 1));
+#elif defined(METER_SSE2)
+  const __m128 mask4 = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 max4 = _mm_setzero_ps();
+  for (; i + 4 <= n; i += 4) {
+    __m128 acc = _mm_setzero_ps();
+    for (int k = 0; k < taps; k++) {
+      acc = _mm_add_ps(acc,
+                       _mm_mul_ps(_mm_set1_ps(h[k]), _mm_loadu_ps(x + i - k)));
+    }
+    max4 = _mm_max_ps(max4, _mm_and_ps(acc, mask4));
+  }
+#elif defined(METER_NEON)
+  float32x4_t max4 = vdupq_n_f32(0.0f);
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (int k = 0; k < taps; k++) {
+      acc = vmlaq_n_f32(acc, vld1q_f32(x + i - k), h[k]);
+    }
+    max4 = vmaxq_f32(max4, vabsq_f32(acc));
+  }
+  result = vmaxvq_f32(max4);
+#endif
+#if defined(METER_SSE2)
+  max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+  max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 1));
+  result = _mm_cvtss_f32(max4);
+#endif
+  for (; i < n; i++) {
+    float acc = 0.0f;
+    for (int k = 0; k < taps; k++) {
+      acc += h[k] * x[i - k];
+    }
+    result = std::max(result, std::fabs(acc));
+  }
+  return result;
+}
+
+// Direct form I biquad, a0 = 1
+struct Biquad {
+  float b0{1}, b1{0}, b2{0}, a1{0}, a2{0};
+  float x1{0}, x2{0}, y1{0}, y2{0};
+
+  float operator()(float x) {
+    float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    return y;
+  }
+};
+
+// The 4x interpolator of ITU-R BS.1770-4, Annex 2: 4 phases of 12 taps
+inline const float (*truePeakPhases())[12] {
+  static const float phases[4][12] = {
+      {0.0017089843750f, 0.0109863281250f, -0.0196533203125f,
+       0.0332031250000f, -0.0594482421875f, 0.1373291015625f,
+       0.9721679687500f, -0.1022949218750f, 0.0476074218750f,
+       -0.0266113281250f, 0.0148925781250f, -0.0083007812500f},
+      {-0.0291748046875f, 0.0292968750000f, -0.0517578125000f,
+       0.0891113281250f, -0.1665039062500f, 0.4650878906250f,
+       0.7797851562500f, -0.2003173828125f, 0.1015625000000f,
+       -0.0582275390625f, 0.0330810546875f, -0.0189208984375f},
+      {-0.0189208984375f, 0.0330810546875f, -0.0582275390625f,
+       0.1015625000000f, -0.2003173828125f, 0.7797851562500f,
+       0.4650878906250f, -0.1665039062500f, 0.0891113281250f,
+       -0.0517578125000f, 0.0292968750000f, -0.0291748046875f},
+      {-0.0083007812500f, 0.0148925781250f, -0.0266113281250f,
+       0.0476074218750f, -0.1022949218750f, 0.9721679687500f,
+       0.1373291015625f, -0.0594482421875f, 0.0332031250000f,
+       -0.0196533203125f, 0.0109863281250f, 0.0017089843750f}};
+  return phases;
+}
+
+inline float toDecibels(double power) {
+  return power > 1e-12 ? float(10.0 * std::log10(power)) : -120.0f;
+}
+
+} // namespace meter
+
+class MeterEngine {
+public:
+  static const int updateRate = 50;         // Hz
+  static const int rmsUpdates = 15;         // 300 ms
+  static const int shortTermUpdates = 150;  // 3 s
+  static const int ringFrames = 1 << 14;    // Power of 2
+  static const int oversampling = 4;
+  static const int tapsPerPhase = 12;
+
+  ~MeterEngine() { stop(); }
+
+  // Allocates the buffers and starts the meter thread. numChannels is
+  // limited to MeterValues::maxChannels. Without the thread, the caller
+  // measures by calling process().
+  void start(int numChannels, double sampleRate, bool startThread = true) {
+    if (mRunning) {
+      return;
+    }
+    mNumChannels = std::min(std::max(numChannels, 1), +MeterValues::maxChannels);
+    mUpdateFrames = std::max(1, int(sampleRate / updateRate));
+    // Same fall back as the old meters, 5% per 512 frame block
+    mRelease = float(1.0 - std::pow(0.95, mUpdateFrames / 512.0));
+    mRing.assign(size_t(mNumChannels) * ringFrames, 0.0f);
+    mChannels.assign(mNumChannels, Channel());
+    for (auto &channel : mChannels) {
+      channel.history.assign(tapsPerPhase - 1, 0.0f);
+      channel.squares.assign(shortTermUpdates, 0.0f);
+      channel.weightedSquares.assign(shortTermUpdates, 0.0f);
+      kWeighting(sampleRate, channel.shelf, channel.highPass);
+    }
+    mScratch.assign(tapsPerPhase - 1 + chunkFrames, 0.0f);
+    mWeighted.assign(chunkFrames, 0.0f);
+    for (auto &values : mValues) {
+      values = MeterValues();
+      values.numChannels = mNumChannels;
+    }
+    mWriteCount = 0;
+    mReadCount = 0;
+    if (startThread) {
+      mRunning = true;
+      mThread = std::thread([this]() { meterThreadFunction(); });
+    }
+  }
+
+  void stop() {
+    if (!mRunning) {
+      return;
+    }
+    {
+      std::unique_lock<std::mutex> lk(mLock);
+      mRunning = false;
+    }
+    mCondition.notify_one();
+    mThread.join();
+  }
+
+  // Audio thread. Queues frames of each of numChannels planar buffers.
+  // Channels past numChannels() are ignored, and so is everything before
+  // start().
+  void write(const float *const *buffers, int numChannels, int frames) {
+    if (mNumChannels == 0) {
+      return;
+    }
+    uint64_t writeCount = mWriteCount.load(std::memory_order_relaxed);
+    uint64_t space =
+        ringFrames - (writeCount - mReadCount.load(std::memory_order_acquire));
+    if (uint64_t(frames) > space) {
+      mOverruns.fetch_add(frames - space, std::memory_order_relaxed);
+      frames = int(space);
+    }
+    int start = int(writeCount & (ringFrames - 1));
+    int first = std::min(frames, ringFrames - start);
+    numChannels = std::min(numChannels, mNumChannels);
+    for (int c = 0; c < mNumChannels; c++) {
+      float *ring = &mRing[size_t(c) * ringFrames];
+      if (c < numChannels) {
+        std::memcpy(ring + start, buffers[c], first * sizeof(float));
+        std::memcpy(ring, buffers[c] + first, (frames - first) * sizeof(float));
+      } else {
+        std::memset(ring + start, 0, first * sizeof(float));
+        std::memset(ring, 0, (frames - first) * sizeof(float));
+      }
+    }
+    mWriteCount.store(writeCount + frames, std::memory_order_release);
+  }
+
+  // Audio thread. Queues the output buffers of an al::AudioIOData.
+  template <class IO> void write(IO &io) {
+    const float *buffers[MeterValues::maxChannels];
+    int numChannels = std::min(int(io.channelsOut()), mNumChannels);
+    for (int c = 0; c < numChannels; c++) {
+      buffers[c] = io.outBuffer(c);
+    }
+    write(buffers, numChannels, int(io.framesPerBuffer()));
+  }
+
+  // The latest values. The reference stays valid until the next call, from
+  // the same thread.
+  const MeterValues &values() {
+    if (mMiddle.load(std::memory_order_relaxed) & newFlag) {
+      mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & ~newFlag;
+    }
+    return mValues[mFront];
+  }
+
+  int numChannels() const { return mNumChannels; }
+
+  // Frames dropped because the meter thread fell behind
+  uint64_t overruns() const {
+    return mOverruns.load(std::memory_order_relaxed);
+  }
+
+  // Meter thread. Measures the queued frames, returns how many. Only call it
+  // directly if start() didn't start the thread.
+  size_t process() {
+    uint64_t readCount = mReadCount.load(std::memory_order_relaxed);
+    uint64_t writeCount = mWriteCount.load(std::memory_order_acquire);
+    uint64_t count = readCount;
+    while (count < writeCount) {
+      // Up to the next update, the end of the ring or chunkFrames
+      int start = int(count & (ringFrames - 1));
+      int frames = int(std::min<uint64_t>(writeCount - count,
+                                          uint64_t(ringFrames - start)));
+      frames = std::min(std::min(frames, int(chunkFrames)),
+                        mUpdateFrames - mUpdateCount);
+      for (int c = 0; c < mNumChannels; c++) {
+        measure(mChannels[c], &mRing[size_t(c) * ringFrames + start], frames);
+      }
+      // Lets the audio thread reuse the space right away
+      count += frames;
+      mReadCount.store(count, std::memory_order_release);
+      mUpdateCount += frames;
+      if (mUpdateCount == mUpdateFrames) {
+        publish();
+        mUpdateCount = 0;
+      }
+    }
+    return size_t(writeCount - readCount);
+  }
+
+private:
+  static const int chunkFrames = 256;
+  static const int newFlag = 4;
+
+  struct Channel {
+    std::vector<float> history; // Last tapsPerPhase - 1 input samples
+    meter::Biquad shelf, highPass;
+    // Over the current update
+    float peak{0}, truePeak{0};
+    double sumSquares{0}, sumWeightedSquares{0};
+    // Sums of the last shortTermUpdates updates, oldest at mUpdateIndex
+    std::vector<float> squares, weightedSquares;
+    float display{0.01f};
+  };
+
+  // ITU-R BS.1770 K-weighting, pre-filter shelf and RLB high pass, designed
+  // for any sample rate
+  static void kWeighting(double sr, meter::Biquad &shelf,
+                         meter::Biquad &highPass) {
+    double f0 = 1681.974450955533, gain = 3.999843853973347,
+           q = 0.7071752369554196;
+    double k = std::tan(M_PI * f0 / sr);
+    double vh = std::pow(10.0, gain / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf.b0 = float((vh + vb * k / q + k * k) / a0);
+    shelf.b1 = float(2.0 * (k * k - vh) / a0);
+    shelf.b2 = float((vh - vb * k / q + k * k) / a0);
+    shelf.a1 = float(2.0 * (k * k - 1.0) / a0);
+    shelf.a2 = float((1.0 - k / q + k * k) / a0);
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(M_PI * f0 / sr);
+    a0 = 1.0 + k / q + k * k;
+    highPass.b0 = 1.0f;
+    highPass.b1 = -2.0f;
+    highPass.b2 = 1.0f;
+    highPass.a1 = float(2.0 * (k * k - 1.0) / a0);
+    highPass.a2 = float((1.0 - k / q + k * k) / a0);
+  }
+
+  void measure(Channel &channel, const float *x, int n) {
+    channel.peak = std::max(channel.peak, meter::absMax(x, n));
+    channel.sumSquares += meter::sumSquares(x, n);
+
+    // Oversampled peak. The history goes in front of the samples so the
+    // filters can run over the whole chunk.
+    const int history = tapsPerPhase - 1;
+    std::copy(channel.history.begin(), channel.history.end(),
+              mScratch.begin());
+    std::copy(x, x + n, mScratch.begin() + history);
+    for (int p = 0; p < oversampling; p++) {
+      channel.truePeak =
+          std::max(channel.truePeak,
+                   meter::firAbsMax(mScratch.data() + history, n,
+                                    meter::truePeakPhases()[p],
+                                    tapsPerPhase));
+    }
+    std::copy(mScratch.begin() + n, mScratch.begin() + n + history,
+              channel.history.begin());
+
+    for (int i = 0; i < n; i++) {
+      mWeighted[i] = channel.highPass(channel.shelf(x[i]));
+    }
+    channel.sumWeightedSquares += meter::sumSquares(mWeighted.data(), n);
+  }
+
+  void publish() {
+    MeterValues &values = mValues[mBack];
+    values.numChannels = mNumChannels;
+    double totalPower = 0.0;
+    for (int c = 0; c < mNumChannels; c++) {
+      Channel &channel = mChannels[c];
+      channel.squares[mUpdateIndex] = float(channel.sumSquares);
+      channel.weightedSquares[mUpdateIndex] = float(channel.sumWeightedSquares);
+      double squares = 0.0, weightedSquares = 0.0;
+      for (int u = 0; u < shortTermUpdates; u++) {
+        weightedSquares += channel.weightedSquares[u];
+      }
+      for (int u = 0; u < rmsUpdates; u++) {
+        squares += channel.squares[(mUpdateIndex + shortTermUpdates - u) %
+                                   shortTermUpdates];
+      }
+      double power = weightedSquares / (double(mUpdateFrames) * shortTermUpdates);
+      totalPower += power;
+
+      values.peak[c] = meter::toDecibels(channel.peak * channel.peak);
+      values.truePeak[c] =
+          meter::toDecibels(channel.truePeak * channel.truePeak);
+      values.rms[c] =
+          meter::toDecibels(squares / (double(mUpdateFrames) * rmsUpdates));
+      values.shortTermLufs[c] = -0.691f + meter::toDecibels(power);
+
+      float size = values.peak[c] < -60.0f
+                       ? 0.01f
+                       : 0.01f + 0.005f * (60.0f + values.peak[c]);
+      if (channel.display > size) {
+        channel.display -= mRelease * (channel.display - size);
+      } else {
+        channel.display = size;
+      }
+      values.display[c] = channel.display;
+
+      channel.peak = channel.truePeak = 0.0f;
+      channel.sumSquares = channel.sumWeightedSquares = 0.0;
+    }
+    values.shortTermLufsTotal = -0.691f + meter::toDecibels(totalPower);
+    mUpdateIndex = (mUpdateIndex + 1) % shortTermUpdates;
+    mBack = mMiddle.exchange(mBack | newFlag, std::memory_order_acq_rel) &
+            ~newFlag;
+  }
+
+  void meterThreadFunction() {
+    while (true) {
+      if (process() > 0) {
+        continue;
+      }
+      // The audio thread doesn't notify, so poll
+      std::unique_lock<std::mutex> lk(mLock);
+      if (!mRunning) {
+        return;
+      }
+      mCondition.wait_for(lk, std::chrono::milliseconds(5));
+      if (!mRunning) {
+        return;
+      }
+    }
+  }
+
+  int mNumChannels{0};
+  int mUpdateFrames{960};
+  float mRelease{0.1f};
+
+  // Planar ring, ringFrames per channel
+  std::vector<float> mRing;
+  std::atomic<uint64_t> mWriteCount{0};
+  std::atomic<uint64_t> mReadCount{0};
+  std::atomic<uint64_t> mOverruns{0};
+
+  // Meter thread
+  std::vector<Channel> mChannels;
+  std::vector<float> mScratch, mWeighted;
+  int mUpdateCount{0};
+  int mUpdateIndex{0};
+
+  // Published values. mBack is owned by the meter thread, mFront by the
+  // reader, and mMiddle holds the latest values, or'ed with newFlag until
+  // the reader takes them.
+  MeterValues mValues[3];
+  int mBack{0};
+  std::atomic<int> mMiddle{1};
+  int mFront{2};
+
+  bool mRunning{false};
+  std::thread mThread;
+  std::mutex mLock;
+  std::condition_variable mCondition;
+};
+
+#endif // MeterEngine_H
@@ -0,0 +1,143 @@
+#pragma once
+#ifndef PoseAutomation_H
+#define PoseAutomation_H
+
+// Plays the pose lines of an automation .sequence file in audio time.
+//
+// spatial_sequencer reads the file of each AudioObject when its
+// automationFile is set, and calls step() once per audio block. Triggering
+// only calls restart(), so no file is read on trigger, and the movement
+// lands on the same samples however fast the audio is rendered.
+//
+// Lines look like "+delta:/_pose:x,y,z:morph" or, with an orientation,
+// "+delta:/_pose:x,y,z,qw,qx,qy,qz:morph". Each line starts after delta
+// seconds and moves from the current pose to the new one over morph
+// seconds. A line that starts before the previous morph has finished takes
+// over from wherever that morph had got to. Other lines are ignored.
+//
+// Usage:
+//   PoseAutomation automation;
+//   automation.load("seq.sequence");
+//   automation.restart(startPose);
+//   // Each block:
+//   Pose pose = automation.step(io.framesPerBuffer() / io.framesPerSecond());
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "al/spatial/al_Pose.hpp"
+
+class PoseAutomation {
+public:
+  // Returns false if the file can't be read
+  bool load(const std::string &path) {
+    mKeys.clear();
+    std::ifstream f(path);
+    if (!f.is_open()) {
+      std::cerr << "ERROR: PoseAutomation: can't open " << path << std::endl;
+      return false;
+    }
+    std::string line;
+    double time = 0.0;
+    while (std::getline(f, line)) {
+      if (line.size() < 2 || line[0] != '+') {
+        continue;
+      }
+      std::vector<std::string> fields = split(line.substr(1), ':');
+      if (fields.size() < 3) {
+        continue;
+      }
+      time += std::atof(fields[0].c_str());
+      if (fields[1] != "/_pose") {
+        continue;
+      }
+      std::vector<std::string> values = split(fields[2], ',');
+      Keyframe key;
+      key.time = time;
+      key.morphTime = fields.size() > 3 ? std::atof(fields[3].c_str()) : 0.0;
+      if (values.size() >= 3) {
+        key.pose.pos(std::atof(values[0].c_str()), std::atof(values[1].c_str()),
+                     std::atof(values[2].c_str()));
+      }
+      if (values.size() >= 7) {
+        key.pose.quat(al::Quatd(
+            std::atof(values[3].c_str()), std::atof(values[4].c_str()),
+            std::atof(values[5].c_str()), std::atof(values[6].c_str())));
+        key.hasQuat = true;
+      }
+      if (values.size() >= 3) {
+        mKeys.push_back(key);
+      }
+    }
+    return true;
+  }
+
+  // Goes back to time 0, holding pose until the first line
+  void restart(const al::Pose &pose) {
+    mTime = 0.0;
+    mNext = 0;
+    mFrom = mTo = pose;
+    mMorphStart = 0.0;
+    mMorphTime = 0.0;
+  }
+
+  // Returns the pose at the current time, then moves on by seconds
+  al::Pose step(double seconds) {
+    while (mNext < mKeys.size() && mKeys[mNext].time <= mTime) {
+      const Keyframe &key = mKeys[mNext];
+      mFrom = poseAt(key.time);
+      mTo = key.pose;
+      if (!key.hasQuat) {
+        mTo.quat(mFrom.quat());
+      }
+      mMorphStart = key.time;
+      mMorphTime = key.morphTime;
+      mNext++;
+    }
+    al::Pose pose = poseAt(mTime);
+    mTime += seconds;
+    return pose;
+  }
+
+  bool empty() const { return mKeys.empty(); }
+
+private:
+  struct Keyframe {
+    double time{0};
+    al::Pose pose;
+    bool hasQuat{false};
+    double morphTime{0};
+  };
+
+  static std::vector<std::string> split(const std::string &s, char delimiter) {
+    std::vector<std::string> parts;
+    std::istringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, delimiter)) {
+      parts.push_back(part);
+    }
+    return parts;
+  }
+
+  // Pose along the current morph
+  al::Pose poseAt(double time) const {
+    double amount = mMorphTime > 0.0 ? (time - mMorphStart) / mMorphTime : 1.0;
+    amount = std::min(std::max(amount, 0.0), 1.0);
+    return al::Pose(mFrom.pos() + (mTo.pos() - mFrom.pos()) * amount,
+                    al::Quatd::slerp(mFrom.quat(), mTo.quat(), amount));
+  }
+
+  std::vector<Keyframe> mKeys;
+  size_t mNext{0};
+  double mTime{0};
+  al::Pose mFrom, mTo;
+  double mMorphStart{0};
+  double mMorphTime{0};
+};
+
+#endif // PoseAutomation_H
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef SPSCQueue_H
+#define SPSCQueue_H
+
+// Fixed size lock-free queue for one producer thread and one consumer thread.
+//
+// push() and pop() never block, lock or allocate, so the audio thread can be
+// either end of the queue. Items are copied in and out, so T should be a
+// small trivially copyable struct.
+//
+// Usage:
+//   SPSCQueue<Command, 64> queue;
+//   queue.push(command);        // Producer, e.g. the GUI thread
+//   while (queue.pop(command)) { // Consumer, e.g. at the top of onSound()
+//     ...
+//   }
+
+#include <atomic>
+#include <cstddef>
+
+template <class T, size_t Capacity> class SPSCQueue {
+public:
+  // Producer thread. Returns false if the queue is full.
+  bool push(const T &item) {
+    size_t writeCount = mWriteCount.load(std::memory_order_relaxed);
+    if (writeCount - mReadCount.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    mItems[writeCount % Capacity] = item;
+    mWriteCount.store(writeCount + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread. Returns false if the queue is empty.
+  bool pop(T &item) {
+    size_t readCount = mReadCount.load(std::memory_order_relaxed);
+    if (readCount == mWriteCount.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = mItems[readCount % Capacity];
+    mReadCount.store(readCount + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  T mItems[Capacity];
+  // Items pushed and popped since the start, owned by the producer and the
+  // consumer respectively
+  std::atomic<size_t> mWriteCount{0};
+  std::atomic<size_t> mReadCount{0};
+};
+
+#endif // SPSCQueue_H
@@ -0,0 +1,127 @@
+#pragma once
+#ifndef SoundFileCache_H
+#define SoundFileCache_H
+
+// Keeps short sound files fully decoded in memory, shared by all voices.
+//
+// load() decodes a file once to interleaved floats if its decoded size is
+// below maxBytesPerFile(). Voices then look clips up with find() and play
+// them through a Cursor, which hands out pointers straight into the shared
+// frames. Neither find() nor reading a cursor does any I/O, locking or
+// allocation, so both are safe on the audio thread. Files that are too large
+// are not cached and should be streamed from disk instead.
+//
+// All loading must be done before audio starts. After that the cache is only
+// read, from any number of threads.
+//
+// Usage:
+//   SoundFileCache cache;
+//   cache.load("clips/hit.wav");   // Before audio starts
+//   ...
+//   SoundFileCache::Cursor cursor; // In the voice
+//   cursor.start(cache.find("clips/hit.wav"));
+//   const float *frames;
+//   int n = cursor.read(frames, io.framesPerBuffer()); // n interleaved frames
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sndfile.h>
+
+class SoundFileCache {
+public:
+  struct Clip {
+    std::vector<float> frames; // Interleaved
+    int channels{0};
+    double frameRate{0};
+    int64_t numFrames{0};
+  };
+
+  // Read position in a clip. Keeps the clip alive while it plays.
+  class Cursor {
+  public:
+    // Starts playing clip from the first frame. clip can be nullptr.
+    void start(std::shared_ptr<const Clip> clip) {
+      mClip = std::move(clip);
+      mPosition = 0;
+    }
+
+    // Lets go of the clip. The cache still holds it, so this never frees
+    // memory on the audio thread.
+    void stop() { mClip.reset(); }
+
+    bool playing() const { return mClip && mPosition < mClip->numFrames; }
+    const Clip *clip() const { return mClip.get(); }
+    int64_t position() const { return mPosition; }
+
+    // Points frames at the next interleaved frames of the clip and returns
+    // how many there are, at most maxFrames. Returns 0 at the end.
+    int read(const float *&frames, int maxFrames) {
+      if (!mClip) {
+        return 0;
+      }
+      int n = int(std::min<int64_t>(maxFrames, mClip->numFrames - mPosition));
+      frames = mClip->frames.data() + mPosition * mClip->channels;
+      mPosition += n;
+      return n;
+    }
+
+  private:
+    std::shared_ptr<const Clip> mClip;
+    int64_t mPosition{0};
+  };
+
+  // Files that decode to more than this are not cached. Default 32 MB.
+  void maxBytesPerFile(size_t bytes) { mMaxBytesPerFile = bytes; }
+  size_t maxBytesPerFile() const { return mMaxBytesPerFile; }
+
+  // Decodes the file into the cache unless it is already there or too large.
+  // Returns true if the file is in the cache.
+  bool load(const std::string &path) {
+    if (mClips.find(path) != mClips.end()) {
+      return true;
+    }
+    SF_INFO info{};
+    SNDFILE *file = sf_open(path.c_str(), SFM_READ, &info);
+    if (!file) {
+      std::cerr << "ERROR: SoundFileCache: " << sf_strerror(nullptr)
+                << std::endl;
+      return false;
+    }
+    size_t bytes = size_t(info.frames) * info.channels * sizeof(float);
+    if (bytes > mMaxBytesPerFile) {
+      sf_close(file);
+      return false;
+    }
+    auto clip = std::make_shared<Clip>();
+    clip->channels = info.channels;
+    clip->frameRate = info.samplerate;
+    clip->frames.resize(size_t(info.frames) * info.channels);
+    clip->numFrames = sf_readf_float(file, clip->frames.data(), info.frames);
+    sf_close(file);
+    mBytes += bytes;
+    mClips[path] = clip;
+    return true;
+  }
+
+  // The clip for path, or nullptr if it is not cached
+  std::shared_ptr<const Clip> find(const std::string &path) const {
+    auto it = mClips.find(path);
+    return it != mClips.end() ? it->second : nullptr;
+  }
+
+  size_t numClips() const { return mClips.size(); }
+  size_t bytes() const { return mBytes; }
+
+private:
+  std::map<std::string, std::shared_ptr<const Clip>> mClips;
+  size_t mMaxBytesPerFile{32 << 20};
+  size_t mBytes{0};
+};
+
+#endif // SoundFileCache_H
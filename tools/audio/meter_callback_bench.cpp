@@ -0,0 +1,125 @@
+// Audio callback time of the sphere output meters
+//
+// Meters 60 channels of noise in real time, 512 frames per callback, and
+// times the metering part of the callback:
+//  - "peak": the scalar per-channel peak loop sphere_audio_test used to run,
+//  - "inline": MeterEngine without its thread, so peak, RMS, true peak and
+//    short-term loudness are all measured in the callback,
+//  - "thread": MeterEngine::write() only, with the meter thread measuring
+//    everything.
+// Reports mean and worst callback time, the mean as a share of the buffer
+// period, and the frames the meter thread had to drop.
+//
+// Usage (from the bin folder):
+//   meter_callback_bench [seconds]
+//
+//   seconds  audio metered per path (default: 10)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "al/io/al_AudioIOData.hpp"
+
+#include "MeterEngine.h"
+
+using namespace al;
+
+const int sampleRate = 48000;
+const int outChannels = 60;
+const int blockSize = 512;
+
+enum Path { PEAK, INLINE, THREAD };
+
+// The metering of the old Meter::processSound()
+void peakMeter(AudioIOData &io, std::vector<float> &values) {
+  for (int i = 0; i < int(io.channelsOut()); i++) {
+    float peak = 0.0f;
+    const float *outBuf = io.outBuffer(i);
+    for (int samp = 0; samp < int(io.framesPerBuffer()); samp++) {
+      peak = std::max(peak, std::fabs(outBuf[samp]));
+    }
+    float db = peak > 0 ? 20.0f * std::log10(peak) : -120.0f;
+    float size = db < -60 ? 0.01f : 0.01f + 0.005f * (60 + db);
+    if (values[i] > size) {
+      values[i] = values[i] - 0.05f * (values[i] - size);
+    } else {
+      values[i] = size;
+    }
+  }
+}
+
+void bench(Path path, const char *name, double seconds) {
+  MeterEngine meters;
+  if (path != PEAK) {
+    meters.start(outChannels, sampleRate, path == THREAD);
+  }
+  std::vector<float> values(outChannels, 0.01f);
+
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(outChannels);
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+  auto period = std::chrono::duration<double>(double(blockSize) / sampleRate);
+  long numBlocks = long(seconds * sampleRate / blockSize);
+  double total = 0, worst = 0;
+  auto deadline = std::chrono::steady_clock::now();
+  for (long block = 0; block < numBlocks; block++) {
+    for (int c = 0; c < outChannels; c++) {
+      float *out = io.outBuffer(c);
+      for (int i = 0; i < blockSize; i++) {
+        out[i] = noise(rng);
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (path == PEAK) {
+      peakMeter(io, values);
+    } else {
+      meters.write(io);
+      if (path == INLINE) {
+        meters.process();
+      }
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    total += elapsed;
+    worst = std::max(worst, elapsed);
+    // Pace the callbacks like an audio device would
+    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        period);
+    std::this_thread::sleep_until(deadline);
+  }
+  meters.stop();
+
+  double mean = total / numBlocks;
+  std::cout << std::setw(8) << name << std::setw(12) << mean << std::setw(12)
+            << worst << std::setw(10) << 100.0 * mean / (period.count() * 1e6)
+            << "%" << std::setw(11) << meters.overruns() << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 10.0;
+
+  std::cout << outChannels << " channels, " << blockSize
+            << " frames per callback. Times in microseconds per callback."
+            << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(8) << "path" << std::setw(12) << "mean"
+            << std::setw(12) << "worst" << std::setw(11) << "load"
+            << std::setw(11) << "dropped" << std::endl;
+  bench(PEAK, "peak", seconds);
+  bench(INLINE, "inline", seconds);
+  bench(THREAD, "thread", seconds);
+  return 0;
+}
@@ -8,17 +8,31 @@
 #include "al/sphere/al_SphereUtils.hpp"
 #include "al/ui/al_FileSelector.hpp"
 #include "al/ui/al_ParameterGUI.hpp"
-#include "al_ext/soundfile/al_SoundfileBuffered.hpp"
+
+#include "Deinterleave.h"
+#include "DiskStreamer.h"
+#include "SPSCQueue.h"
 
 using namespace al;
 
+// Sent from the GUI thread to the audio thread
+struct TransportCommand {
+  enum Type { PLAY, PAUSE, SEEK, SKIP };
+  Type type;
+  int64_t frames{0}; // Target frame for SEEK, offset for SKIP
+};
+
 struct MappedAudioFile {
-  std::unique_ptr<SoundFileBuffered> soundfile;
+  int stream{-1}; // Index into the DiskStreamer
   std::vector<size_t> outChannelMap;
   std::string fileInfoText;
   std::string fileName;
   float gain;
   bool mute{false};
+
+  // Allocated in onInit() for the audio thread
+  std::vector<float> scratch;   // Interleaved frames read from the stream
+  std::vector<float *> outputs; // Output buffer for each file channel
 };
 
 class AudioPlayerApp : public App {
@@ -31,33 +45,35 @@ public:
   Trigger fw{"fw"};
   Trigger back{"back"};
 
+  // All files are read from disk by a single I/O thread
+  DiskStreamer streamer;
+  // Transport changes are only carried out by the audio thread
+  SPSCQueue<TransportCommand, 64> transport;
+
   bool loadFile(std::string fileName, std::vector<size_t> channelMap,
                 float gain, bool loop) {
-    soundfiles.push_back(MappedAudioFile());
-    soundfiles.back().soundfile = std::make_unique<SoundFileBuffered>(
-        File::conformPathToOS(rootDir) + fileName, false, 4096);
-    soundfiles.back().soundfile->loop(loop);
-    if (!soundfiles.back().soundfile->opened()) {
+    int stream =
+        streamer.addStream(File::conformPathToOS(rootDir) + fileName, loop);
+    if (stream < 0) {
       std::cerr << "ERROR: opening "
                 << File::conformPathToOS(rootDir) + fileName << std::endl;
       return false;
     }
-    if (soundfiles.back().soundfile->channels() != channelMap.size()) {
+    soundfiles.push_back(MappedAudioFile());
+    soundfiles.back().stream = stream;
+    if (size_t(streamer.channels(stream)) != channelMap.size()) {
       std::cerr << "Channel mismatch for file " << fileName << ". File has "
-                << soundfiles.back().soundfile->channels() << " but "
-                << channelMap.size() << " provided. Aborting." << std::endl;
+                << streamer.channels(stream) << " but " << channelMap.size()
+                << " provided. Aborting." << std::endl;
     }
     soundfiles.back().outChannelMap = channelMap;
     soundfiles.back().gain = gain;
     soundfiles.back().fileName = fileName;
     soundfiles.back().fileInfoText +=
-        " channels: " +
-        std::to_string(soundfiles.back().soundfile->channels()) +
-        " sr: " + std::to_string(soundfiles.back().soundfile->frameRate()) +
-        "\n";
+        " channels: " + std::to_string(streamer.channels(stream)) +
+        " sr: " + std::to_string(streamer.frameRate(stream)) + "\n";
     soundfiles.back().fileInfoText +=
-        " length: " + std::to_string(soundfiles.back().soundfile->frames()) +
-        "\n";
+        " length: " + std::to_string(streamer.frames(stream)) + "\n";
     soundfiles.back().fileInfoText +=
         " gain: " + std::to_string(soundfiles.back().gain) + "\n";
     return true;
@@ -65,28 +81,26 @@ public:
 
   // App callbacks
   void onInit() override {
+    streamer.start();
+
+    play.registerChangeCallback([&](float value) {
+      sendTransport({value == 1.0f ? TransportCommand::PLAY
+                                   : TransportCommand::PAUSE});
+    });
+    // Seeking starts playback, stopped or not
     rewind.registerChangeCallback([&](float /*value*/) {
-      play = 0.0;
-      for (auto &sf : soundfiles) {
-        sf.soundfile->seek(0);
-      }
-      play = 1.0;
+      sendTransport({TransportCommand::SEEK, 0});
+      playAfterSeek();
     });
     fw.registerChangeCallback([&](float /*value*/) {
-      play = 0.0;
-      for (auto &sf : soundfiles) {
-        sf.soundfile->seek(sf.soundfile->currentPosition() +
-                           5 * sf.soundfile->frameRate());
-      }
-      play = 1.0;
+      sendTransport(
+          {TransportCommand::SKIP, int64_t(5 * streamer.frameRate(0))});
+      playAfterSeek();
     });
     back.registerChangeCallback([&](float /*value*/) {
-      play = 0.0;
-      for (auto &sf : soundfiles) {
-        sf.soundfile->seek(sf.soundfile->currentPosition() -
-                           5 * sf.soundfile->frameRate());
-      }
-      play = 1.0;
+      sendTransport(
+          {TransportCommand::SKIP, -int64_t(5 * streamer.frameRate(0))});
+      playAfterSeek();
     });
 
     AudioDevice dev = AudioDevice::defaultOutput();
@@ -94,7 +108,7 @@ public:
       dev = AudioDevice("ECHO X5");
       gainAdjustment.configure(AlloSphereSpeakerLayoutCompensated(), 1.82);
     }
-    configureAudio(dev, soundfiles.back().soundfile->frameRate(), 1024,
+    configureAudio(dev, streamer.frameRate(soundfiles.back().stream), 1024,
                    dev.channelsOutMax(), 0);
 
     audioIO().append(gainAdjustment);
@@ -109,6 +123,16 @@ public:
       }
     }
     audioIO().channelsOut(highestChannel + 1);
+
+    // onSound() reads the files through these, in slices of scratchFrames if
+    // the buffer size is changed later
+    scratchFrames = audioIO().framesPerBuffer();
+    for (auto &sf : soundfiles) {
+      int numChannels = streamer.channels(sf.stream);
+      sf.scratch.resize(scratchFrames * numChannels);
+      sf.outputs.resize(numChannels, nullptr);
+    }
+
     if (soundfiles.size() == 6) {
       // assume 5.1 to stereo
       mDownMixer.set5_1toStereo(audioIO());
@@ -134,16 +158,20 @@ public:
                                     " (Global)##AudioIO");
     ParameterGUI::drawAudioIO(audioIO());
     if (soundfiles.size() > 0) {
-      ImGui::Text("Time: %f", soundfiles[0].soundfile->currentPosition() /
-                                  soundfiles[0].soundfile->frameRate());
+      ImGui::Text("Time: %f", streamer.position(soundfiles[0].stream) /
+                                  streamer.frameRate(soundfiles[0].stream));
     }
+    ImGui::Text("Underruns: %llu",
+                (unsigned long long)streamer.totalUnderruns());
     ImGui::Separator();
     for (auto &sf : soundfiles) {
       ImGui::Text("*** %s", sf.fileName.c_str());
       ImGui::SameLine(0, 20);
-      ImGui::PushID(sf.soundfile.get());
+      ImGui::PushID(sf.stream);
       ImGui::Checkbox("Mute", &sf.mute);
       ImGui::Text("%s", sf.fileInfoText.c_str());
+      ImGui::Text(" underruns: %llu",
+                  (unsigned long long)streamer.underruns(sf.stream));
       ImGui::PopID();
     }
 
@@ -153,22 +181,72 @@ public:
     imguiDraw();
   }
 
+  void sendTransport(const TransportCommand &command) {
+    if (!transport.push(command)) {
+      std::cerr << "Transport queue full. Command dropped." << std::endl;
+    }
+  }
+
+  void playAfterSeek() {
+    play.setNoCalls(1.0);
+    sendTransport({TransportCommand::PLAY});
+  }
+
+  // Audio thread
+  void processTransport() {
+    TransportCommand command;
+    while (transport.pop(command)) {
+      switch (command.type) {
+      case TransportCommand::PLAY:
+        // Starting with a seek on its way plays from the seek target, not
+        // from where playback stopped
+        if (!playing) {
+          startAtSeek = streamer.seekPending();
+        }
+        playing = true;
+        break;
+      case TransportCommand::PAUSE:
+        playing = false;
+        break;
+      case TransportCommand::SEEK:
+        streamer.requestSeek(command.frames);
+        break;
+      case TransportCommand::SKIP: {
+        // Skips pile up on a seek that hasn't been switched to yet
+        int64_t from = streamer.seekPending() ? streamer.seekTarget()
+                                              : streamer.position(0);
+        streamer.requestSeek(std::max<int64_t>(0, from + command.frames));
+        break;
+      }
+      }
+    }
+    // All streams switch to the new position in the same block
+    streamer.applySeek();
+    if (!streamer.seekPending()) {
+      startAtSeek = false;
+    }
+  }
+
   void onSound(AudioIOData &io) override {
-    float buffer[2048 * 60];
-    if (play.get() == 1.0f) {
+    processTransport();
+    if (playing && !startAtSeek) {
+      int frames = io.framesPerBuffer();
       for (auto &sf : soundfiles) {
-        int numChannels = sf.soundfile->channels();
-        int framesRead = sf.soundfile->read(buffer, io.framesPerBuffer());
-        if (framesRead != io.framesPerBuffer()) {
-          std::cout << "short buffer " << framesRead << std::endl;
-        }
-        for (size_t i = 0; i < sf.outChannelMap.size(); i++) {
-          size_t outIndex = sf.outChannelMap[i];
+        int numChannels = streamer.channels(sf.stream);
+        for (int offset = 0; offset < frames; offset += scratchFrames) {
+          // Short reads are counted by the streamer as underruns
+          int framesRead =
+              streamer.read(sf.stream, sf.scratch.data(),
+                            std::min(frames - offset, scratchFrames));
           if (!sf.mute) {
-            for (uint64_t sample = 0; sample < framesRead; sample++) {
-              io.outBuffer(outIndex)[sample] +=
-                  sf.gain * buffer[sample * numChannels + i];
+            for (size_t i = 0; i < sf.outputs.size(); i++) {
+              sf.outputs[i] =
+                  i < sf.outChannelMap.size()
+                      ? io.outBuffer(sf.outChannelMap[i]) + offset
+                      : nullptr;
             }
+            deinterleaveGainAdd(sf.outputs.data(), sf.scratch.data(),
+                                numChannels, sf.gain, framesRead);
           }
         }
       }
@@ -179,14 +257,15 @@ public:
   }
 
   void onExit() override {
-    for (auto &sf : soundfiles) {
-      sf.soundfile->close();
-    }
+    streamer.stop();
     imguiShutdown();
   }
 
 private:
   std::vector<MappedAudioFile> soundfiles;
+  bool playing{false};     // Audio thread
+  bool startAtSeek{false}; // Audio thread: silent until the seek is applied
+  int scratchFrames{0};
   SpeakerDistanceGainAdjustmentProcessor gainAdjustment;
   DownMixer mDownMixer;
 };
@@ -197,6 +276,7 @@ int main(int argc, char *argv[]) {
   /* Load configuration from text file. Config file should look like:
 
 rootDir = "files/"
+prefetchSeconds = 4.0
 [[file]]
 name = "test.wav"
 outChannels = [0, 1]
@@ -219,6 +299,9 @@ gain = 1.2
   if (appConfig.hasKey<std::string>("rootDir")) {
     app.rootDir = appConfig.gets("rootDir");
   }
+  if (appConfig.hasKey<double>("prefetchSeconds")) {
+    app.streamer.prefetchSeconds(appConfig.getd("prefetchSeconds"));
+  }
   if (appConfig.hasKey<double>("globalGain")) {
     assert(app.audioDomain()->parameters()[0]->getName() == "gain");
     app.audioDomain()->parameters()[0]->fromFloat(appConfig.getd("globalGain"));
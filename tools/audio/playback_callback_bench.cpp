@@ -0,0 +1,192 @@
+// Audio callback time of multichannel_playback for a 55 stem session
+//
+// Writes 55 mono stems of noise to a temporary folder, streams them with
+// DiskStreamer in real time and times the body of the audio callback, with
+// buffers of 512 and 1024 frames:
+//  - "stack": a float[2048 * 60] buffer on the stack and a scalar strided
+//    loop per output channel, as onSound() used to do,
+//  - "scratch": the preallocated per-stream buffers and
+//    deinterleaveGainAdd() that onSound() uses now.
+// Reports mean and worst callback time, and the mean as a share of the
+// buffer period.
+//
+// Usage (from the bin folder):
+//   playback_callback_bench [seconds] [stems]
+//
+//   seconds  audio played per buffer size and path (default: 10)
+//   stems    number of mono files (default: 55)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+#include "al/io/al_AudioIOData.hpp"
+
+#include "Deinterleave.h"
+#include "DiskStreamer.h"
+
+using namespace al;
+
+const int sampleRate = 48000;
+const int outChannels = 60;
+const int stemSeconds = 5; // Stems loop
+
+struct Stem {
+  int stream;
+  std::vector<size_t> outChannelMap;
+  float gain;
+  std::vector<float> scratch;
+  std::vector<float *> outputs;
+};
+
+bool writeStem(const std::string &path, unsigned int seed) {
+  SF_INFO info{};
+  info.samplerate = sampleRate;
+  info.channels = 1;
+  info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+  SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+  if (!file) {
+    std::cerr << "ERROR: writing " << path << ": " << sf_strerror(nullptr)
+              << std::endl;
+    return false;
+  }
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+  std::vector<float> samples(sampleRate * stemSeconds);
+  for (auto &s : samples) {
+    s = noise(rng);
+  }
+  sf_writef_float(file, samples.data(), samples.size());
+  sf_close(file);
+  return true;
+}
+
+template <class Callback>
+void bench(const std::vector<std::string> &paths, const char *name,
+           int blockSize, double seconds) {
+  DiskStreamer streamer;
+  std::vector<Stem> stems;
+  for (size_t i = 0; i < paths.size(); i++) {
+    Stem stem;
+    stem.stream = streamer.addStream(paths[i], true);
+    stem.outChannelMap = {i % outChannels};
+    stem.gain = 0.8f;
+    stem.scratch.resize(blockSize);
+    stem.outputs.resize(1);
+    stems.push_back(std::move(stem));
+  }
+  streamer.start();
+
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(outChannels);
+
+  auto period = std::chrono::duration<double>(double(blockSize) / sampleRate);
+  long numBlocks = long(seconds * sampleRate / blockSize);
+  double total = 0, worst = 0;
+  auto deadline = std::chrono::steady_clock::now();
+  for (long block = 0; block < numBlocks; block++) {
+    io.zeroOut();
+    auto start = std::chrono::steady_clock::now();
+    Callback::process(io, streamer, stems);
+    double elapsed = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    total += elapsed;
+    worst = std::max(worst, elapsed);
+    // Pace the callbacks like an audio device would
+    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        period);
+    std::this_thread::sleep_until(deadline);
+  }
+  streamer.stop();
+
+  double mean = total / numBlocks;
+  std::cout << std::setw(8) << blockSize << std::setw(10) << name
+            << std::setw(12) << mean << std::setw(12) << worst << std::setw(10)
+            << 100.0 * mean / (period.count() * 1e6) << "%" << std::setw(11)
+            << streamer.totalUnderruns() << std::endl;
+}
+
+// The callback as it was
+struct StackCallback {
+  static void process(AudioIOData &io, DiskStreamer &streamer,
+                      std::vector<Stem> &stems) {
+    float buffer[2048 * 60];
+    for (auto &sf : stems) {
+      int numChannels = streamer.channels(sf.stream);
+      int framesRead = streamer.read(sf.stream, buffer, io.framesPerBuffer());
+      for (size_t i = 0; i < sf.outChannelMap.size(); i++) {
+        size_t outIndex = sf.outChannelMap[i];
+        for (int sample = 0; sample < framesRead; sample++) {
+          io.outBuffer(outIndex)[sample] +=
+              sf.gain * buffer[sample * numChannels + i];
+        }
+      }
+    }
+  }
+};
+
+// The callback as it is now
+struct ScratchCallback {
+  static void process(AudioIOData &io, DiskStreamer &streamer,
+                      std::vector<Stem> &stems) {
+    for (auto &sf : stems) {
+      int numChannels = streamer.channels(sf.stream);
+      int framesRead =
+          streamer.read(sf.stream, sf.scratch.data(), io.framesPerBuffer());
+      for (size_t i = 0; i < sf.outputs.size(); i++) {
+        sf.outputs[i] = io.outBuffer(sf.outChannelMap[i]);
+      }
+      deinterleaveGainAdd(sf.outputs.data(), sf.scratch.data(), numChannels,
+                          sf.gain, framesRead);
+    }
+  }
+};
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 10.0;
+  int numStems = argc > 2 ? std::stoi(argv[2]) : 55;
+
+  std::string folder = "playback_callback_bench_stems/";
+  std::string mkdir = "mkdir -p " + folder;
+  if (std::system(mkdir.c_str()) != 0) {
+    std::cerr << "ERROR: creating " << folder << std::endl;
+    return -1;
+  }
+  std::vector<std::string> paths;
+  for (int i = 0; i < numStems; i++) {
+    paths.push_back(folder + "stem" + std::to_string(i) + ".wav");
+    if (!writeStem(paths.back(), i)) {
+      return -1;
+    }
+  }
+
+  std::cout << numStems << " mono stems, " << seconds
+            << " s per run. Times in microseconds per callback." << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(8) << "frames" << std::setw(10) << "path"
+            << std::setw(12) << "mean" << std::setw(12) << "worst"
+            << std::setw(11) << "load" << std::setw(11) << "underruns"
+            << std::endl;
+  for (int blockSize : {512, 1024}) {
+    bench<StackCallback>(paths, "stack", blockSize, seconds);
+    bench<ScratchCallback>(paths, "scratch", blockSize, seconds);
+  }
+
+  for (auto &path : paths) {
+    std::remove(path.c_str());
+  }
+  return 0;
+}
@@ -1,3 +1,5 @@
+#include <chrono>
+
 #include "al/app/al_DistributedApp.hpp"
 #include "al/app/al_GUIDomain.hpp"
 #include "al/graphics/al_Shapes.hpp"
@@ -7,6 +9,7 @@
 #include "al/io/al_Toml.hpp"
 #include "al/math/al_Spherical.hpp"
 #include "al/scene/al_DistributedScene.hpp"
+#include "al/scene/al_SynthSequencer.hpp"
 #include "al/sound/al_DownMixer.hpp"
 #include "al/sound/al_Lbap.hpp"
 #include "al/sound/al_Speaker.hpp"
@@ -21,12 +24,19 @@
 #include "al_ext/statedistribution/al_CuttleboneDomain.hpp"
 
 #include "Gamma/Analysis.h"
+#include "Gamma/Domain.h"
 #include "Gamma/scl.h"
 
+#include "Deinterleave.h"
+#include "MeterEngine.h"
+#include "PoseAutomation.h"
+#include "SequenceEndTime.h"
+#include "SoundFileCache.h"
+
 using namespace al;
 
 struct SharedState {
-  float meterValues[64] = {0};
+  MeterValues meterValues;
 };
 
 struct MappedAudioFile {
@@ -40,9 +50,11 @@ struct MappedAudioFile {
 
 struct AudioObjectData {
   std::string rootPath;
-  uint16_t audioSampleRate;
-  uint16_t audioBlockSize;
+  double audioSampleRate;
+  uint32_t audioBlockSize;
   Mesh *mesh;
+  SoundFileCache *cache; // Short files, decoded before audio starts
+  bool bounce{false};    // Rendering offline, see bounce()
 };
 
 class AudioObject : public PositionedVoice {
@@ -58,29 +70,98 @@ public:
   // Internal
   Parameter env{"env", "", 1.0, 0.00001, 10};
 
+  static const int maxChannels = 8; // Most channels of a file that plays
+
   void init() override {
     registerTriggerParameters(file, automation, gain);
     registerParameters(env);             // Propagate from audio rendering node
     registerParameters(parameterPose()); // Update position in secondary nodes
 
-    mSequencer << parameterPose();
-    mPresetHandler << parameterPose();
-    mSequencer << mPresetHandler; // For morphing
+    // Scratch space for onProcess(), sized once so triggering never
+    // allocates. Blocks larger than the block size it was sized for are
+    // read in parts.
+    auto objData = static_cast<AudioObjectData *>(userData());
+    unsigned int blockSize = objData ? objData->audioBlockSize : 512;
+    mScratch.resize(std::max(blockSize, 1u) * maxChannels);
+    mOutputs.resize(maxChannels, nullptr);
+
+    // Look the clip up when the file is set, which the sequencer does when
+    // it reads the event, so triggering a cached clip builds no path
+    file.registerChangeCallback([this](std::string name) { findClip(name); });
+    // Same for the automation, which is parsed into memory so triggering
+    // only rewinds it
+    automation.registerChangeCallback(
+        [this](std::string name) { loadAutomation(name); });
+  }
+
+  // The cached clip for the file name, if any. The root path and the cache
+  // are set up before any voice is created and don't change after that.
+  void findClip(const std::string &name) {
+    auto objData = static_cast<AudioObjectData *>(userData());
+    mClip = objData ? objData->cache->find(
+                          File::conformPathToOS(objData->rootPath) + name)
+                    : nullptr;
+  }
+
+  // Parses the automation sequence for the name. Voices are reused, so a
+  // name that is already loaded isn't read again.
+  void loadAutomation(const std::string &name) {
+    auto objData = static_cast<AudioObjectData *>(userData());
+    if (!objData || name == mAutomationName) {
+      return;
+    }
+    std::string path = File::conformPathToOS(objData->rootPath) + name;
+    if (path.find(".sequence") == std::string::npos) {
+      path += ".sequence";
+    }
+    mAutomation.load(path);
+    mAutomationName = name;
   }
 
   void onProcess(AudioIOData &io) override {
-    float buffer[2048 * 60];
-    int numChannels = soundfile.channels();
-    assert(io.framesPerBuffer() < INT32_MAX);
-    auto framesRead =
-        soundfile.read(buffer, static_cast<int>(io.framesPerBuffer()));
-    int outIndex = 0;
-    size_t inChannel = 0;
+    if (isPrimary() && !mAutomation.empty()) {
+      // Automation follows audio time
+      setPose(mAutomation.step(io.framesPerBuffer() / io.framesPerSecond()));
+    }
+    if (mCursor.clip()) {
+      processCached(io);
+      return;
+    }
+    bool opened = mBounceFile || soundfile.opened();
+    if (!opened || mScratch.empty()) {
+      return;
+    }
+    int numChannels = mBounceFile ? mBounceInfo.channels : soundfile.channels();
+    int frames = io.framesPerBuffer();
+    int scratchFrames = int(mScratch.size()) / numChannels;
+    for (int offset = 0; offset < frames; offset += scratchFrames) {
+      int n = std::min(frames - offset, scratchFrames);
+      // When bouncing, read straight from disk so the render can't get ahead
+      // of the file
+      int framesRead =
+          mBounceFile ? int(sf_readf_float(mBounceFile, mScratch.data(), n))
+                      : int(soundfile.read(mScratch.data(), n));
+      mix(io, mScratch.data(), numChannels, offset, framesRead);
+    }
+  }
+
+  // Plays straight out of the shared decoded frames
+  void processCached(AudioIOData &io) {
+    const float *frames;
+    int numChannels = mCursor.clip()->channels;
+    int framesRead = mCursor.read(frames, io.framesPerBuffer());
+    mix(io, frames, numChannels, 0, framesRead);
+  }
+
+  void mix(AudioIOData &io, const float *frames, int numChannels, int offset,
+           int numFrames) {
     if (!mute) {
-      for (size_t sample = 0; sample < framesRead; sample++) {
-        io.outBuffer(outIndex)[sample] +=
-            gain * buffer[sample * numChannels + inChannel];
-        mEnvFollow(buffer[sample * numChannels + inChannel]);
+      // Only the first channel of the file is played
+      mOutputs[0] = io.outBuffer(0) + offset;
+      deinterleaveGainAdd(mOutputs.data(), frames, numChannels, gain.get(),
+                          numFrames);
+      for (int sample = 0; sample < numFrames; sample++) {
+        mEnvFollow(frames[sample * numChannels]);
       }
     }
   }
@@ -101,18 +182,34 @@ public:
     auto objData = static_cast<AudioObjectData *>(userData());
 
     if (isPrimary()) {
-      auto &rootPath = objData->rootPath;
-      soundfile.open(File::conformPathToOS(rootPath) + file.get());
-      if (!soundfile.opened()) {
-        std::cerr << "ERROR: opening audio file: "
-                  << File::conformPathToOS(rootPath) + file.get() << std::endl;
+      mBounce = objData->bounce;
+      // Cached clips start without touching the disk
+      mCursor.start(mClip);
+      int numChannels = 1;
+      if (mCursor.clip()) {
+        numChannels = mCursor.clip()->channels;
+      } else {
+        std::string path =
+            File::conformPathToOS(objData->rootPath) + file.get();
+        if (mBounce) {
+          mBounceFile = sf_open(path.c_str(), SFM_READ, &mBounceInfo);
+          numChannels = mBounceFile ? mBounceInfo.channels : 1;
+        } else {
+          soundfile.open(path);
+          numChannels = std::max(soundfile.channels(), 1);
+        }
+        if (!mBounceFile && !soundfile.opened()) {
+          std::cerr << "ERROR: opening audio file: " << path << std::endl;
+        }
       }
-
-      float seqStep = (float)objData->audioBlockSize / objData->audioSampleRate;
-      mSequencer.setSequencerStepTime(seqStep);
-
-      mSequencer.playSequence(File::conformPathToOS(rootPath) +
-                              automation.get());
+      if (numChannels > maxChannels) {
+        std::cerr << "ERROR: " << file.get() << " has " << numChannels
+                  << " channels, at most " << maxChannels << " can play"
+                  << std::endl;
+        closeFiles();
+      }
+      std::fill(mOutputs.begin(), mOutputs.end(), nullptr);
+      mAutomation.restart(pose());
     }
     auto colorIndex = automation.get()[0] - 'A';
     c = HSV(colorIndex / 6.0f, 1.0f, 1.0f);
@@ -120,23 +217,65 @@ public:
 
   void onTriggerOff() override {
     if (isPrimary()) {
-      mPresetHandler.stopMorphing();
-      mSequencer.stopSequence();
-      soundfile.close();
+      closeFiles();
     }
   }
 
-  void onFree() override { soundfile.close(); }
+  void onFree() override { closeFiles(); }
+
+  void closeFiles() {
+    soundfile.close();
+    mCursor.stop();
+    if (mBounceFile) {
+      sf_close(mBounceFile);
+      mBounceFile = nullptr;
+    }
+  }
 
 private:
-  PresetSequencer mSequencer;
-  PresetHandler mPresetHandler{""};
-  SoundFileBuffered soundfile{8192};
+  SoundFileBuffered soundfile{8192}; // Files too large for the cache
+  SoundFileCache::Cursor mCursor;    // Cached files
+  std::shared_ptr<const SoundFileCache::Clip> mClip; // For file, if cached
+  PoseAutomation mAutomation;        // Parsed automationFile
+  std::string mAutomationName;       // automationFile mAutomation was read from
+  SNDFILE *mBounceFile{nullptr};     // Uncached files when bouncing
+  SF_INFO mBounceInfo{};
+  bool mBounce{false};
+  std::vector<float> mScratch;       // Interleaved frames read from the file
+  std::vector<float *> mOutputs;     // Output buffer for each file channel
   Color c;
 
   gam::EnvFollow<> mEnvFollow;
 };
 
+// Decodes the short audio files in the root folder, so triggering them
+// needs no disk I/O
+void cacheSoundFiles(SoundFileCache &cache, const std::string &rootDir) {
+  FileList files = fileListFromDir(rootDir);
+  for (unsigned int i = 0; i < files.count(); i++) {
+    std::string name = files[i].file();
+    std::string extension = name.substr(name.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   ::tolower);
+    if (extension == "wav" || extension == "aif" || extension == "aiff" ||
+        extension == "flac" || extension == "ogg") {
+      cache.load(File::conformPathToOS(rootDir) + name);
+    }
+  }
+  std::cout << "Cached " << cache.numClips() << " sound files ("
+            << cache.bytes() / (1 << 20) << " MB)" << std::endl;
+}
+
+// Adds the stereo downmix in buses 0 and 1 to the LFE channel
+void mixLfe(AudioIOData &io) {
+  // This can be used to create a global reverb
+  while (io()) {
+    float lfeLevel = 0.1;
+    io.out(47) += io.bus(0) * lfeLevel;
+    io.out(47) += io.bus(1) * lfeLevel;
+  }
+}
+
 class SpatialSequencer : public DistributedAppWithState<SharedState> {
 public:
   std::string rootDir{""};
@@ -160,8 +299,11 @@ public:
     mObjectData.rootPath = rootDir;
     mObjectData.audioSampleRate = audioIO().framesPerSecond();
     mObjectData.audioBlockSize = audioIO().framesPerBuffer();
+    mObjectData.cache = &mSoundFileCache;
     scene.setDefaultUserData(&mObjectData);
 
+    cacheSoundFiles(mSoundFileCache, rootDir);
+
     if (al::sphere::isSimulatorMachine()) {
     }
     auto sl = al::AlloSphereSpeakerLayoutCompensated();
@@ -169,6 +311,9 @@ public:
 
     audioIO().channelsOut(60);
     audioIO().print();
+    if (isPrimary()) {
+      mMeters.start(audioIO().channelsOut(), audioIO().framesPerSecond());
+    }
 
     downMixer.layoutToStereo(sl, audioIO());
     downMixer.setStereoOutput();
@@ -207,12 +352,10 @@ public:
   void onAnimate(double dt) override {
     mSequencer.update(dt);
     if (isPrimary()) {
-      auto &values = mMeter.getMeterValues();
-      assert(values.size() < 65);
-      memcpy(state().meterValues, values.data(), values.size() * sizeof(float));
-    } else {
-      mMeter.setMeterValues(state().meterValues, 64);
+      state().meterValues = mMeters.values();
     }
+    mMeter.setMeterValues(state().meterValues.display,
+                          state().meterValues.numChannels);
   }
 
   void onDraw(Graphics &g) override {
@@ -238,15 +381,10 @@ public:
 
   void onSound(AudioIOData &io) override {
     mSequencer.render(io);
-    mMeter.processSound(io);
+    mMeters.write(io);
     // downmix to stereo to bus 0 and 1
     downMixer.downMixToBus(io);
-    // This can be used to create a global reverb
-    while (io()) {
-      float lfeLevel = 0.1;
-      io.out(47) += io.bus(0) * lfeLevel;
-      io.out(47) += io.bus(1) * lfeLevel;
-    }
+    mixLfe(io);
     if (downMix) {
       downMixer.copyBusToOuts(io);
     }
@@ -260,20 +398,177 @@ private:
 
   SynthSequencer mSequencer{TimeMasterMode::TIME_MASTER_CPU};
   AudioObjectData mObjectData;
+  SoundFileCache mSoundFileCache;
   SpeakerDistanceGainAdjustmentProcessor gainAdjustment;
-  Meter mMeter;
+  Meter mMeter; // Draws state().meterValues
+  MeterEngine mMeters;
   std::shared_ptr<Spatializer> mSpatializer;
 };
 
-int main(int argc, char *argv[]) {
-  SpatialSequencer app;
+SNDFILE *openOutputFile(const std::string &path, int channels,
+                        double sampleRate) {
+  SF_INFO info{};
+  info.samplerate = int(sampleRate);
+  info.channels = channels;
+  // RF64 goes past the 4 GB limit of WAV, which 60 channels reach in about
+  // six minutes. Shorter files are written as plain WAV.
+  info.format = SF_FORMAT_RF64 | SF_FORMAT_FLOAT;
+  SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+  if (!file) {
+    std::cerr << "ERROR: opening " << path
+              << " for writing: " << sf_strerror(nullptr) << std::endl;
+    return nullptr;
+  }
+  sf_command(file, SFC_RF64_AUTO_DOWNGRADE, nullptr, SF_TRUE);
+  return file;
+}
+
+// Renders a sequence of the folder through the same scene, Lbap spatializer
+// and downmix as the application, as fast as the CPU allows, without audio
+// device, window or network. The object automation runs in audio time (see
+// PoseAutomation.h). Writes outputBase + "_60ch.wav" and outputBase +
+// "_stereo.wav".
+int bounce(const std::string &folder, std::string sequenceName,
+           const std::string &outputBase, double sampleRate,
+           unsigned int blockSize) {
+  const int channels = 60;
+  std::string rootDir = File::conformDirectory(folder);
+  if (sequenceName.find(".synthSequence") == std::string::npos) {
+    sequenceName += ".synthSequence";
+  }
+  double endTime = sequenceEndTime(rootDir + sequenceName);
+  if (endTime <= 0.0) {
+    std::cerr << "ERROR: no events found in " << rootDir + sequenceName
+              << std::endl;
+    return -1;
+  }
+
+  // Gamma objects read the sample rate when constructed, so this must be set
+  // before any voice is allocated.
+  gam::sampleRate(sampleRate);
+
+  SoundFileCache cache;
+  cacheSoundFiles(cache, rootDir);
+
+  AudioObjectData objectData;
+  objectData.rootPath = rootDir;
+  objectData.audioSampleRate = sampleRate;
+  objectData.audioBlockSize = blockSize;
+  objectData.mesh = nullptr;
+  objectData.cache = &cache;
+  objectData.bounce = true;
+
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(channels);
+  io.channelsBus(2);
+
+  auto sl = AlloSphereSpeakerLayoutCompensated();
+  DynamicScene scene{0, TimeMasterMode::TIME_MASTER_AUDIO};
+  scene.setDefaultUserData(&objectData);
+  scene.setSpatializer<Lbap>(sl);
+  scene.registerSynthClass<AudioObject>();
+  scene.allocatePolyphony<AudioObject>(16);
+  scene.prepare(io);
+
+  DownMixer downMixer;
+  downMixer.layoutToStereo(sl, io);
+  downMixer.setStereoOutput();
+
+  SynthSequencer sequencer{TimeMasterMode::TIME_MASTER_AUDIO};
+  sequencer << scene;
+  sequencer.setDirectory(rootDir);
+
+  SNDFILE *spatialFile =
+      openOutputFile(outputBase + "_60ch.wav", channels, sampleRate);
+  SNDFILE *stereoFile =
+      openOutputFile(outputBase + "_stereo.wav", 2, sampleRate);
+  if (!spatialFile || !stereoFile) {
+    return -1;
+  }
+
+  sequencer.playSequence(sequenceName);
+  std::cout << "Bouncing " << sequenceName << " (" << endTime << " s) to "
+            << outputBase << "_60ch.wav and " << outputBase << "_stereo.wav"
+            << std::endl;
+
+  // Stop once all objects are freed after the last event, with a hard limit
+  // in case one never frees itself
+  const double maxTail = 30.0;
+  std::vector<float> spatial(blockSize * channels);
+  std::vector<float> stereo(blockSize * 2);
+  uint64_t framesRendered = 0;
+  auto startClock = std::chrono::steady_clock::now();
+  while (true) {
+    double time = framesRendered / sampleRate;
+    if (time >= endTime && (scene.getActiveVoices() == nullptr ||
+                            time >= endTime + maxTail)) {
+      break;
+    }
+    io.zeroOut();
+    io.zeroBus();
+    io.frame(0);
+    sequencer.render(io);
+    downMixer.downMixToBus(io);
+    io.frame(0);
+    mixLfe(io);
+    for (int chan = 0; chan < channels; chan++) {
+      const float *out = io.outBuffer(chan);
+      for (unsigned int i = 0; i < blockSize; i++) {
+        spatial[i * channels + chan] = out[i];
+      }
+    }
+    for (int chan = 0; chan < 2; chan++) {
+      const float *bus = io.busBuffer(chan);
+      for (unsigned int i = 0; i < blockSize; i++) {
+        stereo[i * 2 + chan] = bus[i];
+      }
+    }
+    sf_writef_float(spatialFile, spatial.data(), blockSize);
+    sf_writef_float(stereoFile, stereo.data(), blockSize);
+    framesRendered += blockSize;
+  }
+  auto endClock = std::chrono::steady_clock::now();
+  sf_close(spatialFile);
+  sf_close(stereoFile);
+
+  double wallSeconds =
+      std::chrono::duration<double>(endClock - startClock).count();
+  double audioSeconds = framesRendered / sampleRate;
+  std::cout << "Rendered " << audioSeconds << " s of audio in " << wallSeconds
+            << " s (" << audioSeconds / wallSeconds << "x realtime)"
+            << std::endl;
+  return 0;
+}
 
+// Usage:
+//   spatial_sequencer [folder]
+//   spatial_sequencer folder --bounce sequence [output] [sampleRate]
+//                     [blockSize]
+//
+// The second form renders a sequence offline instead of starting the
+// application, see bounce(). output defaults to the sequence name,
+// sampleRate to 48000 and blockSize to 512.
+int main(int argc, char *argv[]) {
   std::string folder;
   if (argc > 1) {
     folder = argv[1];
   } else {
     folder = "Morris Allosphere piece";
   }
+
+  if (argc > 3 && std::string(argv[2]) == "--bounce") {
+    std::string sequenceName = argv[3];
+    std::string output = argc > 4 ? argv[4]
+                                  : sequenceName.substr(
+                                        0, sequenceName.rfind(".synthSequence"));
+    double sampleRate = argc > 5 ? std::stod(argv[5]) : 48000.0;
+    unsigned int blockSize = argc > 6 ? std::stoi(argv[6]) : 512;
+    return bounce(folder, sequenceName, output, sampleRate, blockSize);
+  }
+
+  SpatialSequencer app;
   app.setPath(folder);
 
   app.start();
@@ -26,10 +26,12 @@
 #include "Gamma/Noise.h"
 #include "Gamma/scl.h"
 
+#include "MeterEngine.h"
+
 using namespace al;
 
 struct SharedState {
-  float meterValues[64] = {0};
+  MeterValues meterValues;
   Pose pose;
 };
 
@@ -46,42 +48,6 @@ public:
     mSl = sl;
   }
 
-  void processSound(AudioIOData &io) {
-
-    if (tempValues.size() != io.channelsOut()) {
-      tempValues.resize(io.channelsOut());
-      values.resize(io.channelsOut());
-      std::cout << "Resizing Meter buffers" << std::endl;
-    }
-    for (int i = 0; i < io.channelsOut(); i++) {
-      tempValues[i] = FLT_MIN;
-      auto *outBuf = io.outBuffer(i);
-      auto fpb = io.framesPerBuffer();
-      for (int samp = 0; samp < fpb; samp++) {
-        float val = fabs(*outBuf);
-        if (tempValues[i] < val) {
-          tempValues[i] = val;
-        }
-        outBuf++;
-      }
-      if (tempValues[i] == 0) {
-        tempValues[i] = 0.01;
-      } else {
-        float db = 20.0 * log10(tempValues[i]);
-        if (db < -60) {
-          tempValues[i] = 0.01;
-        } else {
-          tempValues[i] = 0.01 + 0.005 * (60 + db);
-        }
-      }
-      if (values[i] > tempValues[i]) {
-        values[i] = values[i] - 0.05 * (values[i] - tempValues[i]);
-      } else {
-        values[i] = tempValues[i];
-      }
-    }
-  }
-
   void draw(Graphics &g) {
     g.polygonLine();
     int index = 0;
@@ -107,11 +73,8 @@ public:
     }
   }
 
-  const std::vector<float> &getMeterValues() { return values; }
-
-  void setMeterValues(float *newValues, size_t count) {
-    if (tempValues.size() != count) {
-      tempValues.resize(count);
+  void setMeterValues(const float *newValues, size_t count) {
+    if (values.size() != count) {
       values.resize(count);
       std::cout << "Resizing Meter buffers" << std::endl;
     }
@@ -125,7 +88,6 @@ public:
 private:
   Mesh mMesh;
   std::vector<float> values;
-  std::vector<float> tempValues;
   Speakers mSl;
 };
 
@@ -249,6 +211,9 @@ public:
 
     audioIO().channelsOut(60);
     audioIO().print();
+    if (isPrimary()) {
+      mMeters.start(audioIO().channelsOut(), audioIO().framesPerSecond());
+    }
 
     mSequencer << scene;
 
@@ -302,14 +267,13 @@ public:
   void onAnimate(double dt) override {
     mSequencer.update(dt);
     if (isPrimary()) {
-      auto &values = mMeter.getMeterValues();
-      assert(values.size() < 65);
-      memcpy(state().meterValues, values.data(), values.size() * sizeof(float));
+      state().meterValues = mMeters.values();
       state().pose = nav();
     } else {
-      mMeter.setMeterValues(state().meterValues, 64);
       nav().set(state().pose);
     }
+    mMeter.setMeterValues(state().meterValues.display,
+                          state().meterValues.numChannels);
   }
 
   void onDraw(Graphics &g) override {
@@ -336,7 +300,7 @@ public:
   void onSound(AudioIOData &io) override {
     if (isPrimary()) {
     mSequencer.render(io);
-    mMeter.processSound(io);
+    mMeters.write(io);
     }
 
   }
@@ -364,6 +328,7 @@ private:
   AudioObjectData mObjectData;
   SpeakerDistanceGainAdjustmentProcessor gainAdjustment;
   Meter mMeter;
+  MeterEngine mMeters;
   std::shared_ptr<Spatializer> mSpatializer;
 };
 
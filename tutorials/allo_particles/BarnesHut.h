@@ -0,0 +1,231 @@
+#pragma once
+#ifndef BarnesHut_H
+#define BarnesHut_H
+
+// Octree for Barnes-Hut approximations of N-body forces.
+//
+// Summing the pull of every body on every other body costs N^2 force
+// evaluations per step. Barnes-Hut groups bodies into an octree, and a group
+// that looks small from where the force is evaluated acts as one body at its
+// center of mass. A cell of side s at distance d from the point is used
+// whole when s / d < theta(). theta() = 0 opens every cell, which gives the
+// exact sum. At 0.5 forces are off by a few tenths of a percent, and far
+// fewer sources are visited (see barnes_hut_bench.cpp). Each point visits
+// about log N cells, so a step costs O(N log N).
+//
+// The tree only finds the sources, (position, mass) pairs. The caller sums
+// whatever force law it uses. A point inside a cell always opens it, so a
+// body never feels itself through a cell that contains it.
+//
+// build() is serial. forEachSource() doesn't change the tree, so points can
+// be evaluated on many threads at once.
+//
+// Usage:
+//   BarnesHut tree;
+//   tree.theta(0.5f);
+//   tree.build(positions.data(), masses.data(), positions.size());
+//   // For each body i, possibly in parallel
+//   Vec3f force(0);
+//   tree.forEachSource(positions[i], i, [&](const Vec3f &p, float m) {
+//     force += law(positions[i], p, m);
+//   });
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <vector>
+
+#include "al/math/al_Vec.hpp"
+
+class BarnesHut {
+public:
+  // Opening angle
+  void theta(float theta) { mTheta = std::max(theta, 0.0f); }
+  float theta() const { return mTheta; }
+
+  // Bodies per leaf, at least 1
+  void leafSize(int bodies) { mLeafSize = std::max(bodies, 1); }
+
+  // Builds the tree for n bodies. Positions and masses are copied.
+  template <class Mass>
+  void build(const al::Vec3f *positions, const Mass *masses, size_t n) {
+    mNodes.clear();
+    mPositions.assign(positions, positions + n);
+    mMasses.resize(n);
+    mOrder.resize(n);
+    mOctants.resize(n);
+    mScratch.resize(n);
+    if (n == 0) {
+      return;
+    }
+    al::Vec3f low(FLT_MAX), high(-FLT_MAX);
+    for (size_t i = 0; i < n; i++) {
+      mMasses[i] = float(masses[i]);
+      mOrder[i] = int(i);
+      for (int k = 0; k < 3; k++) {
+        low[k] = std::min(low[k], positions[i][k]);
+        high[k] = std::max(high[k], positions[i][k]);
+      }
+    }
+    float half = 0.0f;
+    for (int k = 0; k < 3; k++) {
+      half = std::max(half, 0.5f * (high[k] - low[k]));
+    }
+    mNodes.push_back(Node());
+    mNodes[0].center = (low + high) * 0.5f;
+    mNodes[0].half = half * 1.001f + FLT_MIN;
+    buildNode(0, 0, int(n), 0);
+  }
+
+  // Calls source(position, mass) for every body and cell acting on point,
+  // skipping body self (-1 for none)
+  template <class Source>
+  void forEachSource(const al::Vec3f &point, int self, Source &&source) const {
+    if (mNodes.empty()) {
+      return;
+    }
+    const float theta2 = mTheta * mTheta;
+    int stack[maxDepth * 8 + 8];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const Node &node = mNodes[stack[--top]];
+      al::Vec3f d = node.centerOfMass - point;
+      float side = 2.0f * node.half;
+      al::Vec3f fromCenter = point - node.center;
+      bool inside = std::abs(fromCenter.x) <= node.half &&
+                    std::abs(fromCenter.y) <= node.half &&
+                    std::abs(fromCenter.z) <= node.half;
+      if (!inside && side * side < theta2 * d.magSqr()) {
+        source(node.centerOfMass, node.mass);
+      } else if (node.leaf) {
+        for (int b = node.first; b < node.first + node.count; b++) {
+          int body = mOrder[b];
+          if (body != self) {
+            source(mPositions[body], mMasses[body]);
+          }
+        }
+      } else {
+        for (int c = node.first; c < node.first + node.count; c++) {
+          stack[top++] = c;
+        }
+      }
+    }
+  }
+
+  size_t numNodes() const { return mNodes.size(); }
+
+private:
+  static const int maxDepth = 32; // Deeper cells only hold coincident bodies
+
+  struct Node {
+    al::Vec3f center;       // Of the cube
+    float half{0};          // Half the side of the cube
+    al::Vec3f centerOfMass;
+    float mass{0};
+    bool leaf{true};
+    // Leaves: bodies mOrder[first, first + count). Other nodes: children
+    // mNodes[first, first + count).
+    int first{0};
+    int count{0};
+  };
+
+  // Splits bodies mOrder[begin, end) of node into octants, recursively
+  void buildNode(int index, int begin, int end, int depth) {
+    if (end - begin <= mLeafSize || depth >= maxDepth) {
+      Node &node = mNodes[index];
+      node.leaf = true;
+      node.first = begin;
+      node.count = end - begin;
+      float mass = 0.0f;
+      al::Vec3f moment(0.0f);
+      for (int b = begin; b < end; b++) {
+        mass += mMasses[mOrder[b]];
+        moment += mPositions[mOrder[b]] * mMasses[mOrder[b]];
+      }
+      setCenterOfMass(node, mass, moment, begin, end);
+      return;
+    }
+
+    // Counting sort by octant
+    al::Vec3f center = mNodes[index].center;
+    int counts[8] = {0};
+    for (int b = begin; b < end; b++) {
+      const al::Vec3f &p = mPositions[mOrder[b]];
+      int octant = (p.x >= center.x) | ((p.y >= center.y) << 1) |
+                   ((p.z >= center.z) << 2);
+      mOctants[b] = octant;
+      counts[octant]++;
+    }
+    int starts[9];
+    starts[0] = begin;
+    for (int o = 0; o < 8; o++) {
+      starts[o + 1] = starts[o] + counts[o];
+    }
+    int fill[8];
+    std::copy(starts, starts + 8, fill);
+    for (int b = begin; b < end; b++) {
+      mScratch[fill[mOctants[b]]++] = mOrder[b];
+    }
+    std::copy(mScratch.begin() + begin, mScratch.begin() + end,
+              mOrder.begin() + begin);
+
+    // Children are contiguous. mNodes may reallocate while they are built,
+    // so nodes are only referred to by index.
+    int firstChild = int(mNodes.size());
+    float half = 0.5f * mNodes[index].half;
+    for (int o = 0; o < 8; o++) {
+      if (counts[o] > 0) {
+        Node child;
+        child.center = center + al::Vec3f((o & 1) ? half : -half,
+                                          (o & 2) ? half : -half,
+                                          (o & 4) ? half : -half);
+        child.half = half;
+        mNodes.push_back(child);
+      }
+    }
+    int numChildren = int(mNodes.size()) - firstChild;
+    mNodes[index].leaf = false;
+    mNodes[index].first = firstChild;
+    mNodes[index].count = numChildren;
+    int child = firstChild;
+    for (int o = 0; o < 8; o++) {
+      if (counts[o] > 0) {
+        buildNode(child++, starts[o], starts[o + 1], depth + 1);
+      }
+    }
+
+    float mass = 0.0f;
+    al::Vec3f moment(0.0f);
+    for (int c = firstChild; c < firstChild + numChildren; c++) {
+      mass += mNodes[c].mass;
+      moment += mNodes[c].centerOfMass * mNodes[c].mass;
+    }
+    setCenterOfMass(mNodes[index], mass, moment, begin, end);
+  }
+
+  // Massless cells use the mean position of their bodies
+  void setCenterOfMass(Node &node, float mass, const al::Vec3f &moment,
+                       int begin, int end) {
+    node.mass = mass;
+    if (mass > 0.0f) {
+      node.centerOfMass = moment / mass;
+      return;
+    }
+    al::Vec3f sum(0.0f);
+    for (int b = begin; b < end; b++) {
+      sum += mPositions[mOrder[b]];
+    }
+    node.centerOfMass = sum / float(end - begin);
+  }
+
+  float mTheta{0.5f};
+  int mLeafSize{8};
+  std::vector<Node> mNodes; // Root first
+  std::vector<al::Vec3f> mPositions;
+  std::vector<float> mMasses;
+  std::vector<int> mOrder; // Bodies sorted so every node's are contiguous
+  std::vector<int> mOctants, mScratch;
+};
+
+#endif // BarnesHut_H
@@ -0,0 +1,167 @@
+// Accuracy against speed of the Barnes-Hut gravity of p4.cpp
+//
+// Places particles uniformly in a cube, with masses between 1 and 2, and
+// times one gravity step, tree build included, for several opening angles:
+//  - "pairs": every pair of particles, one thread, as p4.cpp used to do
+//    (only up to 10000 particles, it takes minutes per step beyond),
+//  - "theta": BarnesHut.h with that opening angle, on one thread and on one
+//    thread per core. theta 0 opens every cell, so it is exact.
+// The error is the RMS of the force errors over the RMS of the forces, for
+// 1000 particles checked against the exact sum. "sources" is the number of
+// particles and cells summed per particle.
+//
+// Usage (from the bin folder):
+//   barnes_hut_bench [seconds]
+//
+//   seconds  time spent per particle count and path (default: 2)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "al/math/al_Vec.hpp"
+
+#include "ParallelFor.h"
+#include "BarnesHut.h"
+
+using namespace al;
+
+const int numChecked = 1000;
+
+// Softened inverse square pull of a source on a point
+inline Vec3f pull(const Vec3f &point, const Vec3f &source, float mass) {
+  Vec3f r = source - point;
+  float d2 = r.magSqr() + 1e-6f;
+  return r * (mass / (d2 * std::sqrt(d2)));
+}
+
+struct Bodies {
+  std::vector<Vec3f> positions;
+  std::vector<float> masses;
+  std::vector<Vec3f> forces;
+};
+
+void directForces(Bodies &b, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    Vec3f f(0.0f);
+    for (size_t j = 0; j < b.positions.size(); j++) {
+      if (j != i) {
+        f += pull(b.positions[i], b.positions[j], b.masses[j]);
+      }
+    }
+    b.forces[i] = f;
+  }
+}
+
+// One step, returns the sources summed
+size_t treeForces(Bodies &b, BarnesHut &tree, ParallelFor &parallel) {
+  tree.build(b.positions.data(), b.masses.data(), b.positions.size());
+  std::vector<size_t> sources((b.positions.size() + 255) / 256, 0);
+  parallel(b.positions.size(), 256, [&](size_t begin, size_t end) {
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+      Vec3f f(0.0f);
+      const Vec3f &p = b.positions[i];
+      tree.forEachSource(p, int(i), [&](const Vec3f &source, float mass) {
+        f += pull(p, source, mass);
+        count++;
+      });
+      b.forces[i] = f;
+    }
+    sources[begin / 256] = count;
+  });
+  size_t total = 0;
+  for (size_t s : sources) {
+    total += s;
+  }
+  return total;
+}
+
+template <class Step> double stepRate(double seconds, Step step) {
+  int steps = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  while (elapsed < seconds || steps < 2) {
+    step();
+    steps++;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+  return steps / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 2.0;
+  unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+  ParallelFor one(1), all(cores);
+
+  std::cout << "Steps per second, " << cores << " threads for \"N threads\"."
+            << std::endl
+            << std::endl;
+  std::cout << std::setw(10) << "particles" << std::setw(8) << "theta"
+            << std::setw(12) << "1 thread" << std::setw(12) << "N threads"
+            << std::setw(10) << "error" << std::setw(10) << "sources"
+            << std::endl;
+  for (int n : {1000, 10000, 100000, 300000}) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> side(-1.0f, 1.0f), mass(1.0f, 2.0f);
+    Bodies b;
+    float spread = std::cbrt(n / 100.0f);
+    for (int i = 0; i < n; i++) {
+      b.positions.push_back(Vec3f(side(rng), side(rng), side(rng)) * spread);
+      b.masses.push_back(mass(rng));
+    }
+    b.forces.resize(n);
+
+    // Exact forces on the checked particles
+    std::vector<int> checked;
+    for (int k = 0; k < numChecked; k++) {
+      checked.push_back(int((long long)k * n / numChecked));
+    }
+    std::vector<Vec3f> exact;
+    for (int i : checked) {
+      directForces(b, i, i + 1);
+      exact.push_back(b.forces[i]);
+    }
+
+    std::cout << std::fixed;
+    if (n <= 10000) {
+      std::cout << std::setprecision(1) << std::setw(10) << n << std::setw(8)
+                << "pairs" << std::setw(12)
+                << stepRate(seconds, [&]() { directForces(b, 0, n); })
+                << std::setw(12) << "-" << std::setw(10) << "0.000%"
+                << std::setw(10) << n - 1 << std::endl;
+    }
+    for (float theta : {0.0f, 0.3f, 0.5f, 0.7f, 1.0f}) {
+      if (theta == 0.0f && n > 10000) {
+        continue;
+      }
+      BarnesHut tree;
+      tree.theta(theta);
+      size_t sources = 0;
+      double rateOne =
+          stepRate(seconds, [&]() { sources = treeForces(b, tree, one); });
+      double rateAll =
+          stepRate(seconds, [&]() { treeForces(b, tree, all); });
+      double errorSum = 0, forceSum = 0;
+      for (int k = 0; k < numChecked; k++) {
+        errorSum += (b.forces[checked[k]] - exact[k]).magSqr();
+        forceSum += exact[k].magSqr();
+      }
+      std::cout << std::setprecision(1) << std::setw(10) << n << std::setw(8)
+                << theta << std::setw(12) << rateOne << std::setw(12)
+                << rateAll << std::setprecision(3) << std::setw(9)
+                << 100.0 * std::sqrt(errorSum / forceSum) << "%"
+                << std::setprecision(0) << std::setw(10)
+                << double(sources) / n << std::endl;
+    }
+  }
+  return 0;
+}
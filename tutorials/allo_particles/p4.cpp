@@ -1,6 +1,10 @@
 // Ryan Millett
 // 2023-01-19
 //
+// Gravity is summed with a Barnes-Hut octree (BarnesHut.h) on every core, so
+// the system runs with up to a few hundred thousand particles. The number of
+// particles can be passed on the command line. The space they start in grows
+// with it, so they stay as dense as the original 100.
 
 #include "al/app/al_App.hpp"
 #include "al/app/al_GUIDomain.hpp"
@@ -13,11 +17,16 @@ using namespace al;
 using namespace std;
 
 #include<algorithm>
+#include <cmath>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 #include <numeric> // for std::accumulate
 
-const int MAX_PARTICLES = 100;
+#include "BarnesHut.h"
+#include "ParallelFor.h"
+
+int MAX_PARTICLES = 100;
 int numSuns = 1;
 float pPlanets = 3.1667, pMoons = 6.333, pAsteroids = 27.67;
 // float pPlanets = 0.3, pMoons = 0.7, pAsteroids = 1.3;
@@ -46,6 +55,9 @@ struct AnApp : App {
   ParameterBool isAsymmetrical{"asymmetric-force", "", 1.f, 0, 1.0f};
   Parameter timeStep{"time-step", "", 10.0f, 0.0001f, 1000.0f};
   ParameterBool rotate{"rotate", "", 1.f, 0, 1.0f};
+  // Barnes-Hut opening angle. 0 sums every pair exactly, larger is faster
+  // and less accurate (see barnes_hut_bench.cpp).
+  Parameter openingAngle{"opening-angle", "", 0.5f, 0.0f, 1.5f};
   Mesh position{Mesh::POINTS};
   Mesh sphere;
   std::vector<Vec3f> velocity;
@@ -55,8 +67,69 @@ struct AnApp : App {
   std::vector<double> dragScale;
   std::vector<double> age;
 
+  BarnesHut tree;
+  ParallelFor parallel;
+
+  // Uniform grid of the particles placed so far, so that generate_particles()
+  // only checks the neighborhood of a new particle for overlaps. Particles
+  // wider than half a cell are few (the suns) and checked separately.
+  const float placementCell = 0.8f;
+  std::unordered_map<long long, std::vector<int>> placed;
+  std::vector<int> placedLarge;
+
   double time = 0.0;
 
+  // Scale of the space particles start in, for the density of 100 particles
+  float spread() { return std::cbrt(MAX_PARTICLES / 100.0f); }
+
+  long long placementKey(int x, int y, int z) {
+    return ((long long)(x & 0xfffff) << 40) | ((long long)(y & 0xfffff) << 20) |
+           (long long)(z & 0xfffff);
+  }
+
+  int placementCellOf(float v) { return (int)std::floor(v / placementCell); }
+
+  bool overlapsPlaced(Vec3f p, double rad) {
+    auto &vertices = position.vertices();
+    auto overlaps = [&](int j) {
+      return (vertices[j] - p).mag() < radius[j] + rad;
+    };
+    if (rad > 0.5f * placementCell) {
+      for (int j = 0; j < (int)radius.size(); ++j) {
+        if (overlaps(j)) return true;
+      }
+      return false;
+    }
+    for (int j : placedLarge) {
+      if (overlaps(j)) return true;
+    }
+    int cx = placementCellOf(p.x), cy = placementCellOf(p.y),
+        cz = placementCellOf(p.z);
+    for (int z = cz - 1; z <= cz + 1; ++z) {
+      for (int y = cy - 1; y <= cy + 1; ++y) {
+        for (int x = cx - 1; x <= cx + 1; ++x) {
+          auto cell = placed.find(placementKey(x, y, z));
+          if (cell == placed.end()) continue;
+          for (int j : cell->second) {
+            if (overlaps(j)) return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  void addPlaced(int i) {
+    if (radius[i] > 0.5f * placementCell) {
+      placedLarge.push_back(i);
+      return;
+    }
+    Vec3f p = position.vertices()[i];
+    placed[placementKey(placementCellOf(p.x), placementCellOf(p.y),
+                        placementCellOf(p.z))]
+        .push_back(i);
+  }
+
   // function to scale relative levels to a probability distribution
   std::vector<int> scale_to_prob_dist(int numSuns, float pPlanets, float pMoons, float pAsteroids) {
     float total = numSuns + pPlanets + pMoons + pAsteroids;
@@ -74,37 +147,39 @@ void generate_particles(int num_particles, std::string particle_type, double mas
     for (int i = 0; i < num_particles; ++i) {
         bool collision = position.vertices().size() > 0;
         Vec3f newVert = vertex;
+        double newRad = rad + (rnd::uniform() * randScale * 0.1);
         while (collision) {
-            collision = false;
-            newVert = vertex + r();
-            for (int j = 0; j < position.vertices().size() - 1; ++j) {
-                if ((position.vertices()[j] - newVert).mag() < radius[j] + rad) {
-                    // cout << "j: " << j << endl;
-                    collision = true;
-                    break;
-                }
-            }
+            newVert = vertex + r() * spread();
+            collision = overlapsPlaced(newVert, newRad);
         }
         position.vertex(newVert);
         position.color(color + (c() * randScale * 0.5));
         velocity.push_back(vel + (rnd::uniformS() * randScale * 0.01f));
         mass.push_back(massVal + (rnd::uniform() * randScale * 0.01f));
-        radius.push_back(rad + (rnd::uniform() * randScale * 0.1));
+        radius.push_back(newRad);
         gForce.push_back(Vec3f(0.0f, 0.0f, 0.0f));
         dragScale.push_back(1.0f);
         age.push_back(0.0);
+        addPlaced((int)radius.size() - 1);
         // cout << "Particle " << i << " of type " << particle_type << " created." << endl;
     }
 }
 
+  // Moves the last particle into slot i, so removal doesn't shift the rest.
+  // Indices above i stay valid, so remove in decreasing order.
   void removeParticle(int i) {
-    position.vertices().erase(position.vertices().begin() + i);
-    velocity.erase(velocity.begin() + i);
-    mass.erase(mass.begin() + i);
-    radius.erase(radius.begin() + i);
-    gForce.erase(gForce.begin() + i);
-    dragScale.erase(dragScale.begin() + i);
-    age.erase(age.begin() + i);
+    auto swapPop = [i](auto &v) {
+      v[i] = v.back();
+      v.pop_back();
+    };
+    swapPop(position.vertices());
+    swapPop(position.colors());
+    swapPop(velocity);
+    swapPop(mass);
+    swapPop(radius);
+    swapPop(gForce);
+    swapPop(dragScale);
+    swapPop(age);
   }
 
   void setParticles (int maxParticles, int numSuns, float pPlanets, float pMoons, float pAsteroids) {
@@ -163,10 +238,15 @@ void generate_particles(int num_particles, std::string particle_type, double mas
   void resetParticles(int maxParticles) {
     time = 0.0;
     position.vertices().clear();
+    position.colors().clear();
     velocity.clear();
     mass.clear();
     radius.clear();
     gForce.clear();
+    dragScale.clear();
+    age.clear();
+    placed.clear();
+    placedLarge.clear();
 
     setParticles(maxParticles, numSuns, pPlanets, pMoons, pAsteroids);
   }
@@ -177,7 +257,7 @@ void generate_particles(int num_particles, std::string particle_type, double mas
     
     // addSphere(sphere, radius[0], 50, 50);
     // sphere.generateNormals();
-    nav().pos(0, 0, 15);
+    nav().pos(0, 0, 15 * spread());
   }
 
   bool isIntersecting(Vec3f point1, float radius1, Vec3f point2, float radius2) {
@@ -190,12 +270,13 @@ void generate_particles(int num_particles, std::string particle_type, double mas
     time += dt * timeStep.get();
     float timeRate = dt * timeStep.get();
     mass[0] *= sunMassScale.get();// * (age[0] / timeRate);  // scale the mass of the sun proportional to it's age
+    double c = sunMassScale.get();  // increase sun mass
+    mass[0] *= (c >= 1.0) ? c : 1.0;
     // cout << position.colors() << endl;//.lerp(Vec3f(1.f, 0.f, 0.f, 1.f), 0.01f);  // set the color of the sun
-    // for each particle, calculate the distance and force of gravity 
-    // between it and every other particle except itself.
+    auto &vertices = position.vertices();
     std::vector<int> deadParticles;
-    for (int i = 0; i < velocity.size(); ++i) {
-      if (i != 0 && position.vertices()[i] == position.vertices()[0]) {
+    for (int i = 1; i < (int)velocity.size(); ++i) {
+      if (vertices[i] == vertices[0]) {
       // && isIntersecting(position.vertices()[i],
       //                           radius[i],
       //                           position.vertices()[0],
@@ -205,39 +286,53 @@ void generate_particles(int num_particles, std::string particle_type, double mas
         mass[0] += mass[i];
         // add particle to the list of particles to be removed
         deadParticles.push_back(i);
-      }      
-      // cout << "mass[" << i << "]: " << mass[i] << endl;
-      for (int j = 0; j < velocity.size(); ++j) {
-        // cout << "-> mass[" << j << "]: " << mass[j] << endl;
-        if (i != j) {
-          float maxF = maxForce.get();
-          Vec3f r = position.vertices()[j] - position.vertices()[i];
-          // calculate the force of gravity...
-          Vec3f F = min(Common::F_G(mass[i], mass[j], r.mag(), gravScale.get()), maxF) * r.normalize();
-          float asymF = (j > i && isAsymmetrical.get()) ? 0.5f : 1.f;
-          gForce[i] += (float)dt * (F / 1.f) * 1.f * asymF;
-          gForce[j] -= (float)dt * (F / 1.f) * 1.f * asymF;
-        }
       }
-      if (i != 0 ) {  // don't move the sun
-        position.vertices()[i] += velocity[i] * dt * timeStep.get();
-      } else {  // increase sun mass
-        double c = sunMassScale.get();
-        mass[0] *= (c >= 1.0) ? c : 1.0;
-      }
-      // semi-implicit Euler integration
-      // apply the force of gravity to the velocity
-      // cout << "i: " << i << endl;
-      velocity[i] += -velocity[i] * (dragScale[i] * drag.get()) + gForce[i];
-      gForce[i] = gForce[i] * forceDiffuseScalar.get();
-      age[i] += dt * timeStep.get() / mass[i];  // age is proportional to mass (bigger mass = ages slower)
-      float ageK = age[i] * 0.1f;
-      float dragRate = (ageK < 1.0f) ? ageK : 1.0f;
-      dragScale[i] *= dragRate;  // drag increases with age
     }
-    
+
+    // For each particle, sum the force of gravity from every other particle,
+    // or from the center of mass of far away groups of them. All forces are
+    // computed from the positions at the start of the step, so particles are
+    // updated in parallel. The tree keeps its own copy of the positions.
+    // The force cap applies per source, so a far group is capped as a whole.
+    // Each pair used to be applied twice, once from each side, with the
+    // asymmetric force halving one of the two. Each pair now counts once, and
+    // the asymmetric force keeps the same 3/4 ratio.
+    tree.theta(openingAngle.get());
+    tree.build(vertices.data(), mass.data(), vertices.size());
+    float maxF = maxForce.get();
+    float g = gravScale.get();
+    float forceScale = (float)dt * (isAsymmetrical.get() ? 0.75f : 1.f);
+    float dragK = drag.get();
+    float diffuse = forceDiffuseScalar.get();
+    parallel(velocity.size(), 64, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        Vec3f p = vertices[i];
+        float m = mass[i];
+        Vec3f F(0.0f);
+        tree.forEachSource(p, (int)i, [&](const Vec3f &source, float sourceMass) {
+          Vec3f r = source - p;
+          float d = r.mag();
+          if (d > 0.0f) {
+            F += min(Common::F_G(m, sourceMass, d, g), maxF) * (r / d);
+          }
+        });
+        gForce[i] += F * forceScale;
+        if (i != 0) {  // don't move the sun
+          vertices[i] += velocity[i] * timeRate;
+        }
+        // semi-implicit Euler integration
+        // apply the force of gravity to the velocity
+        velocity[i] += -velocity[i] * (dragScale[i] * dragK) + gForce[i];
+        gForce[i] = gForce[i] * diffuse;
+        age[i] += timeRate / mass[i];  // age is proportional to mass (bigger mass = ages slower)
+        float ageK = age[i] * 0.1f;
+        float dragRate = (ageK < 1.0f) ? ageK : 1.0f;
+        dragScale[i] *= dragRate;  // drag increases with age
+      }
+    });
+
     // put this in a "Valkyrie" function
-    for (int i = 0; i < deadParticles.size(); ++i) {
+    for (int i = (int)deadParticles.size() - 1; i >= 0; --i) {
       // remove dead particle
       removeParticle(deadParticles[i]);
     }
@@ -274,10 +369,15 @@ void generate_particles(int num_particles, std::string particle_type, double mas
     gui.add(forceDiffuseScalar);
     gui.add(isAsymmetrical);
     gui.add(timeStep);
+    gui.add(openingAngle);
   }
 };
 
-int main() {
+// Usage: p4 [number of particles]
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    MAX_PARTICLES = std::max(1, std::atoi(argv[1]));
+  }
   AnApp app;
   app.start();
   return 0;
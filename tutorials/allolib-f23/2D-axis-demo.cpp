@@ -20,40 +20,20 @@ Modified by Phill Conrad, Eirini Schoinas, Riona Pampati, 2023
 
 #include "al/graphics/al_Font.hpp" // for text rendering
 
+#include "AxisMesh.h"
+
 // Drawing on a 2D canvas using pixel coordinates
 
 using namespace al;
 
 struct MyApp : public App
 {
-  Mesh xAxis;
-  Mesh yAxis;
+  AxisMesh xAxis{AxisMesh::X, Color(1, 1, 0), AxisMesh::POINTS};
+  AxisMesh yAxis{AxisMesh::Y, Color(0, 1, 1), AxisMesh::POINTS};
 
   // this font is for rendering text labels on the axes
   FontRenderer fontRender;
 
-  void drawLabelAbove(Graphics &g, float x, float y, float labelOffset, float fontSize)
-  {
-    std::ostringstream oss;
-    oss << std::fixed << std::showpoint;
-    oss << std::setprecision(1);
-    oss << "(" << x << "," << y << ")";
-    fontRender.alignCenter(); // makes the text centered around the position
-    fontRender.write(oss.str().c_str(), fontSize);
-    fontRender.renderAt(g, {x, y + labelOffset, 0.0});
-  }
-
-  void drawLabelRight(Graphics &g, float x, float y, float labelOffset, float fontSize)
-  {
-    std::ostringstream oss;
-    oss << std::fixed << std::showpoint;
-    oss << std::setprecision(1);
-    oss << "(" << x << "," << y << ")";
-    fontRender.alignLeft(); // makes the text centered around the position
-    fontRender.write(oss.str().c_str(), fontSize);
-    fontRender.renderAt(g, {x + labelOffset, y - (fontSize * 0.2), 0.0});
-  }
-
   void drawAxes(Graphics &g,
                 float minX,
                 float maxX,
@@ -64,64 +44,10 @@ struct MyApp : public App
                 float labelOffset,
                 float fontSize)
   {
-    xAxis.primitive(Mesh::LINE_STRIP);
-    yAxis.primitive(Mesh::LINE_STRIP);
-
-    // Create x and y axes
-    xAxis.vertex(minX, 0);
-    xAxis.vertex(maxX, 0);
-
-    yAxis.vertex(0, minY);
-    yAxis.vertex(0, maxY);
-
-    // Create the X tick marks and labels
-
-    for (float x = 0; x < maxX; x += tickIncrement)
-    {
-      xAxis.vertex(x, 0);
-      xAxis.vertex(x, tickSize);
-      xAxis.vertex(x, -tickSize);
-      xAxis.vertex(x, 0);
-      drawLabelAbove(g, x, 0, labelOffset, fontSize);
-    }
-
-    for (float x = 0; x >= minX; x -= tickIncrement)
-    {
-      xAxis.vertex(x, 0);
-      xAxis.vertex(x, tickSize);
-      xAxis.vertex(x, -tickSize);
-      xAxis.vertex(x, 0);
-      drawLabelAbove(g, x, 0, labelOffset, fontSize);
-    }
-
-    // Create the Y tick marks and labels
-
-    for (float y = 0; y <= maxY; y += tickIncrement)
-    {
-      yAxis.vertex(0, y);
-      yAxis.vertex(tickSize, y);
-      yAxis.vertex(-tickSize, y);
-      yAxis.vertex(0, y);
-      g.color(1, 1, 1);
-      drawLabelRight(g, 0, y, labelOffset, fontSize);
-    }
-
-    for (float y = 0; y >= minY; y -= tickIncrement)
-    {
-      yAxis.vertex(0, y);
-      yAxis.vertex(tickSize, y);
-      yAxis.vertex(-tickSize, y);
-      yAxis.vertex(0, y);
-      g.color(1, 1, 1);
-      drawLabelRight(g, 0, y, labelOffset, fontSize);
-    }
-
-    //  Draw the axes
-    g.color(1, 1, 0);
-    g.draw(xAxis);
-
-    g.color(0, 1, 1);
-    g.draw(yAxis);
+    xAxis.draw(g, fontRender, minX, maxX, tickIncrement, tickSize, labelOffset,
+               fontSize);
+    yAxis.draw(g, fontRender, minY, maxY, tickIncrement, tickSize, labelOffset,
+               fontSize);
   }
 
   void onCreate()
@@ -20,41 +20,20 @@ Modified by Phill Conrad, Eirini Schoinas, Riona Pampati, 2023
 
 #include "al/graphics/al_Font.hpp" // for text rendering
 
+#include "AxisMesh.h"
+
 // Drawing on a 2D canvas using pixel coordinates
 
 using namespace al;
 
 struct MyApp : public App
 {
-  Mesh xAxis;
-  Mesh yAxis;
+  AxisMesh xAxis{AxisMesh::X, Color(1, 1, 0)};
+  AxisMesh yAxis{AxisMesh::Y, Color(0, 1, 1)};
 
   // this font is for rendering text labels on the axes
   FontRenderer fontRender;
 
-  void drawLabelX(Graphics &g, float x, float labelOffset, float fontSize)
-  {
-    std::ostringstream oss;
-    oss << std::fixed << std::showpoint;
-    oss << std::setprecision(1);
-    oss << "x=" << x ;
-    fontRender.alignCenter(); // makes the text centered around the position
-    fontRender.write(oss.str().c_str(), fontSize);
-    fontRender.renderAt(g, {x, labelOffset, 0.0});
-  }
-
-  void drawLabelY(Graphics &g, float y, float labelOffset, float fontSize)
-  {
-    std::ostringstream oss;
-    oss << std::fixed << std::showpoint;
-    oss << std::setprecision(1);
-    oss << "y=" << y;
-    fontRender.alignLeft(); // makes the text centered around the position
-    fontRender.write(oss.str().c_str(), fontSize);
-    fontRender.renderAt(g, {labelOffset, y - (fontSize * 0.2), 0.0});
-  }
-
-
   void drawXAxis(Graphics &g,
                 float minX,
                 float maxX,
@@ -63,35 +42,8 @@ struct MyApp : public App
                 float labelOffset,
                 float fontSize)
   {
-    xAxis.primitive(Mesh::LINE_STRIP);
-
-    // Create x and y axes
-    xAxis.vertex(minX, 0);
-    xAxis.vertex(maxX, 0);
- 
-    // Create the X tick marks and labels
-
-    for (float x = 0; x < maxX; x += tickIncrement)
-    {
-      xAxis.vertex(x, 0);
-      xAxis.vertex(x, tickSize);
-      xAxis.vertex(x, -tickSize);
-      xAxis.vertex(x, 0);
-      drawLabelX(g, x, labelOffset, fontSize);
-    }
-
-    for (float x = 0; x >= minX; x -= tickIncrement)
-    {
-      xAxis.vertex(x, 0);
-      xAxis.vertex(x, tickSize);
-      xAxis.vertex(x, -tickSize);
-      xAxis.vertex(x, 0);
-      drawLabelX(g, x, labelOffset, fontSize);
-    }
-
-    //  Draw the axis
-    g.color(1, 1, 0);
-    g.draw(xAxis);
+    xAxis.draw(g, fontRender, minX, maxX, tickIncrement, tickSize,
+               labelOffset, fontSize);
   }
 
 
@@ -104,40 +56,8 @@ struct MyApp : public App
                 float labelOffset,
                 float fontSize)
   {
-    yAxis.primitive(Mesh::LINE_STRIP);
-
-
-
-    yAxis.vertex(0, minY);
-    yAxis.vertex(0, maxY);
-
-
-    // Create the Y tick marks and labels
-
-    for (float y = 0; y <= maxY; y += tickIncrement)
-    {
-      yAxis.vertex(0, y);
-      yAxis.vertex(tickSize, y);
-      yAxis.vertex(-tickSize, y);
-      yAxis.vertex(0, y);
-      g.color(1, 1, 1);
-      drawLabelY(g, y, labelOffset, fontSize);
-    }
-
-    for (float y = 0; y >= minY; y -= tickIncrement)
-    {
-      yAxis.vertex(0, y);
-      yAxis.vertex(tickSize, y);
-      yAxis.vertex(-tickSize, y);
-      yAxis.vertex(0, y);
-      g.color(1, 1, 1);
-      drawLabelY(g, y, labelOffset, fontSize);
-    }
-
-    //  Draw the Y Axis
-
-    g.color(0, 1, 1);
-    g.draw(yAxis);
+    yAxis.draw(g, fontRender, minY, maxY, tickIncrement, tickSize,
+               labelOffset, fontSize);
   }
 
   void onCreate()
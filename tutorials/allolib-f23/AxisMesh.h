@@ -0,0 +1,174 @@
+#pragma once
+#ifndef AxisMesh_H
+#define AxisMesh_H
+
+// One axis of a plot: its line, tick marks and labels.
+//
+// The apps used to append the ticks to a member Mesh on every frame without
+// resetting it, so the axes grew by a few dozen vertices a frame for as long
+// as the app ran. Each label was also formatted through an ostringstream and
+// laid out by FontRenderer::write, which uploads a mesh per label per frame.
+//
+// AxisMesh builds the ticks into one mesh and the glyphs of every label into
+// another, and keeps them until the range, tick increment, tick size, label
+// offset, font size or font change. A frame with the same inputs as the last
+// one is two draw calls and no uploads.
+//
+// Usage:
+//   AxisMesh xAxis{AxisMesh::X, Color(1, 1, 0)};
+//   xAxis.draw(g, fontRender, -180, 180, 30, 5, 5, 10);   // In onDraw()
+//
+// fontRender is any loaded Font, such as the apps' FontRenderer.
+
+#include <cstdio>
+
+#include "al/graphics/al_Font.hpp"
+#include "al/graphics/al_Graphics.hpp"
+#include "al/graphics/al_VAOMesh.hpp"
+
+class AxisMesh {
+public:
+  enum Direction { X, Y, Z };
+
+  // "x=30.0", or the point the tick is at, "(30.0,0.0)"
+  enum Labels { NAMED, POINTS };
+
+  AxisMesh(Direction direction, const al::Color &color,
+           Labels labels = NAMED)
+      : mDirection(direction), mColor(color), mLabelStyle(labels) {}
+
+  // Draws the axis from min to max with a tick and label every
+  // tickIncrement, rebuilding it first if any input changed
+  void draw(al::Graphics &g, al::Font &font, float min, float max,
+            float tickIncrement, float tickSize, float labelOffset,
+            float fontSize) {
+    Key key{&font, min, max, tickIncrement, tickSize, labelOffset, fontSize};
+    if (mBuilds == 0 || !(key == mKey)) {
+      mKey = key;
+      build(font);
+    }
+
+    g.blending(true);
+    g.blendTrans();
+    g.texture();
+    font.tex.bind();
+    g.draw(mLabels);
+    font.tex.unbind();
+    g.blending(false);
+
+    g.color(mColor);
+    g.draw(mTicks);
+  }
+
+  // Number of times the meshes have been built
+  size_t builds() const { return mBuilds; }
+
+  const al::Mesh &ticks() const { return mTicks; }
+  const al::Mesh &labels() const { return mLabels; }
+
+private:
+  struct Key {
+    al::Font *font;
+    float min, max, tickIncrement, tickSize, labelOffset, fontSize;
+
+    bool operator==(const Key &other) const {
+      return font == other.font && min == other.min && max == other.max &&
+             tickIncrement == other.tickIncrement &&
+             tickSize == other.tickSize && labelOffset == other.labelOffset &&
+             fontSize == other.fontSize;
+    }
+  };
+
+  void build(al::Font &font) {
+    mTicks.reset();
+    mTicks.primitive(al::Mesh::LINE_STRIP);
+    mLabels.reset();
+    mLabels.primitive(al::Mesh::TRIANGLES);
+    if (mDirection == X) {
+      font.alignCenter();
+    } else {
+      font.alignLeft();
+    }
+
+    // The line, then out to each tick and back, from 0 up then from 0 down
+    vertex(mKey.min, 0);
+    vertex(mKey.max, 0);
+    if (mKey.tickIncrement > 0) {
+      // The x axis stops short of max, the y and z axes reach it
+      for (float v = 0; mDirection == X ? v < mKey.max : v <= mKey.max;
+           v += mKey.tickIncrement) {
+        tick(font, v);
+      }
+      for (float v = 0; v >= mKey.min; v -= mKey.tickIncrement) {
+        tick(font, v);
+      }
+    }
+
+    mTicks.update();
+    mLabels.update();
+    mBuilds++;
+  }
+
+  // The point along the axis, moved across it by the tick direction
+  al::Vec3f point(float along, float across = 0) const {
+    switch (mDirection) {
+    case X:
+      return al::Vec3f(along, across, 0);
+    case Y:
+      return al::Vec3f(across, along, 0);
+    default:
+      return al::Vec3f(across, 0, along);
+    }
+  }
+
+  void vertex(float along, float across) {
+    mTicks.vertex(point(along, across));
+  }
+
+  void tick(al::Font &font, float v) {
+    vertex(v, 0);
+    vertex(v, mKey.tickSize);
+    vertex(v, -mKey.tickSize);
+    vertex(v, 0);
+
+    char text[64];
+    al::Vec3f p = point(v);
+    if (mLabelStyle == POINTS && mDirection == Z) {
+      std::snprintf(text, sizeof(text), "(%.1f,%.1f,%.1f)", p.x, p.y, p.z);
+    } else if (mLabelStyle == POINTS) {
+      std::snprintf(text, sizeof(text), "(%.1f,%.1f)", p.x, p.y);
+    } else {
+      std::snprintf(text, sizeof(text), "%c=%.1f", "xyz"[mDirection], v);
+    }
+    // Where FontRenderer::renderAt() used to put the label: above x ticks,
+    // right of y and z ticks
+    al::Vec3f at = mDirection == X
+                       ? p + al::Vec3f(0, mKey.labelOffset, 0)
+                       : p + al::Vec3f(mKey.labelOffset,
+                                       -mKey.fontSize * 0.2f, 0);
+
+    mGlyphs.reset();
+    font.write(mGlyphs, text, mKey.fontSize);
+    unsigned int first = unsigned(mLabels.vertices().size());
+    for (auto &position : mGlyphs.vertices()) {
+      mLabels.vertex(position + at);
+    }
+    for (auto &texCoord : mGlyphs.texCoord2s()) {
+      mLabels.texCoord(texCoord);
+    }
+    for (auto index : mGlyphs.indices()) {
+      mLabels.index(first + index);
+    }
+  }
+
+  Direction mDirection;
+  al::Color mColor;
+  Labels mLabelStyle;
+  Key mKey{};
+  size_t mBuilds{0};
+  al::VAOMesh mTicks;
+  al::VAOMesh mLabels;
+  al::Mesh mGlyphs; // One label, written by the font
+};
+
+#endif // AxisMesh_H
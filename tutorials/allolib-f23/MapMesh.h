@@ -0,0 +1,107 @@
+#pragma once
+#ifndef MapMesh_H
+#define MapMesh_H
+
+// All map outlines in one mesh, uploaded once and drawn with one call.
+//
+// Drawing each shape as its own LINE_STRIP mesh costs a mesh build, a buffer
+// upload and a draw call per shape every frame, thousands of each for the
+// world map. MapMesh puts the points of every shape into one vertex buffer
+// and joins the consecutive points of each shape with LINES indices, so no
+// segment runs from one shape to the next. The buffers are uploaded on the
+// first draw and only again after a shape is recolored.
+//
+// Each shape keeps its range of vertices and indices, so a region can be
+// highlighted by recoloring its vertices.
+//
+// Usage:
+//   MapMesh map;
+//   map.build(shapes);              // A PolylineFile, in onCreate()
+//   map.highlight(12, Color(1, 0, 0));
+//   map.draw(g);                    // In onDraw()
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "al/graphics/al_Graphics.hpp"
+#include "al/graphics/al_VAOMesh.hpp"
+
+#include "PolylineFile.h"
+
+class MapMesh {
+public:
+  struct Range {
+    uint32_t firstVertex{0}, numVertices{0};
+    uint32_t firstIndex{0}, numIndices{0};
+  };
+
+  // Builds the mesh from every shape, all in one color
+  void build(const PolylineFile &shapes,
+             const al::Color &color = al::Color(1, 1, 1, 1)) {
+    mMesh.reset();
+    mMesh.primitive(al::Mesh::LINES);
+    mRanges.assign(shapes.size(), Range());
+    auto &vertices = mMesh.vertices();
+    auto &indices = mMesh.indices();
+    vertices.reserve(shapes.numPoints());
+    indices.reserve(2 * shapes.numPoints());
+    for (size_t s = 0; s < shapes.size(); s++) {
+      Range &range = mRanges[s];
+      range.firstVertex = uint32_t(vertices.size());
+      range.numVertices = uint32_t(shapes.shapeSize(s));
+      range.firstIndex = uint32_t(indices.size());
+      const float *xy = shapes.shape(s);
+      for (uint32_t i = 0; i < range.numVertices; i++) {
+        vertices.emplace_back(xy[2 * i], xy[2 * i + 1], 0.0f);
+        if (i > 0) {
+          indices.push_back(range.firstVertex + i - 1);
+          indices.push_back(range.firstVertex + i);
+        }
+      }
+      range.numIndices = uint32_t(indices.size()) - range.firstIndex;
+    }
+    mMesh.colors().assign(vertices.size(), color);
+    mDirty = true;
+  }
+
+  size_t numShapes() const { return mRanges.size(); }
+
+  const Range &range(size_t shape) const { return mRanges[shape]; }
+
+  // Recolors one shape. The colors are uploaded on the next draw.
+  void highlight(size_t shape, const al::Color &color) {
+    const Range &range = mRanges[shape];
+    auto &colors = mMesh.colors();
+    std::fill(colors.begin() + range.firstVertex,
+              colors.begin() + range.firstVertex + range.numVertices, color);
+    mDirty = true;
+  }
+
+  // Draws every shape with its vertex colors
+  void draw(al::Graphics &g) {
+    if (mDirty) {
+      mMesh.update();
+      mDirty = false;
+      mUploads++;
+    }
+    g.meshColor();
+    g.draw(mMesh);
+  }
+
+  // Whether the next draw uploads the buffers
+  bool dirty() const { return mDirty; }
+
+  // Number of uploads so far
+  size_t uploads() const { return mUploads; }
+
+  const al::Mesh &mesh() const { return mMesh; }
+
+private:
+  al::VAOMesh mMesh;
+  std::vector<Range> mRanges;
+  bool mDirty{false};
+  size_t mUploads{0};
+};
+
+#endif // MapMesh_H
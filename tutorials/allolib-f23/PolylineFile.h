@@ -0,0 +1,298 @@
+#pragma once
+#ifndef PolylineFile_H
+#define PolylineFile_H
+
+// Map outlines in a binary file that is memory mapped instead of parsed.
+//
+// The .dat files hold one "x,y" or "x,y,z" line per point, with each shape
+// between <coordinates> and </coordinates> lines. Reading them line by line
+// into strings and converting each field is most of a map app's startup:
+// world-administrative.dat has a few hundred thousand points. The binary
+// file holds the same shapes as the floats they end up as:
+//
+//   uint32 magic ("PLY2"), version, number of shapes, number of points
+//   uint64 size and modification time (seconds) of the .dat file
+//   uint32 offsets[shapes + 1]   first point of each shape, then the total
+//   float  points[points][2]     x and y, shapes one after the other
+//
+// Numbers are in the host's byte order (little endian on every platform the
+// apps run on). z is dropped, it is 0 in the map files.
+//
+// open() maps the file and checks that the header and table fit in it and
+// that the offsets never decrease or pass the number of points. The points
+// are then read straight from the mapping, with no copy. load() converts the
+// text file when there is no binary file yet, or when the size or time of
+// the text file no longer match the ones in the binary file, and writes the
+// binary file next to it. polyline_convert.cpp converts files ahead of time.
+//
+// Usage:
+//   PolylineFile shapes;
+//   shapes.load("../united_states.dat", "../united_states.polylines");
+//   for (size_t s = 0; s < shapes.size(); s++) {
+//     const float *xy = shapes.shape(s);
+//     for (size_t i = 0; i < shapes.shapeSize(s); i++) {
+//       mesh.vertex(xy[2 * i], xy[2 * i + 1]);
+//     }
+//   }
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class PolylineFile {
+public:
+  static const uint32_t magic = 0x32594c50; // "PLY2"
+  static const uint32_t version = 2;
+
+  PolylineFile() {}
+  PolylineFile(const PolylineFile &) = delete;
+  PolylineFile &operator=(const PolylineFile &) = delete;
+  ~PolylineFile() { close(); }
+
+  // Maps a binary file. Returns false if it can't be read or isn't one.
+  bool open(const std::string &path) {
+    close();
+    if (!map(path)) {
+      return false;
+    }
+    const uint32_t *header = static_cast<const uint32_t *>(mData);
+    if (mBytes < headerSize * sizeof(uint32_t) || header[0] != magic ||
+        header[1] != version) {
+      close();
+      return false;
+    }
+    uint64_t shapes = header[2], points = header[3];
+    uint64_t needed = headerSize * sizeof(uint32_t) +
+                      (shapes + 1) * sizeof(uint32_t) +
+                      points * 2 * sizeof(float);
+    mOffsets = header + headerSize;
+    if (needed > mBytes || mOffsets[shapes] != points) {
+      close();
+      return false;
+    }
+    // Shapes must lie within the points, one after the other
+    for (uint64_t s = 0; s < shapes; s++) {
+      if (mOffsets[s] > mOffsets[s + 1]) {
+        close();
+        return false;
+      }
+    }
+    mShapes = size_t(shapes);
+    mPoints = reinterpret_cast<const float *>(mOffsets + shapes + 1);
+    return true;
+  }
+
+  // Opens binaryPath, converting textPath into it first if that fails or
+  // binaryPath was converted from another version of textPath
+  bool load(const std::string &textPath, const std::string &binaryPath) {
+    if (open(binaryPath) && upToDate(textPath)) {
+      return true;
+    }
+    close();
+    return convert(textPath, binaryPath) && open(binaryPath);
+  }
+
+  // Whether the open file was converted from textPath as it is now. True if
+  // textPath can't be read, e.g. when only the binary file was shipped.
+  bool upToDate(const std::string &textPath) const {
+    uint64_t size, time;
+    if (!mData || !stamp(textPath, size, time)) {
+      return mData != nullptr;
+    }
+    const uint32_t *header = static_cast<const uint32_t *>(mData);
+    return header[4] == uint32_t(size) && header[5] == uint32_t(size >> 32) &&
+           header[6] == uint32_t(time) && header[7] == uint32_t(time >> 32);
+  }
+
+  void close() {
+    if (mData) {
+#ifdef _WIN32
+      UnmapViewOfFile(mData);
+#else
+      munmap(const_cast<void *>(mData), mBytes);
+#endif
+    }
+    mData = nullptr;
+    mBytes = 0;
+    mShapes = 0;
+    mOffsets = nullptr;
+    mPoints = nullptr;
+  }
+
+  // Number of shapes
+  size_t size() const { return mShapes; }
+
+  size_t numPoints() const { return mShapes ? mOffsets[mShapes] : 0; }
+
+  // x and y of each point of shape s
+  const float *shape(size_t s) const { return mPoints + 2 * mOffsets[s]; }
+
+  size_t shapeSize(size_t s) const { return mOffsets[s + 1] - mOffsets[s]; }
+
+  // Points of all shapes, and the first point of each shape then the total
+  const float *points() const { return mPoints; }
+  const uint32_t *offsets() const { return mOffsets; }
+
+  // Parses a .dat file into x, y pairs and shape offsets. Returns false if
+  // it can't be read.
+  static bool parse(const std::string &textPath, std::vector<float> &points,
+                    std::vector<uint32_t> &offsets) {
+    std::FILE *file = std::fopen(textPath.c_str(), "rb");
+    if (!file) {
+      return false;
+    }
+    std::string text;
+    char buffer[1 << 16];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      text.append(buffer, read);
+    }
+    std::fclose(file);
+
+    points.clear();
+    offsets.assign(1, 0);
+    const char *c = text.c_str();
+    const char *end = c + text.size();
+    while (c < end) {
+      const char *lineEnd = static_cast<const char *>(
+          std::memchr(c, '\n', size_t(end - c)));
+      if (!lineEnd) {
+        lineEnd = end;
+      }
+      if (*c == '<') {
+        // Only the closing tag ends a shape
+        if (c[1] == '/') {
+          offsets.push_back(uint32_t(points.size() / 2));
+        }
+      } else if (c < lineEnd && *c != '\r') {
+        char *next;
+        float x = std::strtof(c, &next);
+        float y = std::strtof(next + 1, &next);
+        points.push_back(x);
+        points.push_back(y);
+      }
+      c = lineEnd + 1;
+    }
+    return true;
+  }
+
+  // Converts a .dat file to the binary format
+  static bool convert(const std::string &textPath,
+                      const std::string &binaryPath) {
+    std::vector<float> points;
+    std::vector<uint32_t> offsets;
+    uint64_t size, time;
+    if (!stamp(textPath, size, time) || !parse(textPath, points, offsets)) {
+      return false;
+    }
+    // Points after the last closing tag don't belong to a shape
+    points.resize(2 * size_t(offsets.back()));
+    std::FILE *file = std::fopen(binaryPath.c_str(), "wb");
+    if (!file) {
+      return false;
+    }
+    uint32_t header[headerSize] = {magic,
+                                   version,
+                                   uint32_t(offsets.size() - 1),
+                                   offsets.back(),
+                                   uint32_t(size),
+                                   uint32_t(size >> 32),
+                                   uint32_t(time),
+                                   uint32_t(time >> 32)};
+    bool ok =
+        std::fwrite(header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), file) ==
+            offsets.size() &&
+        std::fwrite(points.data(), sizeof(float), points.size(), file) ==
+            points.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+      std::remove(binaryPath.c_str());
+    }
+    return ok;
+  }
+
+private:
+  static const int headerSize = 8; // In uint32s
+
+  // Size and modification time of a file. Returns false if there is none.
+  static bool stamp(const std::string &path, uint64_t &size, uint64_t &time) {
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(path.c_str(), &info) != 0) {
+      return false;
+    }
+#else
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0) {
+      return false;
+    }
+#endif
+    size = uint64_t(info.st_size);
+    time = uint64_t(info.st_mtime);
+    return true;
+  }
+
+  bool map(const std::string &path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (!mapping) {
+      return false;
+    }
+    mData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    mBytes = mData ? size_t(size.QuadPart) : 0;
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+      return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+      void *data =
+          mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+      if (data != MAP_FAILED) {
+        mData = data;
+        mBytes = size_t(info.st_size);
+      }
+    }
+    ::close(file);
+#endif
+    return mData != nullptr;
+  }
+
+  const void *mData{nullptr};
+  size_t mBytes{0};
+  size_t mShapes{0};
+  const uint32_t *mOffsets{nullptr};
+  const float *mPoints{nullptr};
+};
+
+#endif // PolylineFile_H
@@ -0,0 +1,445 @@
+#pragma once
+#ifndef QuakeFeed_H
+#define QuakeFeed_H
+
+// Earthquakes read from a GeoJSON feed while it arrives, as notes.
+//
+// get_earthquakes.py fetches the USGS feed, scales every quake against the
+// whole month and prints an earthquakes.synthSequence, which the apps load
+// at once with playSequence(). A live feed never ends, so nothing can wait
+// for the whole of it:
+//
+//  - QuakeReader parses the bytes as they come, in chunks of any size, and
+//    hands over each feature as soon as its closing brace is read. It keeps
+//    only the object nesting and the current token, never the document.
+//    A FeatureCollection (as the USGS sends) and one feature per line both
+//    work.
+//  - QuakeScale does the script's scaleX() against the smallest and
+//    largest magnitude and longitude seen so far. Times can't be scaled
+//    that way: the feed is sorted by time, so every quake would be the
+//    newest or oldest so far and start at the same end of the range.
+//    Instead each quake starts 1 s plus its distance in time from the
+//    first quake, with the feed's span (a month, as the script fetches)
+//    played in 59 s. Newest first and oldest first feeds both spread out.
+//  - QuakeFeed runs both on a thread reading a file or a pipe ("-" is
+//    stdin), into a ring of notes. The thread waits when the ring is full,
+//    so a feed of any length is held in a fixed amount of memory. The app
+//    takes notes from it each frame, only those starting within a short
+//    lookahead, and adds them to its SynthSequencer. Notes further ahead
+//    stay in the ring, so a feed read faster than it plays fills the ring
+//    and the thread waits instead of the sequencer growing.
+//
+// quake_feed_sim.cpp writes a stand-in feed, at once or paced like a live
+// one. quake_feed_bench.cpp measures how fast it is read.
+//
+// Usage:
+//   QuakeFeed feed;
+//   feed.start("earthquakes.geojson");        // In onCreate()
+//   std::vector<QuakeNote> notes;
+//   feed.poll(notes, 64, time + lookahead);   // In onAnimate()
+//   for (auto &note : notes) { ... addVoiceFromNow(...) ... }
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Quake {
+  double time{0}; // Milliseconds since 1970, as the USGS gives it
+  float magnitude{0};
+  float longitude{0}, latitude{0}, depth{0};
+};
+
+// A SineEnv note for one quake, as get_earthquakes.py prints it
+struct QuakeNote {
+  float start{0}, duration{0}; // Seconds
+  float amplitude{0}, frequency{0}, attackTime{0.01f}, releaseTime{1.0f};
+  float pan{0}, x{0}, y{0};
+};
+
+class QuakeReader {
+public:
+  QuakeReader() { mStack.reserve(16); }
+
+  // Parses the next size bytes of the feed, calling event(const Quake &)
+  // for every feature completed in them
+  template <class Event>
+  void parse(const char *data, size_t size, Event &&event) {
+    mBytes += size;
+    for (const char *c = data, *end = data + size; c < end; c++) {
+      if (mInString) {
+        if (mEscape) {
+          mEscape = false;
+          push(*c);
+        } else if (*c == '\\') {
+          mEscape = true;
+        } else if (*c == '"') {
+          mInString = false;
+          endString();
+        } else {
+          push(*c);
+        }
+        continue;
+      }
+      if (mInLiteral) {
+        if (isLiteral(*c)) {
+          push(*c);
+          continue;
+        }
+        mInLiteral = false;
+        endLiteral();
+      }
+      switch (*c) {
+      case '"':
+        mInString = true;
+        mTokenSize = 0;
+        break;
+      case '{':
+        mStack.push_back(Frame{true, {0}, 0});
+        mExpectKey = true;
+        break;
+      case '[':
+        mStack.push_back(Frame{false, {0}, 0});
+        mExpectKey = false;
+        break;
+      case '}':
+      case ']':
+        close(event);
+        break;
+      case ',':
+        if (!mStack.empty()) {
+          mStack.back().index++;
+          mExpectKey = mStack.back().object;
+        }
+        break;
+      case ':':
+        mExpectKey = false;
+        break;
+      default:
+        if (isLiteral(*c)) {
+          mInLiteral = true;
+          mTokenSize = 0;
+          push(*c);
+        }
+      }
+    }
+  }
+
+  // Reads the file to its end in chunks. Returns false on a read error.
+  template <class Event> bool read(std::FILE *file, Event &&event) {
+    char buffer[1 << 16];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      parse(buffer, read, event);
+    }
+    return !std::ferror(file);
+  }
+
+  // Bytes parsed, features passed on, and features without a magnitude,
+  // time or position
+  size_t bytes() const { return mBytes; }
+  size_t features() const { return mFeatures; }
+  size_t skipped() const { return mSkipped; }
+
+private:
+  enum Field { MAGNITUDE = 1, TIME = 2, LONGITUDE = 4, LATITUDE = 8 };
+  static const unsigned int complete = MAGNITUDE | TIME | LONGITUDE | LATITUDE;
+
+  struct Frame {
+    bool object;
+    char key[16]; // The key being read in an object, cut short
+    int index;    // Position in an array
+  };
+
+  static bool isLiteral(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+           (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+  }
+
+  void push(char c) {
+    if (mTokenSize < sizeof(mToken) - 1) {
+      mToken[mTokenSize++] = c;
+    }
+  }
+
+  bool key(const char *name) const {
+    return std::strcmp(mStack.back().key, name) == 0;
+  }
+
+  void endString() {
+    if (mStack.empty() || !mStack.back().object || !mExpectKey) {
+      return; // A string value, none of which are needed
+    }
+    size_t size = std::min(mTokenSize, sizeof(Frame::key) - 1);
+    std::memcpy(mStack.back().key, mToken, size);
+    mStack.back().key[size] = 0;
+    // The object holding these is a feature
+    if (key("properties") || key("geometry")) {
+      mFeatureDepth = int(mStack.size()) - 1;
+    }
+  }
+
+  void endLiteral() {
+    mToken[mTokenSize] = 0;
+    char *end;
+    double value = std::strtod(mToken, &end);
+    if (end == mToken || mStack.empty()) {
+      return; // null, true or false
+    }
+    Frame &frame = mStack.back();
+    if (frame.object) {
+      if (key("mag")) {
+        mQuake.magnitude = float(value);
+        mHave |= MAGNITUDE;
+      } else if (key("time")) {
+        mQuake.time = value;
+        mHave |= TIME;
+      }
+    } else if (mStack.size() > 1 &&
+               std::strcmp(mStack[mStack.size() - 2].key, "coordinates") ==
+                   0) {
+      if (frame.index == 0) {
+        mQuake.longitude = float(value);
+        mHave |= LONGITUDE;
+      } else if (frame.index == 1) {
+        mQuake.latitude = float(value);
+        mHave |= LATITUDE;
+      } else if (frame.index == 2) {
+        mQuake.depth = float(value);
+      }
+    }
+  }
+
+  template <class Event> void close(Event &event) {
+    if (mStack.empty()) {
+      return;
+    }
+    mStack.pop_back();
+    if (int(mStack.size()) != mFeatureDepth) {
+      return;
+    }
+    if ((mHave & complete) == complete) {
+      mFeatures++;
+      event(static_cast<const Quake &>(mQuake));
+    } else {
+      mSkipped++;
+    }
+    mQuake = Quake();
+    mHave = 0;
+    mFeatureDepth = -1;
+  }
+
+  std::vector<Frame> mStack;
+  char mToken[64];
+  size_t mTokenSize{0};
+  bool mInString{false}, mEscape{false}, mInLiteral{false};
+  bool mExpectKey{false};
+  int mFeatureDepth{-1};
+  Quake mQuake;
+  unsigned int mHave{0};
+  size_t mBytes{0}, mFeatures{0}, mSkipped{0};
+};
+
+class QuakeScale {
+public:
+  // spanDays of feed time play in 59 s
+  explicit QuakeScale(double spanDays = 30)
+      : mSpan(spanDays > 0 ? spanDays * 24 * 60 * 60 * 1000 : 1) {}
+
+  // The note for a quake, scaled against every quake up to and including
+  // it. The first one plays at 1 s and at the bottom of each range.
+  QuakeNote note(const Quake &quake) {
+    if (!mStarted) {
+      mStarted = true;
+      mFirstTime = quake.time;
+    }
+    mMagnitudes.add(quake.magnitude);
+    mLongitudes.add(quake.longitude);
+    QuakeNote note;
+    note.start = float(1 + 59 * std::abs(quake.time - mFirstTime) / mSpan);
+    note.duration = float(mMagnitudes.scale(quake.magnitude, 0.1, 2.0));
+    note.amplitude = float(mMagnitudes.scale(quake.magnitude, 0.01, 0.1));
+    note.frequency = float(mMagnitudes.scale(quake.magnitude, 110, 880));
+    note.pan = float(mLongitudes.scale(quake.longitude, -1, 1));
+    note.x = quake.longitude;
+    note.y = quake.latitude;
+    return note;
+  }
+
+private:
+  struct Range {
+    double min{std::numeric_limits<double>::max()};
+    double max{std::numeric_limits<double>::lowest()};
+
+    void add(double x) {
+      min = x < min ? x : min;
+      max = x > max ? x : max;
+    }
+
+    // scaleX() from get_earthquakes.py
+    double scale(double x, double minScale, double maxScale) const {
+      if (max <= min) {
+        return minScale;
+      }
+      return minScale + (maxScale - minScale) * (x - min) / (max - min);
+    }
+  };
+
+  double mSpan; // Milliseconds
+  bool mStarted{false};
+  double mFirstTime{0};
+  Range mMagnitudes, mLongitudes;
+};
+
+class QuakeFeed {
+public:
+  // capacity is the most notes held between the thread and the app
+  explicit QuakeFeed(size_t capacity = 4096) : mRing(capacity ? capacity : 1) {}
+  QuakeFeed(const QuakeFeed &) = delete;
+  QuakeFeed &operator=(const QuakeFeed &) = delete;
+  ~QuakeFeed() { stop(); }
+
+  // Starts reading path, or stdin for "-". Returns false if it can't be
+  // opened.
+  bool start(const std::string &path) {
+    stop();
+    std::FILE *file = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+    if (!file) {
+      return false;
+    }
+    mStop = false;
+    mDone = false;
+    mError.clear();
+    mThread = std::thread([this, file, path]() { run(file, path); });
+    return true;
+  }
+
+  // Stops the thread. It finishes the chunk it is reading first, which on
+  // a pipe lasts until the writer sends more or closes it.
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mNotFull.notify_all();
+    if (mThread.joinable()) {
+      mThread.join();
+    }
+  }
+
+  // Moves up to max notes into notes, in the order they were read, up to
+  // the first one that starts after until (in seconds). Notes are read in
+  // start order, as the feed is sorted by time. Returns the number moved.
+  size_t poll(std::vector<QuakeNote> &notes, size_t max,
+              double until = std::numeric_limits<double>::infinity()) {
+    notes.clear();
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      while (mSize > 0 && notes.size() < max && mRing[mHead].start <= until) {
+        notes.push_back(mRing[mHead]);
+        mHead = (mHead + 1) % mRing.size();
+        mSize--;
+      }
+    }
+    if (!notes.empty()) {
+      mNotFull.notify_one();
+    }
+    return notes.size();
+  }
+
+  // Whether the feed has ended and every note has been polled
+  bool done() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDone && mSize == 0;
+  }
+
+  // Notes read and not yet polled
+  size_t queued() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSize;
+  }
+
+  // Quakes read, bytes read and seconds spent reading, so far
+  size_t quakes() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mQuakes;
+  }
+  size_t bytes() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mBytes;
+  }
+  double seconds() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSeconds;
+  }
+
+  // Why reading stopped early, empty if it didn't
+  std::string error() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mError;
+  }
+
+  size_t capacity() const { return mRing.size(); }
+
+private:
+  void run(std::FILE *file, const std::string &path) {
+    auto begin = std::chrono::steady_clock::now();
+    QuakeReader reader;
+    QuakeScale scale;
+    char buffer[1 << 16];
+    size_t read = 0;
+    bool stopped = false;
+    while (!stopped &&
+           (read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      reader.parse(buffer, read, [&](const Quake &quake) {
+        QuakeNote note = scale.note(quake);
+        std::unique_lock<std::mutex> lock(mMutex);
+        mNotFull.wait(lock, [&]() { return mStop || mSize < mRing.size(); });
+        if (mStop) {
+          stopped = true;
+          return;
+        }
+        mRing[(mHead + mSize) % mRing.size()] = note;
+        mSize++;
+        mQuakes++;
+      });
+      std::lock_guard<std::mutex> lock(mMutex);
+      mBytes = reader.bytes();
+      mSeconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - begin)
+                     .count();
+      stopped = stopped || mStop;
+    }
+    bool failed = std::ferror(file) != 0;
+    int error = errno;
+    if (file != stdin) {
+      std::fclose(file);
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (failed) {
+      mError = "Could not read " + path + ": " + std::strerror(error);
+    }
+    mDone = true;
+  }
+
+  std::vector<QuakeNote> mRing;
+  size_t mHead{0}, mSize{0};
+  std::mutex mMutex;
+  std::condition_variable mNotFull;
+  std::thread mThread;
+  bool mStop{false}, mDone{false};
+  size_t mQuakes{0}, mBytes{0};
+  double mSeconds{0};
+  std::string mError;
+};
+
+#endif // QuakeFeed_H
@@ -1,4 +1,5 @@
 ﻿#include <cstdio> // for printing to stdout
+#include <iostream>
 
 #include "Gamma/Analysis.h"
 #include "Gamma/Effects.h"
@@ -14,6 +15,10 @@
 
 #include "al/graphics/al_Font.hpp" // for text rendering
 
+#include "AxisMesh.h"
+#include "MapMesh.h"
+#include "PolylineFile.h"
+
 // using namespace gam;
 using namespace al;
 
@@ -25,7 +30,7 @@ float globalWidth = 1.0;
 // define the synth's voice parameters and the sound and graphic generation
 // processes in the onProcess() functions.
 
-std::vector<std::vector<Vec3f>> points;
+PolylineFile points; // Map shapes, see readPoints()
 
 const float xScale = 180.0;
 const float yScale = 90.0;
@@ -146,8 +151,9 @@ public:
 class MyApp : public App
 {
 public:
-  Mesh xAxis;
-  Mesh yAxis;
+  AxisMesh xAxis{AxisMesh::X, Color(1, 1, 0)};
+  AxisMesh yAxis{AxisMesh::Y, Color(0, 1, 1)};
+  MapMesh mapMesh; // Every shape in points, built once
 
  // this font is for rendering text labels on the axes
     FontRenderer fontRender;
@@ -168,6 +174,7 @@ public:
   
 
     fontRender.load(Font::defaultFont().c_str(), 60, 1024);
+    mapMesh.build(points);
 
     navControl().active(false); // Disable navigation via keyboard, since we
                                 // will be using keyboard for note triggering
@@ -265,41 +272,9 @@ public:
 
   void onExit() override { imguiShutdown(); }
 
-  void drawLabelX(Graphics &g, float x, float labelOffset, float fontSize)
-  {
-    std::ostringstream oss;
-    oss << std::fixed << std::showpoint;
-    oss << std::setprecision(1);
-    oss << "x=" << x;
-    fontRender.alignCenter(); // makes the text centered around the position
-    fontRender.write(oss.str().c_str(), fontSize);
-    fontRender.renderAt(g, {x, labelOffset, 0.0});
-  }
-
-  void drawLabelY(Graphics &g, float y, float labelOffset, float fontSize)
-  {
-    std::ostringstream oss;
-    oss << std::fixed << std::showpoint;
-    oss << std::setprecision(1);
-    oss << "y=" << y;
-    fontRender.alignLeft(); // makes the text centered around the position
-    fontRender.write(oss.str().c_str(), fontSize);
-    fontRender.renderAt(g, {labelOffset, y - (fontSize * 0.2), 0.0});
-  }
-
   void drawWorldMap(Graphics &g)
   {
-    for (auto shape : points)
-    {
-      Mesh m;
-      m.primitive(Mesh::LINE_STRIP);
-      for (auto p : shape)
-      {
-        m.vertex(p);
-      }
-      g.color(1, 1, 1);
-      g.draw(m);
-    }
+    mapMesh.draw(g);
   }
 
   void drawXAxis(Graphics &g,
@@ -310,35 +285,8 @@ public:
                  float labelOffset,
                  float fontSize)
   {
-    xAxis.primitive(Mesh::LINE_STRIP);
-
-    // Create x and y axes
-    xAxis.vertex(minX, 0);
-    xAxis.vertex(maxX, 0);
-
-    // Create the X tick marks and labels
-
-    for (float x = 0; x < maxX; x += tickIncrement)
-    {
-      xAxis.vertex(x, 0);
-      xAxis.vertex(x, tickSize);
-      xAxis.vertex(x, -tickSize);
-      xAxis.vertex(x, 0);
-      drawLabelX(g, x, labelOffset, fontSize);
-    }
-
-    for (float x = 0; x >= minX; x -= tickIncrement)
-    {
-      xAxis.vertex(x, 0);
-      xAxis.vertex(x, tickSize);
-      xAxis.vertex(x, -tickSize);
-      xAxis.vertex(x, 0);
-      drawLabelX(g, x, labelOffset, fontSize);
-    }
-
-    //  Draw the axis
-    g.color(1, 1, 0);
-    g.draw(xAxis);
+    xAxis.draw(g, fontRender, minX, maxX, tickIncrement, tickSize,
+               labelOffset, fontSize);
   }
 
   void drawYAxis(Graphics &g,
@@ -349,86 +297,25 @@ public:
                  float labelOffset,
                  float fontSize)
   {
-    yAxis.primitive(Mesh::LINE_STRIP);
-
-    yAxis.vertex(0, minY);
-    yAxis.vertex(0, maxY);
-
-    // Create the Y tick marks and labels
-
-
-    for (float y = 0; y <= maxY; y += tickIncrement)
-    {
-
-      yAxis.vertex(0, y);
-      yAxis.vertex(tickSize, y);
-      yAxis.vertex(-tickSize, y);
-      yAxis.vertex(0, y);
-      g.color(1, 1, 1);
-
-      drawLabelY(g, y, labelOffset, fontSize);
-    }
-
-
-    for (float y = 0; y >= minY; y -= tickIncrement)
-    {
-      yAxis.vertex(0, y);
-      yAxis.vertex(tickSize, y);
-      yAxis.vertex(-tickSize, y);
-      yAxis.vertex(0, y);
-      g.color(1, 1, 1);
-      drawLabelY(g, y, labelOffset, fontSize);
-    }
-
-    //  Draw the Y Axis
-
-    g.color(0, 1, 1);
-    g.draw(yAxis);
-
+    yAxis.draw(g, fontRender, minY, maxY, tickIncrement, tickSize,
+               labelOffset, fontSize);
   }
 };
 
-std::vector<std::string> split(const std::string &s, char delim)
-{
-  std::vector<std::string> result;
-  std::stringstream ss(s);
-  std::string item;
-
-  while (getline(ss, item, delim))
-  {
-    result.push_back(item);
-  }
-
-  return result;
-}
-
 void readPoints()
 {
   // file is taken from KML file with only the <coordinates> sections pulled out
   // and then the <coordinates> open/close tags put on their own lines
   // and each pair of x,y put on a separate line
+  //
+  // The first run converts it to a binary file next to it, which later
+  // runs map instead of parsing (see PolylineFile.h).
 
-  std::ifstream infile("../world-administrative.dat");
-  std::string line;
-  std::vector<Vec3f> thisShape;
-
-  while (std::getline(infile, line))
+  if (!points.load("../world-administrative.dat",
+                   "../world-administrative.polylines"))
   {
-    if (line == "<coordinates>")
-      continue;
-    if (line == "</coordinates>")
-    {
-      points.push_back(thisShape);
-      thisShape.clear();
-      continue;
-    }
-
-    auto parts = split(line, ',');
-    float x = std::stof(parts[0]);
-    float y = std::stof(parts[1]);
-    thisShape.push_back(Vec3f(x, y, 0.0f));
+    std::cerr << "Could not read ../world-administrative.dat" << std::endl;
   }
-  infile.close();
 }
 
 int main()
@@ -6,8 +6,12 @@
 
 # To use, do:
 # python3 tutorials/allolib-f23/get_earthquakes.py > tutorials/synthesis/bin/SineEnv-data/earthquakes.synthSequence
+#
+# Or, to save the feed itself for world_map_earthquakesv2 to stream (see QuakeFeed.h):
+# python3 tutorials/allolib-f23/get_earthquakes.py --geojson > earthquakes.geojson
 
 
+import sys
 import requests
 from pprint import pprint
 from datetime import datetime, timedelta
@@ -62,7 +66,9 @@ parameters = {
 response = requests.get(base_url, params=parameters)
 
 # Check if the request was successful
-if response.status_code == 200:
+if response.status_code == 200 and '--geojson' in sys.argv:
+    print(response.text)
+elif response.status_code == 200:
     data = response.json()
     #pprint(data, indent=4)
     # Extract and print earthquake information
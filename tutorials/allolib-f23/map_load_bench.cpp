@@ -0,0 +1,126 @@
+// Startup time of the map apps' shape loading
+//
+// Loads a map .dat file the ways the apps can:
+//  - "text": std::getline, split() through a std::stringstream and
+//    std::stof, into a std::vector per shape, as readPoints() used to do,
+//  - "parse": PolylineFile::parse(), the one-pass parser that converts the
+//    text on the first run,
+//  - "binary": PolylineFile::open() on the converted file, reading every
+//    point once so the mapped pages are actually touched.
+// The binary file is written next to the input first. All paths read from
+// the file cache after the first run, so this measures parsing, not disk.
+//
+// Usage (from the bin folder):
+//   map_load_bench [file.dat] [runs]
+//
+//   file.dat  map to load (default: ../united_states.dat)
+//   runs      loads per path, averaged (default: 20)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "al/math/al_Vec.hpp"
+
+#include "PolylineFile.h"
+
+using namespace al;
+
+// The old readPoints(), returning the number of points
+std::vector<std::string> split(const std::string &s, char delim) {
+  std::vector<std::string> result;
+  std::stringstream ss(s);
+  std::string item;
+  while (getline(ss, item, delim)) {
+    result.push_back(item);
+  }
+  return result;
+}
+
+size_t readText(const std::string &path) {
+  std::vector<std::vector<Vec3f>> points;
+  std::ifstream infile(path);
+  std::string line;
+  std::vector<Vec3f> thisShape;
+  size_t count = 0;
+  while (std::getline(infile, line)) {
+    if (line == "<coordinates>")
+      continue;
+    if (line == "</coordinates>") {
+      count += thisShape.size();
+      points.push_back(thisShape);
+      thisShape.clear();
+      continue;
+    }
+    auto parts = split(line, ',');
+    float x = std::stof(parts[0]);
+    float y = std::stof(parts[1]);
+    thisShape.push_back(Vec3f(x, y, 0.0f));
+  }
+  return count;
+}
+
+template <class Load> double loadTime(int runs, Load load) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < runs; r++) {
+    load();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         runs;
+}
+
+int main(int argc, char *argv[]) {
+  std::string path = argc > 1 ? argv[1] : "../united_states.dat";
+  int runs = argc > 2 ? std::max(1, std::stoi(argv[2])) : 20;
+  std::string binaryPath = path + ".polylines";
+  if (!PolylineFile::convert(path, binaryPath)) {
+    std::cerr << "Could not convert " << path << std::endl;
+    return 1;
+  }
+
+  size_t points = 0;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Milliseconds per load of " << path << std::endl << std::endl;
+  std::cout << std::setw(8) << "path" << std::setw(12) << "time"
+            << std::setw(12) << "points" << std::endl;
+
+  double text = loadTime(runs, [&]() { points = readText(path); });
+  std::cout << std::setw(8) << "text" << std::setw(12) << text
+            << std::setw(12) << points << std::endl;
+
+  double parse = loadTime(runs, [&]() {
+    std::vector<float> xy;
+    std::vector<uint32_t> offsets;
+    PolylineFile::parse(path, xy, offsets);
+    points = offsets.back();
+  });
+  std::cout << std::setw(8) << "parse" << std::setw(12) << parse
+            << std::setw(12) << points << std::endl;
+
+  float sum = 0;
+  double binary = loadTime(runs, [&]() {
+    PolylineFile shapes;
+    shapes.open(binaryPath);
+    const float *xy = shapes.points();
+    for (size_t i = 0; i < 2 * shapes.numPoints(); i++) {
+      sum += xy[i];
+    }
+    points = shapes.numPoints();
+  });
+  std::cout << std::setw(8) << "binary" << std::setw(12) << binary
+            << std::setw(12) << points << std::endl;
+  std::cout << std::endl
+            << "binary is " << std::setprecision(0) << text / binary
+            << " times faster than text (checksum " << sum << ")"
+            << std::endl;
+  std::remove(binaryPath.c_str());
+  return 0;
+}
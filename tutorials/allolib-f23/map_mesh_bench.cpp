@@ -0,0 +1,126 @@
+// Per-frame cost of drawing the map apps' outlines
+//
+// Draws a map file without a window, counting what each frame would send
+// to the GPU:
+//  - "shapes": a LINE_STRIP Mesh built per shape every frame, as
+//    drawWorldMap() used to do. Each g.draw() of a Mesh uploads it, so a
+//    frame is one draw call and one upload per shape.
+//  - "baked": MapMesh, built once and uploaded on the first frame. Later
+//    frames are one draw call and no upload.
+//  - "highlight": MapMesh with one shape recolored every frame, which
+//    uploads the whole mesh again on the next draw.
+// Build is the one-time cost, frame the CPU time of a frame before the
+// draw calls themselves.
+//
+// Usage (from the bin folder):
+//   map_mesh_bench [file.dat] [frames]
+//
+//   file.dat  map to draw (default: ../united_states.dat)
+//   frames    frames per path, averaged (default: 100)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "al/graphics/al_Mesh.hpp"
+
+#include "MapMesh.h"
+#include "PolylineFile.h"
+
+using namespace al;
+
+struct Frame {
+  double ms{0};
+  size_t draws{0}, uploads{0}, bytes{0};
+};
+
+template <class Draw> Frame frameTime(int frames, Draw draw) {
+  Frame frame;
+  auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; f++) {
+    draw(frame);
+  }
+  frame.ms = std::chrono::duration<double, std::milli>(
+                 std::chrono::steady_clock::now() - start)
+                 .count() /
+             frames;
+  frame.draws /= frames;
+  frame.uploads /= frames;
+  frame.bytes /= frames;
+  return frame;
+}
+
+// Bytes of every attribute and index buffer of a mesh
+size_t meshBytes(const Mesh &m) {
+  return m.vertices().size() * sizeof(Vec3f) +
+         m.colors().size() * sizeof(Color) +
+         m.indices().size() * sizeof(unsigned int);
+}
+
+void print(const char *name, double build, const Frame &frame) {
+  std::cout << std::setw(10) << name << std::setw(10) << build
+            << std::setw(10) << frame.ms << std::setw(8) << frame.draws
+            << std::setw(9) << frame.uploads << std::setw(11)
+            << frame.bytes / 1024 << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  std::string path = argc > 1 ? argv[1] : "../united_states.dat";
+  int frames = argc > 2 ? std::max(1, std::stoi(argv[2])) : 100;
+  std::string binaryPath = path + ".polylines";
+  PolylineFile points;
+  if (!points.load(path, binaryPath)) {
+    std::cerr << "Could not read " << path << std::endl;
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << points.size() << " shapes, " << points.numPoints()
+            << " points from " << path << std::endl
+            << std::endl;
+  std::cout << std::setw(10) << "path" << std::setw(10) << "build ms"
+            << std::setw(10) << "frame ms" << std::setw(8) << "draws"
+            << std::setw(9) << "uploads" << std::setw(11) << "KB/frame"
+            << std::endl;
+
+  Frame shapes = frameTime(frames, [&](Frame &frame) {
+    for (size_t s = 0; s < points.size(); s++) {
+      Mesh m;
+      m.primitive(Mesh::LINE_STRIP);
+      const float *xy = points.shape(s);
+      for (size_t i = 0; i < points.shapeSize(s); i++) {
+        m.vertex(xy[2 * i], xy[2 * i + 1]);
+      }
+      frame.draws++;
+      frame.uploads++;
+      frame.bytes += meshBytes(m);
+    }
+  });
+  print("shapes", 0, shapes);
+
+  MapMesh map;
+  Frame build = frameTime(1, [&](Frame &) { map.build(points); });
+  // The first frame uploads the mesh, every later one only draws it
+  Frame baked = frameTime(frames, [&](Frame &frame) { frame.draws++; });
+  print("baked", build.ms, baked);
+
+  size_t s = 0;
+  Frame highlight = frameTime(frames, [&](Frame &frame) {
+    map.highlight(s, Color(1, 0, 0));
+    map.highlight((s + points.size() - 1) % points.size(), Color(1, 1, 1));
+    s = (s + 1) % points.size();
+    frame.draws++;
+    frame.uploads += map.dirty();
+    frame.bytes += map.dirty() ? meshBytes(map.mesh()) : 0;
+  });
+  print("highlight", build.ms, highlight);
+
+  std::cout << std::endl
+            << "baked: one upload of " << meshBytes(map.mesh()) / 1024
+            << " KB, then " << shapes.draws << " times fewer draw calls"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,51 @@
+// Converts map .dat files to the binary format of PolylineFile.h
+//
+// The map apps convert their .dat file on the first run anyway. This does it
+// ahead of time, for example to ship the binary file with an installation.
+//
+// Usage (from the bin folder):
+//   polyline_convert <input.dat> [output.polylines]
+//
+//   output  defaults to the input path with its extension replaced
+
+#include <iostream>
+#include <string>
+
+#include "PolylineFile.h"
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: polyline_convert <input.dat> [output.polylines]"
+              << std::endl;
+    return 1;
+  }
+  std::string input = argv[1];
+  std::string output;
+  if (argc > 2) {
+    output = argv[2];
+  } else {
+    size_t dot = input.find_last_of('.');
+    size_t slash = input.find_last_of("/\\");
+    if (dot != std::string::npos &&
+        (slash == std::string::npos || dot > slash)) {
+      output = input.substr(0, dot);
+    } else {
+      output = input;
+    }
+    output += ".polylines";
+  }
+
+  if (!PolylineFile::convert(input, output)) {
+    std::cerr << "Could not convert " << input << " to " << output
+              << std::endl;
+    return 1;
+  }
+  PolylineFile shapes;
+  if (!shapes.open(output)) {
+    std::cerr << "Could not read back " << output << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << shapes.size() << " shapes, " << shapes.numPoints()
+            << " points to " << output << std::endl;
+  return 0;
+}
@@ -0,0 +1,121 @@
+// Ingestion throughput of QuakeFeed.h
+//
+// Reads an earthquake feed the ways the apps can:
+//  - "reader": QuakeReader and QuakeScale on this thread, in 64 KB chunks,
+//  - "feed": QuakeFeed's thread, with this thread taking up to 64 notes at
+//    a time out of its ring, as an app does each frame.
+// "held" is the most notes waiting in the ring at once, which stays at or
+// under its capacity however long the feed is. The reader pass also checks
+// that the notes' start times spread out, which they must whichever way the
+// feed is sorted (quake_feed_sim writes newest first, as the USGS does).
+// Write a feed first with quake_feed_sim; stdin can only be read once, so
+// "-" runs the feed alone.
+//
+// Usage (from the bin folder):
+//   quake_feed_bench [feed.geojson] [capacity]
+//
+//   feed.geojson  feed to read, or - for stdin (default: earthquakes.geojson)
+//   capacity      notes in QuakeFeed's ring (default: 4096)
+//
+// For example:
+//   quake_feed_sim 100000 earthquakes.geojson && quake_feed_bench
+//   quake_feed_sim 100000 - | quake_feed_bench -
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "QuakeFeed.h"
+
+void print(const char *name, size_t quakes, size_t bytes, double seconds,
+           size_t held) {
+  std::cout << std::setw(8) << name << std::setw(10) << quakes
+            << std::setw(10) << bytes / 1e6 << std::setw(10)
+            << seconds * 1000 << std::setw(12) << quakes / seconds
+            << std::setw(10) << bytes / 1e6 / seconds << std::setw(8)
+            << held << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  std::string path = argc > 1 ? argv[1] : "earthquakes.geojson";
+  size_t capacity = argc > 2 ? std::stoul(argv[2]) : 4096;
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(8) << "path" << std::setw(10) << "quakes"
+            << std::setw(10) << "MB" << std::setw(10) << "ms"
+            << std::setw(12) << "quakes/s" << std::setw(10) << "MB/s"
+            << std::setw(8) << "held" << std::endl;
+
+  float sum = 0;
+  if (path != "-") {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+      std::cerr << "Could not read " << path
+                << ", write it with quake_feed_sim" << std::endl;
+      return 1;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    QuakeReader reader;
+    QuakeScale scale;
+    float minStart = 0, maxStart = 0;
+    reader.read(file, [&](const Quake &quake) {
+      QuakeNote note = scale.note(quake);
+      sum += note.frequency;
+      if (reader.features() == 1) {
+        minStart = maxStart = note.start;
+      }
+      minStart = std::min(minStart, note.start);
+      maxStart = std::max(maxStart, note.start);
+    });
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
+    std::fclose(file);
+    print("reader", reader.features(), reader.bytes(), seconds, 0);
+    if (reader.skipped() > 0) {
+      std::cout << reader.skipped() << " features without a magnitude, "
+                << "time or position" << std::endl;
+    }
+    std::cout << "Notes start from " << minStart << " to " << maxStart
+              << " s" << std::endl;
+    if (reader.features() > 1 && minStart == maxStart) {
+      std::cerr << "Every note starts at the same time" << std::endl;
+      return 1;
+    }
+  }
+
+  QuakeFeed feed(capacity);
+  auto begin = std::chrono::steady_clock::now();
+  if (!feed.start(path)) {
+    std::cerr << "Could not read " << path << std::endl;
+    return 1;
+  }
+  std::vector<QuakeNote> notes;
+  size_t polled = 0, held = 0;
+  while (!feed.done()) {
+    held = std::max(held, feed.queued());
+    feed.poll(notes, 64);
+    for (auto &note : notes) {
+      sum += note.frequency;
+    }
+    polled += notes.size();
+    if (notes.empty()) {
+      std::this_thread::yield();
+    }
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+  print("feed", polled, feed.bytes(), seconds, held);
+  if (!feed.error().empty()) {
+    std::cerr << feed.error() << std::endl;
+    return 1;
+  }
+  std::cout << std::endl << "(checksum " << sum << ")" << std::endl;
+  return 0;
+}
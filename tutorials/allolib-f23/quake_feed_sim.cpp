@@ -0,0 +1,100 @@
+// Writes a stand-in for the USGS earthquake feed, for QuakeFeed.h
+//
+// The feed is a GeoJSON FeatureCollection laid out like the one
+// get_earthquakes.py fetches: newest quake first over the last 30 days,
+// magnitudes from 5.5 up, each feature with the same properties. With a
+// rate, the features are written and flushed one at a time at that many per
+// second, so a pipe into an app sees them arrive like a live feed.
+//
+// Usage (from the bin folder):
+//   quake_feed_sim [quakes] [output] [rate]
+//
+//   quakes  number of features (default: 100000)
+//   output  file to write, or - for stdout (default: earthquakes.geojson)
+//   rate    features per second, 0 for as fast as possible (default: 0)
+//
+// For example, to play a live stand-in:
+//   quake_feed_sim 1000 - 20 | world_map_earthquakesv2 -
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// xorshift, so the same feed is written on every platform
+struct Random {
+  uint64_t state{0x9e3779b97f4a7c15ull};
+
+  double uniform() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return double(state >> 11) / double(1ull << 53);
+  }
+};
+
+int main(int argc, char *argv[]) {
+  long quakes = argc > 1 ? std::stol(argv[1]) : 100000;
+  std::string path = argc > 2 ? argv[2] : "earthquakes.geojson";
+  double rate = argc > 3 ? std::stod(argv[3]) : 0;
+
+  std::FILE *file = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+  if (!file) {
+    std::cerr << "Could not write " << path << std::endl;
+    return 1;
+  }
+
+  const double day = 24 * 60 * 60 * 1000.0;
+  const double now = 1700000000000.0;
+  Random random;
+  auto begin = std::chrono::steady_clock::now();
+
+  std::fprintf(file,
+               "{\"type\":\"FeatureCollection\",\"metadata\":{"
+               "\"generated\":%.0f,\"url\":\"quake_feed_sim\","
+               "\"title\":\"USGS Earthquakes\",\"status\":200,"
+               "\"api\":\"1.14.0\",\"count\":%ld},\"features\":[",
+               now, quakes);
+  for (long i = 0; i < quakes; i++) {
+    double time = now - 30 * day * double(i) / double(quakes);
+    // Fewer quakes the larger they are, as in the real feed
+    double mag = 5.5 - std::log10(1 - 0.999 * random.uniform());
+    double longitude = -180 + 360 * random.uniform();
+    double latitude = -60 + 120 * random.uniform();
+    double depth = 700 * random.uniform() * random.uniform();
+    std::fprintf(
+        file,
+        "%s{\"type\":\"Feature\",\"properties\":{\"mag\":%.1f,"
+        "\"place\":\"%.0f km of somewhere\",\"time\":%.0f,"
+        "\"updated\":%.0f,\"tz\":null,\"url\":\"https://earthquake.usgs.gov/"
+        "earthquakes/eventpage/sim%07ld\",\"felt\":null,\"cdi\":null,"
+        "\"mmi\":null,\"alert\":null,\"status\":\"reviewed\",\"tsunami\":0,"
+        "\"sig\":%d,\"net\":\"us\",\"code\":\"%07ld\",\"sources\":\",us,\","
+        "\"types\":\",origin,phase-data,\",\"magType\":\"mww\","
+        "\"type\":\"earthquake\",\"title\":\"M %.1f - %.0f km of "
+        "somewhere\"},\"geometry\":{\"type\":\"Point\",\"coordinates\":"
+        "[%.4f,%.4f,%.3f]},\"id\":\"sim%07ld\"}",
+        i ? "," : "", mag, 100 * random.uniform(), time, time + day, i,
+        int(mag * 100), i, mag, 100 * random.uniform(), longitude, latitude,
+        depth, i);
+    if (rate > 0) {
+      std::fflush(file);
+      std::this_thread::sleep_until(
+          begin + std::chrono::duration<double>(double(i + 1) / rate));
+    }
+  }
+  std::fprintf(file, "],\"bbox\":[-180,-60,0,180,60,700]}\n");
+
+  bool ok = std::fflush(file) == 0 && !std::ferror(file);
+  if (file != stdout) {
+    ok = std::fclose(file) == 0 && ok;
+  }
+  if (!ok) {
+    std::cerr << "Could not write " << path << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -22,53 +22,27 @@ Modified by Phill Conrad, Eirini Schoinas, Riona Pampati, 2023
 
 #include "al/graphics/al_Font.hpp" // for text rendering
 
+#include "AxisMesh.h"
+#include "MapMesh.h"
+#include "PolylineFile.h"
+
 // Drawing on a 2D canvas using pixel coordinates
 
 using namespace al;
 
-std::vector<std::vector<Vec3f>> points;
+PolylineFile points; // Map shapes, see readPoints()
 
 struct MyApp : public App
 {
-    Mesh xAxis;
-    Mesh yAxis;
+    AxisMesh xAxis{AxisMesh::X, Color(1, 1, 0)};
+    AxisMesh yAxis{AxisMesh::Y, Color(0, 1, 1)};
+    MapMesh mapMesh; // Every shape in points, built once
 
     // this font is for rendering text labels on the axes
     FontRenderer fontRender;
 
-    void drawLabelX(Graphics &g, float x, float labelOffset, float fontSize)
-    {
-        std::ostringstream oss;
-        oss << std::fixed << std::showpoint;
-        oss << std::setprecision(1);
-        oss << "x=" << x;
-        fontRender.alignCenter(); // makes the text centered around the position
-        fontRender.write(oss.str().c_str(), fontSize);
-        fontRender.renderAt(g, {x, labelOffset, 0.0});
-    }
-
-    void drawLabelY(Graphics &g, float y, float labelOffset, float fontSize)
-    {
-        std::ostringstream oss;
-        oss << std::fixed << std::showpoint;
-        oss << std::setprecision(1);
-        oss << "y=" << y;
-        fontRender.alignLeft(); // makes the text centered around the position
-        fontRender.write(oss.str().c_str(), fontSize);
-        fontRender.renderAt(g, {labelOffset, y - (fontSize * 0.2), 0.0});
-    }
-
-
     void drawUnitedStates(Graphics &g) {
-        for (auto shape : points) {
-            Mesh m;
-            m.primitive(Mesh::LINE_STRIP);
-            for (auto p : shape) {
-                m.vertex(p);
-            }
-            g.color(1, 1, 1);
-            g.draw(m);
-        }
+        mapMesh.draw(g);
     }
 
     void drawXAxis(Graphics &g,
@@ -79,35 +53,8 @@ struct MyApp : public App
                    float labelOffset,
                    float fontSize)
     {
-        xAxis.primitive(Mesh::LINE_STRIP);
-
-        // Create x and y axes
-        xAxis.vertex(minX, 0);
-        xAxis.vertex(maxX, 0);
-
-        // Create the X tick marks and labels
-
-        for (float x = 0; x < maxX; x += tickIncrement)
-        {
-            xAxis.vertex(x, 0);
-            xAxis.vertex(x, tickSize);
-            xAxis.vertex(x, -tickSize);
-            xAxis.vertex(x, 0);
-            drawLabelX(g, x, labelOffset, fontSize);
-        }
-
-        for (float x = 0; x >= minX; x -= tickIncrement)
-        {
-            xAxis.vertex(x, 0);
-            xAxis.vertex(x, tickSize);
-            xAxis.vertex(x, -tickSize);
-            xAxis.vertex(x, 0);
-            drawLabelX(g, x, labelOffset, fontSize);
-        }
-
-        //  Draw the axis
-        g.color(1, 1, 0);
-        g.draw(xAxis);
+        xAxis.draw(g, fontRender, minX, maxX, tickIncrement, tickSize,
+                   labelOffset, fontSize);
     }
 
     void drawYAxis(Graphics &g,
@@ -118,42 +65,14 @@ struct MyApp : public App
                    float labelOffset,
                    float fontSize)
     {
-        yAxis.primitive(Mesh::LINE_STRIP);
-
-        yAxis.vertex(0, minY);
-        yAxis.vertex(0, maxY);
-
-        // Create the Y tick marks and labels
-
-        for (float y = 0; y <= maxY; y += tickIncrement)
-        {
-            yAxis.vertex(0, y);
-            yAxis.vertex(tickSize, y);
-            yAxis.vertex(-tickSize, y);
-            yAxis.vertex(0, y);
-            g.color(1, 1, 1);
-            drawLabelY(g, y, labelOffset, fontSize);
-        }
-
-        for (float y = 0; y >= minY; y -= tickIncrement)
-        {
-            yAxis.vertex(0, y);
-            yAxis.vertex(tickSize, y);
-            yAxis.vertex(-tickSize, y);
-            yAxis.vertex(0, y);
-            g.color(1, 1, 1);
-            drawLabelY(g, y, labelOffset, fontSize);
-        }
-
-        //  Draw the Y Axis
-
-        g.color(0, 1, 1);
-        g.draw(yAxis);
+        yAxis.draw(g, fontRender, minY, maxY, tickIncrement, tickSize,
+                   labelOffset, fontSize);
     }
 
     void onCreate()
     {
         fontRender.load(Font::defaultFont().c_str(), 60, 1024);
+        mapMesh.build(points);
     }
 
     void onAnimate(double dt)
@@ -188,44 +107,21 @@ struct MyApp : public App
 };
 
 
-std::vector<std::string> split (const std::string &s, char delim) {
-    std::vector<std::string> result;
-    std::stringstream ss (s);
-    std::string item;
-
-    while (getline (ss, item, delim)) {
-        result.push_back (item);
-    }
-
-    return result;
-}
-
 int readPoints()
 {
     // file is taken from KML file with only the <coordinates> sections pulled out
     // and then the <coordinates> open/close tags put on their own lines
     // and each pair of x,y put on a separate line
+    //
+    // The first run converts it to a binary file next to it, which later
+    // runs map instead of parsing (see PolylineFile.h).
 
-    std::ifstream infile("../world-administrative.dat");
-    std::string line;
-    std::vector<Vec3f> thisShape;
-
-    while (std::getline(infile, line))
+    if (!points.load("../world-administrative.dat",
+                     "../world-administrative.polylines"))
     {
-        if (line == "<coordinates>") 
-            continue;
-        if (line == "</coordinates>")  {
-            points.push_back(thisShape);
-            thisShape.clear();
-            continue;
-        }
-            
-        auto parts = split(line, ',');
-        float x = std::stof(parts[0]);
-        float y = std::stof(parts[1]);
-        thisShape.push_back(Vec3f(x, y, 0.0f));
+        std::cerr << "Could not read ../world-administrative.dat" << std::endl;
     }
-    infile.close();
+    return int(points.size());
 }
 
 int main()
@@ -34,11 +34,17 @@ Modified by Phill Conrad, Eirini Schoinas, Riona Pampati, 2023
 
 #include "al/graphics/al_Font.hpp" // for text rendering
 
+#include "AxisMesh.h"
+#include "MapMesh.h"
+#include "PolylineFile.h"
+#include "QuakeFeed.h"
+#include "PointTree.h"
+
 // Drawing on a 2D canvas using pixel coordinates
 
 using namespace al;
 
-std::vector<std::vector<Vec3f>> points;
+PolylineFile points; // Map shapes, see readPoints()
 
 class SineEnv : public SynthVoice
 {
@@ -157,49 +163,34 @@ public:
 
 struct MyApp : public App
 {
-    Mesh xAxis;
-    Mesh yAxis;
+    AxisMesh xAxis{AxisMesh::X, Color(1, 1, 0)};
+    AxisMesh yAxis{AxisMesh::Y, Color(0, 1, 1)};
+    MapMesh mapMesh; // Every shape in points, built once
 
     SynthGUIManager<SineEnv> synthManager{"SineEnv"};
 
+    // Quakes streamed from feedPath instead of earthquakes.synthSequence,
+    // when it is given (see main())
+    std::string feedPath;
+    QuakeFeed feed;
+    std::vector<QuakeNote> notes;
+    double feedTime{0};
+    // Seconds ahead of feedTime that notes are taken from the feed. Later
+    // ones wait in its ring, which holds the reading thread back.
+    const double feedLookahead{1.0};
+    bool feedReported{false};
+
+    // Longitude and latitude of every quake played from the feed, and the
+    // one under the mouse, -1 for none
+    PointTree quakes;
+    int hoverIndex{-1};
+
     // this font is for rendering text labels on the axes
     FontRenderer fontRender;
 
-    void drawLabelX(Graphics &g, float x, float labelOffset, float fontSize)
-    {
-        std::ostringstream oss;
-        oss << std::fixed << std::showpoint;
-        oss << std::setprecision(1);
-        oss << "x=" << x;
-        fontRender.alignCenter(); // makes the text centered around the position
-        fontRender.write(oss.str().c_str(), fontSize);
-        fontRender.renderAt(g, {x, labelOffset, 0.0});
-    }
-
-    void drawLabelY(Graphics &g, float y, float labelOffset, float fontSize)
-    {
-        std::ostringstream oss;
-        oss << std::fixed << std::showpoint;
-        oss << std::setprecision(1);
-        oss << "y=" << y;
-        fontRender.alignLeft(); // makes the text centered around the position
-        fontRender.write(oss.str().c_str(), fontSize);
-        fontRender.renderAt(g, {labelOffset, y - (fontSize * 0.2), 0.0});
-    }
-
     void drawWorldMap(Graphics &g)
     {
-        for (auto shape : points)
-        {
-            Mesh m;
-            m.primitive(Mesh::LINE_STRIP);
-            for (auto p : shape)
-            {
-                m.vertex(p);
-            }
-            g.color(1, 1, 1);
-            g.draw(m);
-        }
+        mapMesh.draw(g);
     }
 
     void drawXAxis(Graphics &g,
@@ -210,35 +201,8 @@ struct MyApp : public App
                    float labelOffset,
                    float fontSize)
     {
-        xAxis.primitive(Mesh::LINE_STRIP);
-
-        // Create x and y axes
-        xAxis.vertex(minX, 0);
-        xAxis.vertex(maxX, 0);
-
-        // Create the X tick marks and labels
-
-        for (float x = 0; x < maxX; x += tickIncrement)
-        {
-            xAxis.vertex(x, 0);
-            xAxis.vertex(x, tickSize);
-            xAxis.vertex(x, -tickSize);
-            xAxis.vertex(x, 0);
-            drawLabelX(g, x, labelOffset, fontSize);
-        }
-
-        for (float x = 0; x >= minX; x -= tickIncrement)
-        {
-            xAxis.vertex(x, 0);
-            xAxis.vertex(x, tickSize);
-            xAxis.vertex(x, -tickSize);
-            xAxis.vertex(x, 0);
-            drawLabelX(g, x, labelOffset, fontSize);
-        }
-
-        //  Draw the axis
-        g.color(1, 1, 0);
-        g.draw(xAxis);
+        xAxis.draw(g, fontRender, minX, maxX, tickIncrement, tickSize,
+                   labelOffset, fontSize);
     }
 
     void drawYAxis(Graphics &g,
@@ -249,48 +213,27 @@ struct MyApp : public App
                    float labelOffset,
                    float fontSize)
     {
-        yAxis.primitive(Mesh::LINE_STRIP);
-
-        yAxis.vertex(0, minY);
-        yAxis.vertex(0, maxY);
-
-        // Create the Y tick marks and labels
-
-        for (float y = 0; y <= maxY; y += tickIncrement)
-        {
-            yAxis.vertex(0, y);
-            yAxis.vertex(tickSize, y);
-            yAxis.vertex(-tickSize, y);
-            yAxis.vertex(0, y);
-            g.color(1, 1, 1);
-            drawLabelY(g, y, labelOffset, fontSize);
-        }
-
-        for (float y = 0; y >= minY; y -= tickIncrement)
-        {
-            yAxis.vertex(0, y);
-            yAxis.vertex(tickSize, y);
-            yAxis.vertex(-tickSize, y);
-            yAxis.vertex(0, y);
-            g.color(1, 1, 1);
-            drawLabelY(g, y, labelOffset, fontSize);
-        }
-
-        //  Draw the Y Axis
-
-        g.color(0, 1, 1);
-        g.draw(yAxis);
+        yAxis.draw(g, fontRender, minY, maxY, tickIncrement, tickSize,
+                   labelOffset, fontSize);
     }
 
     void onCreate()
     {
         fontRender.load(Font::defaultFont().c_str(), 60, 1024);
+        mapMesh.build(points);
         // Set sampling rate for Gamma objects from app's audio
         gam::sampleRate(audioIO().framesPerSecond());
 
         imguiInit();
 
-        synthManager.synthSequencer().playSequence("earthquakes.synthSequence");
+        if (feedPath.empty())
+        {
+            synthManager.synthSequencer().playSequence("earthquakes.synthSequence");
+        }
+        else if (!feed.start(feedPath))
+        {
+            std::cerr << "Could not read " << feedPath << std::endl;
+        }
 
     }
 
@@ -302,6 +245,11 @@ struct MyApp : public App
 
     void onAnimate(double dt)
     {
+        if (!feedPath.empty())
+        {
+            playFeed(dt);
+        }
+
         // The GUI is prepared here
         imguiBeginFrame();
         // Draw a window that contains the synth control panel
@@ -309,6 +257,56 @@ struct MyApp : public App
         imguiEndFrame();
     }
 
+    // Adds the quakes that start within the lookahead to the sequencer.
+    // Their start times count from when the feed started; ones already
+    // past play now.
+    void playFeed(double dt)
+    {
+        feedTime += dt;
+        feed.poll(notes, 64, feedTime + feedLookahead);
+        for (auto &note : notes)
+        {
+            auto *voice = synthManager.synth().getVoice<SineEnv>();
+            // amplitude frequency attackTime releaseTime pan x y
+            std::vector<float> triggerParams = std::vector<float>(
+                {note.amplitude, note.frequency, note.attackTime,
+                 note.releaseTime, note.pan, note.x, note.y});
+            voice->setTriggerParams(triggerParams);
+            double start = std::max(0.0, note.start - feedTime);
+            synthManager.synthSequencer().addVoiceFromNow(voice, start,
+                                                          note.duration);
+            quakes.insert(Vec3f(note.x, note.y, 0));
+        }
+        if (!feedReported && feed.done())
+        {
+            feedReported = true;
+            if (!feed.error().empty())
+            {
+                std::cerr << feed.error() << std::endl;
+            }
+            std::cout << "Read " << feed.quakes() << " quakes in "
+                      << feed.seconds() << " s ("
+                      << feed.quakes() / std::max(feed.seconds(), 1e-6)
+                      << " quakes/s)" << std::endl;
+        }
+    }
+
+    bool onMouseMove(Mouse const &m) override
+    {
+        // Window to map coordinates, as set up in onDraw()
+        float lon = (2.0f * m.x() / width() - 1) * 180;
+        float lat = (1 - 2.0f * m.y() / height()) * 90;
+        // The closest quake within 2 degrees
+        int index = quakes.nearest(Vec3f(lon, lat, 0), 2.0f).index;
+        if (index != hoverIndex && index >= 0)
+        {
+            std::cout << "Quake at longitude " << quakes[index].x
+                      << ", latitude " << quakes[index].y << std::endl;
+        }
+        hoverIndex = index;
+        return true;
+    }
+
     void onDraw(Graphics &g)
     {
         g.clear(0);
@@ -338,50 +336,28 @@ struct MyApp : public App
     }
 };
 
-std::vector<std::string> split(const std::string &s, char delim)
-{
-    std::vector<std::string> result;
-    std::stringstream ss(s);
-    std::string item;
-
-    while (getline(ss, item, delim))
-    {
-        result.push_back(item);
-    }
-
-    return result;
-}
-
 int readPoints()
 {
     // file is taken from KML file with only the <coordinates> sections pulled out
     // and then the <coordinates> open/close tags put on their own lines
     // and each pair of x,y put on a separate line
+    //
+    // The first run converts it to a binary file next to it, which later
+    // runs map instead of parsing (see PolylineFile.h).
 
-    std::ifstream infile("../world-administrative.dat");
-    std::string line;
-    std::vector<Vec3f> thisShape;
-
-    while (std::getline(infile, line))
+    if (!points.load("../world-administrative.dat",
+                     "../world-administrative.polylines"))
     {
-        if (line == "<coordinates>")
-            continue;
-        if (line == "</coordinates>")
-        {
-            points.push_back(thisShape);
-            thisShape.clear();
-            continue;
-        }
-
-        auto parts = split(line, ',');
-        float x = std::stof(parts[0]);
-        float y = std::stof(parts[1]);
-        thisShape.push_back(Vec3f(x, y, 0.0f));
+        std::cerr << "Could not read ../world-administrative.dat" << std::endl;
     }
-    infile.close();
+    return int(points.size());
 }
 
-int main()
+// Usage: world_map_earthquakesv2 [feed.geojson | -]
+//
+// Plays earthquakes.synthSequence, or the quakes in a GeoJSON feed file or
+// stdin while they are read (see QuakeFeed.h and quake_feed_sim.cpp).
+int main(int argc, char *argv[])
 {
 
     readPoints();
@@ -389,6 +365,10 @@ int main()
     std::cout << "Read " << points.size() << " shapes from world-administrative.dat" << std::endl;
 
     MyApp app;
+    if (argc > 1)
+    {
+        app.feedPath = argv[1];
+    }
 
     app.configureAudio(48000., 512, 2, 0);
 
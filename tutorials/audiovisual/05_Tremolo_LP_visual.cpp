@@ -14,7 +14,7 @@
 #include "Gamma/Gamma.h"
 #include "Gamma/Oscillator.h"
 #include "Gamma/Types.h"
-#include "Gamma/DFT.h"
+#include "SpectrumAnalyzer.h"
 #include "al/app/al_App.hpp"
 #include "al/graphics/al_Shapes.hpp"
 #include "al/scene/al_PolySynth.hpp"
@@ -31,7 +31,7 @@ using namespace std;
 // using namespace gam;
 using namespace al;
 using namespace std;
-#define FFT_SIZE 4048
+#define FFT_SIZE 4096
 
 // tables for oscillator
 gam::ArrayPow2<float>
@@ -298,11 +298,10 @@ public:
     OscTrm osctrm;
     RtMidiIn midiIn; // MIDI input carrier
     Mesh mSpectrogram;
-    vector<float> spectrum;
     bool showGUI = true;
     bool showSpectro = true;
     bool navi = false;
-    gam::STFT stft = gam::STFT(FFT_SIZE, FFT_SIZE / 4, 0, gam::HANN, gam::MAG_FREQ);
+    SpectrumAnalyzer analyzer{FFT_SIZE, FFT_SIZE / 4, SpectrumAnalyzer::HANN};
 
     virtual void onInit() override
     {
@@ -327,8 +326,8 @@ public:
         {
             printf("Error: No MIDI devices found.\n");
         }
-        // Declare the size of the spectrum
-        spectrum.resize(FFT_SIZE / 2 + 1);
+        // Scale the magnitudes to tanh(pow(mag, 1.3)) for drawing
+        analyzer.scaling(SpectrumAnalyzer::CURVE, 1.3f);
     }
     void onCreate() override
     {
@@ -341,21 +340,13 @@ public:
     void onSound(AudioIOData &io) override
     {
         synthManager.render(io); // Render audio
-        // STFT
         while (io())
         {
-            io.out(0) = tanh(io.out(0);
-            io.out(1) = tanh(io.out(1);
-            if (stft(io.out(0)))
-            { // Loop through all the frequency bins
-                for (unsigned k = 0; k < stft.numBins(); ++k)
-                {
-                    // Here we simply scale the complex sample
-                    spectrum[k] = tanh(pow(stft.bin(k).real(), 1.3));
-                    // spectrum[k] = stft.bin(k).real();
-                }
-            }
+            io.out(0) = tanh(io.out(0));
+            io.out(1) = tanh(io.out(1));
         }
+        // Spectrum of the whole block
+        analyzer.process(io.outBuffer(0), io.framesPerBuffer());
     }
 
     void onAnimate(double dt) override
@@ -377,6 +368,7 @@ public:
         mSpectrogram.primitive(Mesh::LINE_STRIP);
         if (showSpectro)
         {
+            const float *spectrum = analyzer.spectrum();
             for (int i = 0; i < FFT_SIZE / 2; i++)
             {
                 mSpectrogram.color(HSV(0.5 - spectrum[i] * 100));
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef MeshCache_H
+#define MeshCache_H
+
+// Meshes shared by every voice in the process, built once per shape.
+//
+// The tutorial voices used to build their own meshes in init(), so
+// allocating 64 voices built 64 identical spheres, each decompressed and
+// given normals. The cache builds a mesh the first time its key is asked for
+// and hands out the same mesh from then on. Keys name the shape and its
+// parameters, e.g. "sphere 0.3 50 50", so voices that draw the same shape
+// share it. Sizes are written with 6 significant digits, like %g, so sizes
+// closer than that share a mesh.
+//
+// Cached meshes are never changed after they are built, so voices must only
+// draw them. Lookups take a lock and may build a mesh, so do them in init(),
+// not on the audio thread.
+//
+// Usage:
+//   const Mesh *mMesh;
+//   ...
+//   mMesh = &MeshCache::get().sphere(0.3, 50, 50); // In init()
+//   ...
+//   g.draw(*mMesh);
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "al/graphics/al_Mesh.hpp"
+#include "al/graphics/al_Shapes.hpp"
+
+class MeshCache {
+public:
+  static MeshCache &get() {
+    static MeshCache cache;
+    return cache;
+  }
+
+  // The mesh for key. build(mesh) fills it in the first time key is used.
+  template <class Build>
+  const al::Mesh &mesh(const std::string &key, Build &&build) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto &mesh = mMeshes[key];
+    if (!mesh) {
+      mesh.reset(new al::Mesh);
+      build(*mesh);
+    }
+    return *mesh;
+  }
+
+  // Decompressed sphere with normals
+  const al::Mesh &sphere(double radius, int slices, int stacks) {
+    return mesh(key("sphere %g %d %d", radius, slices, stacks),
+                [&](al::Mesh &m) {
+                  al::addSphere(m, radius, slices, stacks);
+                  m.decompress();
+                  m.generateNormals();
+                });
+  }
+
+  const al::Mesh &disc(double radius, int slices) {
+    return mesh(key("disc %g %d", radius, slices),
+                [&](al::Mesh &m) { al::addDisc(m, radius, slices); });
+  }
+
+  size_t numMeshes() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMeshes.size();
+  }
+
+  // Memory held by the vertex data of all meshes
+  size_t bytes() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t total = 0;
+    for (auto &m : mMeshes) {
+      total += bytes(*m.second);
+    }
+    return total;
+  }
+
+  // Memory held by the vertex data of one mesh
+  static size_t bytes(const al::Mesh &m) {
+    return m.vertices().size() * sizeof(m.vertices()[0]) +
+           m.normals().size() * sizeof(m.normals()[0]) +
+           m.colors().size() * sizeof(m.colors()[0]) +
+           m.coloris().size() * sizeof(m.coloris()[0]) +
+           m.texCoord1s().size() * sizeof(m.texCoord1s()[0]) +
+           m.texCoord2s().size() * sizeof(m.texCoord2s()[0]) +
+           m.texCoord3s().size() * sizeof(m.texCoord3s()[0]) +
+           m.indices().size() * sizeof(m.indices()[0]);
+  }
+
+private:
+  template <class... Args>
+  static std::string key(const char *format, Args... args) {
+    char text[64];
+    std::snprintf(text, sizeof(text), format, args...);
+    return text;
+  }
+
+  std::mutex mMutex;
+  std::map<std::string, std::unique_ptr<al::Mesh>> mMeshes;
+};
+
+#endif // MeshCache_H
@@ -0,0 +1,247 @@
+#pragma once
+#ifndef ParallelPolySynth_H
+#define ParallelPolySynth_H
+
+// PolySynth that renders its active voices on a pool of worker threads.
+//
+// Every active voice renders into its own scratch bus. The buses are then
+// summed into the output in the same order the serial PolySynth::render()
+// walks the active voice list, so the result is bit-for-bit identical to the
+// serial path no matter how the voices were spread across the workers.
+//
+// The audio thread never waits for a worker to wake up: it renders every
+// voice no worker has claimed yet itself, and then only waits for the
+// voices already being rendered to finish, which takes no longer than the
+// slowest single voice. It waits on a condition the worker that finishes
+// the last voice signals.
+//
+// prepare() allocates the buses for the most voices that render in
+// parallel, so render() never allocates. Voices beyond that, and every
+// voice of a block whose size or channel count differ from the prepared
+// ones, render on the audio thread straight into the output, after the
+// others and in the same order, so the output is still the serial one.
+//
+// Usage:
+//   ParallelPolySynth synth{4};     // 4 rendering threads (1 = serial)
+//   synth.registerSynthClass<AddSyn>();
+//   synth.prepare(512, 2, 64);      // Before audio starts
+//   sequencer << synth;             // or synth.render(io) in onSound()
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "al/io/al_AudioIOData.hpp"
+#include "al/scene/al_PolySynth.hpp"
+
+class ParallelPolySynth : public al::PolySynth {
+public:
+  ParallelPolySynth(unsigned int numThreads = 1) { threads(numThreads); }
+
+  ~ParallelPolySynth() { stopWorkers(); }
+
+  // Number of threads used for rendering, including the calling (audio)
+  // thread. 1 renders serially on the audio thread.
+  void threads(unsigned int numThreads) {
+    if (numThreads < 1) {
+      numThreads = 1;
+    }
+    stopWorkers();
+    std::unique_lock<std::mutex> lk(mJobLock);
+    mNumThreads = numThreads;
+    mRunning = true;
+    // New workers wait for the next job, not one that already ran
+    for (unsigned int i = 1; i < mNumThreads; i++) {
+      mWorkers.emplace_back(
+          [this, generation = mJobGeneration]() { workerFunction(generation); });
+    }
+  }
+
+  unsigned int threads() const { return mNumThreads; }
+
+  // Allocates buses for up to maxVoices voices rendering in parallel, in
+  // blocks of framesPerBuffer frames and channels channels. Not for the
+  // audio thread.
+  void prepare(unsigned int framesPerBuffer, int channels, size_t maxVoices) {
+    mBuses.resize(maxVoices);
+    for (auto &bus : mBuses) {
+      bus.reset(new al::AudioIOData);
+      bus->framesPerBuffer(framesPerBuffer);
+      bus->channelsOut(channels);
+    }
+    mVoices.reserve(maxVoices);
+    mOffsets.resize(maxVoices);
+  }
+
+  using al::PolySynth::render;
+
+  void render(al::AudioIOData &io) override {
+    processVoices();
+
+    // Collect the active voices in list order, up to one per bus. This order
+    // is also the order used for summing, which keeps the output identical
+    // to the serial path.
+    size_t numBuses = 0;
+    if (!mBuses.empty() &&
+        mBuses[0]->framesPerBuffer() == io.framesPerBuffer() &&
+        mBuses[0]->channelsOut() == io.channelsOut()) {
+      numBuses = mBuses.size();
+    }
+    mVoices.clear();
+    auto voice = mActiveVoices;
+    while (voice && mVoices.size() < numBuses) {
+      if (voice->active()) {
+        mVoices.push_back(voice);
+      }
+      voice = voice->next;
+    }
+    auto *unbused = voice; // First voice rendered straight into io
+    prepareBuses(io);
+
+    if (mNumThreads > 1 && mVoices.size() > 1) {
+      uint32_t generation;
+      {
+        std::unique_lock<std::mutex> lk(mJobLock);
+        generation = ++mJobGeneration;
+        mJobSize = mVoices.size();
+        mVoicesDone.store(0, std::memory_order_relaxed);
+        mNextVoice.store(uint64_t(generation) << 32, std::memory_order_release);
+      }
+      mJobCondition.notify_all();
+      // The audio thread takes every voice no worker has started on
+      renderPending(generation, mVoices.size());
+      // Claimed voices are being rendered right now, so this waits for at
+      // most one voice per worker. Workers that haven't woken up yet find
+      // the job gone and touch nothing.
+      std::unique_lock<std::mutex> lk(mDoneLock);
+      mDoneCondition.wait(lk, [&]() {
+        return mVoicesDone.load(std::memory_order_acquire) >= mVoices.size();
+      });
+    } else {
+      for (size_t i = 0; i < mVoices.size(); i++) {
+        renderVoice(i);
+      }
+    }
+
+    // Deterministic reduction: voice order, then frame order
+    int channels = io.channelsOut();
+    for (size_t i = 0; i < mVoices.size(); i++) {
+      auto &bus = *mBuses[i];
+      unsigned int offset = mOffsets[i];
+      for (int chan = 0; chan < channels; chan++) {
+        float *out = io.outBuffer(chan);
+        const float *in = bus.outBuffer(chan);
+        for (unsigned int frame = offset; frame < io.framesPerBuffer();
+             frame++) {
+          out[frame] += in[frame];
+        }
+      }
+    }
+    for (voice = unbused; voice; voice = voice->next) {
+      if (voice->active()) {
+        int offset = voice->getStartOffsetFrames(io.framesPerBuffer());
+        io.frame(offset > 0 ? offset : 0);
+        voice->onProcess(io);
+      }
+    }
+
+    processVoiceTurnOff();
+    for (auto cb : mPostProcessing) {
+      io.frame(0);
+      cb->onAudioCB(io);
+    }
+    processInactiveVoices();
+  }
+
+private:
+  void prepareBuses(al::AudioIOData &io) {
+    // getStartOffsetFrames() consumes the pending offset, so it is called
+    // exactly once per voice and block, as in the serial path.
+    for (size_t i = 0; i < mVoices.size(); i++) {
+      auto &bus = *mBuses[i];
+      bus.framesPerSecond(io.framesPerSecond());
+      int offset = mVoices[i]->getStartOffsetFrames(io.framesPerBuffer());
+      mOffsets[i] = offset > 0 ? offset : 0;
+    }
+  }
+
+  void renderVoice(size_t index) {
+    auto &bus = *mBuses[index];
+    bus.zeroOut();
+    bus.frame(mOffsets[index]);
+    mVoices[index]->onProcess(bus);
+  }
+
+  // Renders voices of the job until none are left to claim. A voice is
+  // claimed only while the job is still current, so a late thread can't
+  // claim a voice of the next block.
+  void renderPending(uint32_t generation, size_t size) {
+    uint64_t next = mNextVoice.load(std::memory_order_acquire);
+    while (uint32_t(next >> 32) == generation &&
+           (next & 0xffffffffu) < size) {
+      if (mNextVoice.compare_exchange_weak(next, next + 1,
+                                           std::memory_order_acq_rel)) {
+        renderVoice(size_t(next & 0xffffffffu));
+        if (mVoicesDone.fetch_add(1, std::memory_order_acq_rel) + 1 == size) {
+          // Taking the lock orders this with the audio thread's check
+          { std::lock_guard<std::mutex> lk(mDoneLock); }
+          mDoneCondition.notify_one();
+        }
+        next = mNextVoice.load(std::memory_order_acquire);
+      }
+    }
+  }
+
+  void workerFunction(uint32_t generation) {
+    size_t size;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lk(mJobLock);
+        mJobCondition.wait(lk, [&]() {
+          return !mRunning || mJobGeneration != generation;
+        });
+        if (!mRunning) {
+          return;
+        }
+        generation = mJobGeneration;
+        size = mJobSize;
+      }
+      renderPending(generation, size);
+    }
+  }
+
+  void stopWorkers() {
+    {
+      std::unique_lock<std::mutex> lk(mJobLock);
+      mRunning = false;
+    }
+    mJobCondition.notify_all();
+    for (auto &worker : mWorkers) {
+      worker.join();
+    }
+    mWorkers.clear();
+  }
+
+  unsigned int mNumThreads{1};
+  std::vector<std::thread> mWorkers;
+  std::mutex mJobLock;
+  std::condition_variable mJobCondition;
+  uint32_t mJobGeneration{0};
+  size_t mJobSize{0};
+  bool mRunning{false};
+
+  std::vector<al::SynthVoice *> mVoices;
+  std::vector<unsigned int> mOffsets;
+  std::vector<std::unique_ptr<al::AudioIOData>> mBuses;
+  // Job generation in the high 32 bits, next voice to claim in the low 32
+  std::atomic<uint64_t> mNextVoice{0};
+  std::atomic<size_t> mVoicesDone{0};
+  std::mutex mDoneLock;
+  std::condition_variable mDoneCondition;
+};
+
+#endif // ParallelPolySynth_H
@@ -0,0 +1,260 @@
+#pragma once
+#ifndef SineBank_H
+#define SineBank_H
+
+// Bank of N sine partials rendered a whole block at a time.
+//
+// The partial state is kept as structure-of-arrays (phases, increments,
+// amplitudes), and process() computes several consecutive samples of a
+// partial per instruction: 8 with AVX2, 4 with SSE2 or NEON, 1 otherwise.
+// The kernel is chosen at compile time, so building with -mavx2 (or
+// -march=native) enables the AVX2 path. SSE2 is always available on x86-64
+// and NEON on 64-bit ARM.
+//
+// Phases are 32 bit fixed point, so they wrap exactly and do not drift over
+// long notes. The sine is an 11th order polynomial, accurate to about 1e-7,
+// which is as accurate as gam::Sine<>.
+//
+// Usage:
+//   SineBank<3> bank;
+//   bank.sampleRate(48000);
+//   bank.freq(0, 220); bank.amp(0, 0.5);
+//   ...
+//   bank.process(out, gain, frames); // out[i] += gain[i] * sum of partials
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SINEBANK_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace sinebank {
+
+// Taylor coefficients of sin(pi * x), for x in [-0.5, 0.5]
+const float c1 = 3.14159265f;
+const float c3 = -5.16771278f;
+const float c5 = 2.55016404f;
+const float c7 = -0.599264530f;
+const float c9 = 0.0821458866f;
+const float c11 = -0.00737043094f;
+
+// Signed fixed point phase (one cycle = 2^32) to x in [-1, 1)
+const float phaseScale = 1.0f / 2147483648.0f;
+
+// sin(pi * x) for x in [-1, 1)
+inline float sinPi(float x) {
+  float a = std::fabs(x);
+  float y = std::copysign(a < 1.0f - a ? a : 1.0f - a, x);
+  float y2 = y * y;
+  return y * (c1 + y2 * (c3 + y2 * (c5 + y2 * (c7 + y2 * (c9 + y2 * c11)))));
+}
+
+#if defined(__AVX2__)
+inline __m256 sinPi(__m256 x) {
+  const __m256 signMask = _mm256_set1_ps(-0.0f);
+  __m256 a = _mm256_andnot_ps(signMask, x);
+  __m256 t = _mm256_min_ps(a, _mm256_sub_ps(_mm256_set1_ps(1.0f), a));
+  __m256 y = _mm256_or_ps(t, _mm256_and_ps(signMask, x));
+  __m256 y2 = _mm256_mul_ps(y, y);
+  __m256 p = _mm256_set1_ps(c11);
+  p = _mm256_add_ps(_mm256_mul_ps(p, y2), _mm256_set1_ps(c9));
+  p = _mm256_add_ps(_mm256_mul_ps(p, y2), _mm256_set1_ps(c7));
+  p = _mm256_add_ps(_mm256_mul_ps(p, y2), _mm256_set1_ps(c5));
+  p = _mm256_add_ps(_mm256_mul_ps(p, y2), _mm256_set1_ps(c3));
+  p = _mm256_add_ps(_mm256_mul_ps(p, y2), _mm256_set1_ps(c1));
+  return _mm256_mul_ps(p, y);
+}
+#elif defined(SINEBANK_SSE2)
+inline __m128 sinPi(__m128 x) {
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  __m128 a = _mm_andnot_ps(signMask, x);
+  __m128 t = _mm_min_ps(a, _mm_sub_ps(_mm_set1_ps(1.0f), a));
+  __m128 y = _mm_or_ps(t, _mm_and_ps(signMask, x));
+  __m128 y2 = _mm_mul_ps(y, y);
+  __m128 p = _mm_set1_ps(c11);
+  p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(c9));
+  p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(c7));
+  p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(c5));
+  p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(c3));
+  p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(c1));
+  return _mm_mul_ps(p, y);
+}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+inline float32x4_t sinPi(float32x4_t x) {
+  const uint32x4_t signMask = vdupq_n_u32(0x80000000u);
+  float32x4_t a = vabsq_f32(x);
+  float32x4_t t = vminq_f32(a, vsubq_f32(vdupq_n_f32(1.0f), a));
+  float32x4_t y = vbslq_f32(signMask, x, t);
+  float32x4_t y2 = vmulq_f32(y, y);
+  float32x4_t p = vdupq_n_f32(c11);
+  p = vmlaq_f32(vdupq_n_f32(c9), p, y2);
+  p = vmlaq_f32(vdupq_n_f32(c7), p, y2);
+  p = vmlaq_f32(vdupq_n_f32(c5), p, y2);
+  p = vmlaq_f32(vdupq_n_f32(c3), p, y2);
+  p = vmlaq_f32(vdupq_n_f32(c1), p, y2);
+  return vmulq_f32(p, y);
+}
+#endif
+
+} // namespace sinebank
+
+template <int N> class SineBank {
+public:
+  static const int numPartials = N;
+
+  SineBank() {
+    for (int k = 0; k < N; k++) {
+      mPhase[k] = 0;
+      mInc[k] = 0;
+      mAmp[k] = 0.0f;
+    }
+  }
+
+  void sampleRate(double sampleRate) { mSampleRate = sampleRate; }
+
+  // Frequency of partial k in Hz. The phase is kept, as with gam::Sine<>.
+  void freq(int k, float hz) {
+    mInc[k] = uint32_t(int64_t(std::llround(hz / mSampleRate * 4294967296.0)));
+  }
+
+  void amp(int k, float amp) { mAmp[k] = amp; }
+
+  // Restart all partials at phase 0
+  void reset() {
+    for (int k = 0; k < N; k++) {
+      mPhase[k] = 0;
+    }
+  }
+
+  // out[i] += gain[i] * sum over k of amp[k] * sin(phase[k] at sample i),
+  // for i in [0, frames). gain can be nullptr for a gain of 1.
+  void process(float *out, const float *gain, int frames) {
+    int i = 0;
+#if defined(__AVX2__)
+    i = processAVX2(out, gain, frames);
+#elif defined(SINEBANK_SSE2)
+    i = processSSE2(out, gain, frames);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    i = processNEON(out, gain, frames);
+#endif
+    processScalar(out, gain, i, frames);
+    for (int k = 0; k < N; k++) {
+      mPhase[k] += uint32_t(frames) * mInc[k];
+    }
+  }
+
+private:
+  // Remaining frames [begin, end) one sample at a time
+  void processScalar(float *out, const float *gain, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      float s = 0.0f;
+      for (int k = 0; k < N; k++) {
+        int32_t phase = int32_t(mPhase[k] + uint32_t(i) * mInc[k]);
+        s += mAmp[k] * sinebank::sinPi(phase * sinebank::phaseScale);
+      }
+      out[i] += gain ? s * gain[i] : s;
+    }
+  }
+
+#if defined(__AVX2__)
+  int processAVX2(float *out, const float *gain, int frames) {
+    const int width = 8;
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i phase[N], step[N];
+    __m256 amp[N];
+    for (int k = 0; k < N; k++) {
+      __m256i inc = _mm256_set1_epi32(int32_t(mInc[k]));
+      phase[k] = _mm256_add_epi32(_mm256_set1_epi32(int32_t(mPhase[k])),
+                                  _mm256_mullo_epi32(lane, inc));
+      step[k] = _mm256_set1_epi32(int32_t(mInc[k] * width));
+      amp[k] = _mm256_set1_ps(mAmp[k]);
+    }
+    const __m256 scale = _mm256_set1_ps(sinebank::phaseScale);
+    int i = 0;
+    for (; i + width <= frames; i += width) {
+      __m256 s = _mm256_setzero_ps();
+      for (int k = 0; k < N; k++) {
+        __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(phase[k]), scale);
+        s = _mm256_add_ps(s, _mm256_mul_ps(amp[k], sinebank::sinPi(x)));
+        phase[k] = _mm256_add_epi32(phase[k], step[k]);
+      }
+      if (gain) {
+        s = _mm256_mul_ps(s, _mm256_loadu_ps(gain + i));
+      }
+      _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), s));
+    }
+    return i;
+  }
+#elif defined(SINEBANK_SSE2)
+  int processSSE2(float *out, const float *gain, int frames) {
+    const int width = 4;
+    __m128i phase[N], step[N];
+    __m128 amp[N];
+    for (int k = 0; k < N; k++) {
+      uint32_t p = mPhase[k], inc = mInc[k];
+      // SSE2 has no 32 bit multiply, so the lane offsets are set directly
+      phase[k] = _mm_setr_epi32(int32_t(p), int32_t(p + inc),
+                                int32_t(p + 2 * inc), int32_t(p + 3 * inc));
+      step[k] = _mm_set1_epi32(int32_t(inc * width));
+      amp[k] = _mm_set1_ps(mAmp[k]);
+    }
+    const __m128 scale = _mm_set1_ps(sinebank::phaseScale);
+    int i = 0;
+    for (; i + width <= frames; i += width) {
+      __m128 s = _mm_setzero_ps();
+      for (int k = 0; k < N; k++) {
+        __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(phase[k]), scale);
+        s = _mm_add_ps(s, _mm_mul_ps(amp[k], sinebank::sinPi(x)));
+        phase[k] = _mm_add_epi32(phase[k], step[k]);
+      }
+      if (gain) {
+        s = _mm_mul_ps(s, _mm_loadu_ps(gain + i));
+      }
+      _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), s));
+    }
+    return i;
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  int processNEON(float *out, const float *gain, int frames) {
+    const int width = 4;
+    const uint32_t laneInit[4] = {0, 1, 2, 3};
+    const uint32x4_t lane = vld1q_u32(laneInit);
+    uint32x4_t phase[N], step[N];
+    float32x4_t amp[N];
+    for (int k = 0; k < N; k++) {
+      phase[k] = vmlaq_n_u32(vdupq_n_u32(mPhase[k]), lane, mInc[k]);
+      step[k] = vdupq_n_u32(mInc[k] * width);
+      amp[k] = vdupq_n_f32(mAmp[k]);
+    }
+    const float32x4_t scale = vdupq_n_f32(sinebank::phaseScale);
+    int i = 0;
+    for (; i + width <= frames; i += width) {
+      float32x4_t s = vdupq_n_f32(0.0f);
+      for (int k = 0; k < N; k++) {
+        float32x4_t x =
+            vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(phase[k])), scale);
+        s = vmlaq_f32(s, amp[k], sinebank::sinPi(x));
+        phase[k] = vaddq_u32(phase[k], step[k]);
+      }
+      if (gain) {
+        s = vmulq_f32(s, vld1q_f32(gain + i));
+      }
+      vst1q_f32(out + i, vaddq_f32(vld1q_f32(out + i), s));
+    }
+    return i;
+  }
+#endif
+
+  uint32_t mPhase[N];
+  uint32_t mInc[N];
+  float mAmp[N];
+  double mSampleRate{44100.0};
+};
+
+#endif // SineBank_H
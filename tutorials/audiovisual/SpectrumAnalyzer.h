@@ -0,0 +1,587 @@
+#pragma once
+#ifndef SpectrumAnalyzer_H
+#define SpectrumAnalyzer_H
+
+// Short-time spectrum analyzer that takes whole blocks of samples.
+//
+// The visual tutorials fed a gam::STFT one sample at a time, then scaled
+// every bin with tanh(pow(mag, 1.3)) in a scalar loop. This analyzer takes
+// blocks, so the per-sample cost is a copy into its input buffer. Every hop
+// samples it windows the last size() samples and runs a real-input FFT. The
+// magnitudes are then scaled with vectorized kernels: 8 bins per instruction
+// with AVX2, 4 with SSE2 or NEON (64-bit ARM), 1 otherwise. The kernel is
+// chosen at compile time.
+//
+// The FFT is a Backend, so a faster library FFT can be plugged in. The
+// default backend packs the real input into a half-size complex FFT, which
+// uses radix-4 butterflies plus one radix-2 stage when needed.
+//
+// Magnitudes are normalized so that a sine of amplitude 1 that falls on a bin
+// reads 1 whatever the window. The scaling can be:
+//  - MAGNITUDE: the normalized magnitude,
+//  - DECIBELS: 20 * log10(magnitude), floored at -200 dB,
+//  - CURVE: tanh(pow(magnitude, exponent)), as drawn by the tutorials.
+// DECIBELS and CURVE use polynomial log2 and exp2 that are accurate to about
+// 1e-6, far more than a plot needs.
+//
+// configure() and backend() allocate, so call them before audio starts.
+// process() does not allocate.
+//
+// process() runs on the audio thread and spectrum() on the graphics thread.
+// Finished spectra are triple buffered like in SpectrumPool.h: process()
+// fills one buffer, spectrum() reads another, and the third holds the latest
+// finished spectrum. The two swap buffers with one atomic exchange, so
+// neither waits and the graphics thread never sees a half-written spectrum.
+//
+// Usage:
+//   SpectrumAnalyzer analyzer;
+//   analyzer.configure(4096, 1024, SpectrumAnalyzer::HANN);
+//   analyzer.scaling(SpectrumAnalyzer::CURVE, 1.3f);
+//   ...
+//   analyzer.process(io.outBuffer(0), io.framesPerBuffer()); // In onSound()
+//   ...
+//   const float *spectrum = analyzer.spectrum();             // In onDraw()
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPECTRUM_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SPECTRUM_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SPECTRUM_NEON
+#endif
+
+namespace spectrum {
+
+// Operations used by the kernels, for one float at a time
+struct Scalar {
+  typedef float F;
+  typedef int32_t I;
+  static const int width = 1;
+  static F load(const float *p) { return *p; }
+  static void store(float *p, F x) { *p = x; }
+  static F set(float x) { return x; }
+  static F add(F a, F b) { return a + b; }
+  static F sub(F a, F b) { return a - b; }
+  static F mul(F a, F b) { return a * b; }
+  static F div(F a, F b) { return a / b; }
+  static F sqrt(F a) { return std::sqrt(a); }
+  static F min(F a, F b) { return a < b ? a : b; }
+  static F max(F a, F b) { return a > b ? a : b; }
+  // x where a > b, 0 elsewhere
+  static F ifGreater(F a, F b, F x) { return a > b ? x : 0.0f; }
+  static I round(F a) { return I(std::lrint(a)); }
+  static F toFloat(I a) { return F(a); }
+  static I setI(int32_t x) { return x; }
+  static I addI(I a, I b) { return a + b; }
+  static I andI(I a, I b) { return a & b; }
+  static I orI(I a, I b) { return a | b; }
+  static I shiftRight23(I a) { return I(uint32_t(a) >> 23); }
+  static I shiftLeft23(I a) { return I(uint32_t(a) << 23); }
+  static I asInt(F a) {
+    I i;
+    std::memcpy(&i, &a, sizeof(i));
+    return i;
+  }
+  static F asFloat(I a) {
+    F f;
+    std::memcpy(&f, &a, sizeof(f));
+    return f;
+  }
+};
+
+#if defined(SPECTRUM_AVX2)
+struct Simd {
+  typedef __m256 F;
+  typedef __m256i I;
+  static const int width = 8;
+  static F load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, F x) { _mm256_storeu_ps(p, x); }
+  static F set(float x) { return _mm256_set1_ps(x); }
+  static F add(F a, F b) { return _mm256_add_ps(a, b); }
+  static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+  static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+  static F div(F a, F b) { return _mm256_div_ps(a, b); }
+  static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+  static F min(F a, F b) { return _mm256_min_ps(a, b); }
+  static F max(F a, F b) { return _mm256_max_ps(a, b); }
+  static F ifGreater(F a, F b, F x) {
+    return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ), x);
+  }
+  static I round(F a) { return _mm256_cvtps_epi32(a); }
+  static F toFloat(I a) { return _mm256_cvtepi32_ps(a); }
+  static I setI(int32_t x) { return _mm256_set1_epi32(x); }
+  static I addI(I a, I b) { return _mm256_add_epi32(a, b); }
+  static I andI(I a, I b) { return _mm256_and_si256(a, b); }
+  static I orI(I a, I b) { return _mm256_or_si256(a, b); }
+  static I shiftRight23(I a) { return _mm256_srli_epi32(a, 23); }
+  static I shiftLeft23(I a) { return _mm256_slli_epi32(a, 23); }
+  static I asInt(F a) { return _mm256_castps_si256(a); }
+  static F asFloat(I a) { return _mm256_castsi256_ps(a); }
+};
+#elif defined(SPECTRUM_SSE2)
+struct Simd {
+  typedef __m128 F;
+  typedef __m128i I;
+  static const int width = 4;
+  static F load(const float *p) { return _mm_loadu_ps(p); }
+  static void store(float *p, F x) { _mm_storeu_ps(p, x); }
+  static F set(float x) { return _mm_set1_ps(x); }
+  static F add(F a, F b) { return _mm_add_ps(a, b); }
+  static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+  static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+  static F div(F a, F b) { return _mm_div_ps(a, b); }
+  static F sqrt(F a) { return _mm_sqrt_ps(a); }
+  static F min(F a, F b) { return _mm_min_ps(a, b); }
+  static F max(F a, F b) { return _mm_max_ps(a, b); }
+  static F ifGreater(F a, F b, F x) {
+    return _mm_and_ps(_mm_cmpgt_ps(a, b), x);
+  }
+  static I round(F a) { return _mm_cvtps_epi32(a); }
+  static F toFloat(I a) { return _mm_cvtepi32_ps(a); }
+  static I setI(int32_t x) { return _mm_set1_epi32(x); }
+  static I addI(I a, I b) { return _mm_add_epi32(a, b); }
+  static I andI(I a, I b) { return _mm_and_si128(a, b); }
+  static I orI(I a, I b) { return _mm_or_si128(a, b); }
+  static I shiftRight23(I a) { return _mm_srli_epi32(a, 23); }
+  static I shiftLeft23(I a) { return _mm_slli_epi32(a, 23); }
+  static I asInt(F a) { return _mm_castps_si128(a); }
+  static F asFloat(I a) { return _mm_castsi128_ps(a); }
+};
+#elif defined(SPECTRUM_NEON)
+struct Simd {
+  typedef float32x4_t F;
+  typedef int32x4_t I;
+  static const int width = 4;
+  static F load(const float *p) { return vld1q_f32(p); }
+  static void store(float *p, F x) { vst1q_f32(p, x); }
+  static F set(float x) { return vdupq_n_f32(x); }
+  static F add(F a, F b) { return vaddq_f32(a, b); }
+  static F sub(F a, F b) { return vsubq_f32(a, b); }
+  static F mul(F a, F b) { return vmulq_f32(a, b); }
+  static F div(F a, F b) { return vdivq_f32(a, b); }
+  static F sqrt(F a) { return vsqrtq_f32(a); }
+  static F min(F a, F b) { return vminq_f32(a, b); }
+  static F max(F a, F b) { return vmaxq_f32(a, b); }
+  static F ifGreater(F a, F b, F x) {
+    return vreinterpretq_f32_u32(
+        vandq_u32(vcgtq_f32(a, b), vreinterpretq_u32_f32(x)));
+  }
+  static I round(F a) { return vcvtnq_s32_f32(a); }
+  static F toFloat(I a) { return vcvtq_f32_s32(a); }
+  static I setI(int32_t x) { return vdupq_n_s32(x); }
+  static I addI(I a, I b) { return vaddq_s32(a, b); }
+  static I andI(I a, I b) { return vandq_s32(a, b); }
+  static I orI(I a, I b) { return vorrq_s32(a, b); }
+  static I shiftRight23(I a) {
+    return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), 23));
+  }
+  static I shiftLeft23(I a) { return vshlq_n_s32(a, 23); }
+  static I asInt(F a) { return vreinterpretq_s32_f32(a); }
+  static F asFloat(I a) { return vreinterpretq_f32_s32(a); }
+};
+#else
+typedef Scalar Simd;
+#endif
+
+// log2(x) for x > 0. The mantissa is brought into [sqrt(1/2), sqrt(2)) and
+// ln(m) = 2 atanh((m - 1) / (m + 1)) is summed to the 9th power.
+template <class V> typename V::F log2(typename V::F x) {
+  typedef typename V::F F;
+  typename V::I bits = V::asInt(x);
+  F e = V::toFloat(
+      V::addI(V::shiftRight23(bits), V::setI(-127)));
+  F m = V::asFloat(V::orI(V::andI(bits, V::setI(0x007fffff)),
+                          V::setI(0x3f800000)));
+  F above = V::ifGreater(m, V::set(1.41421356f), V::set(1.0f));
+  m = V::sub(m, V::mul(above, V::mul(m, V::set(0.5f))));
+  e = V::add(e, above);
+  F s = V::div(V::sub(m, V::set(1.0f)), V::add(m, V::set(1.0f)));
+  F s2 = V::mul(s, s);
+  F p = V::add(V::set(1.0f / 7.0f), V::mul(s2, V::set(1.0f / 9.0f)));
+  p = V::add(V::set(1.0f / 5.0f), V::mul(s2, p));
+  p = V::add(V::set(1.0f / 3.0f), V::mul(s2, p));
+  p = V::add(V::set(1.0f), V::mul(s2, p));
+  // 2 / ln(2)
+  return V::add(e, V::mul(V::mul(s, p), V::set(2.88539008f)));
+}
+
+// 2^y, with y clamped to [-126, 126]. y is split into a whole power of two
+// and a remainder in [-0.5, 0.5], whose exponential is a 7th order Taylor
+// series.
+template <class V> typename V::F exp2(typename V::F y) {
+  typedef typename V::F F;
+  y = V::max(V::min(y, V::set(126.0f)), V::set(-126.0f));
+  typename V::I i = V::round(y);
+  F t = V::mul(V::sub(y, V::toFloat(i)), V::set(0.693147181f));
+  F p = V::add(V::set(1.0f / 720.0f), V::mul(t, V::set(1.0f / 5040.0f)));
+  p = V::add(V::set(1.0f / 120.0f), V::mul(t, p));
+  p = V::add(V::set(1.0f / 24.0f), V::mul(t, p));
+  p = V::add(V::set(1.0f / 6.0f), V::mul(t, p));
+  p = V::add(V::set(0.5f), V::mul(t, p));
+  p = V::add(V::set(1.0f), V::mul(t, p));
+  p = V::add(V::set(1.0f), V::mul(t, p));
+  return V::mul(p, V::asFloat(V::shiftLeft23(V::addI(i, V::setI(127)))));
+}
+
+// Applies op to n floats of data in place, Simd::width at a time, then one
+// at a time for the tail
+template <class Op> void transform(float *data, int n, Op op) {
+  int i = 0;
+  for (; i + Simd::width <= n; i += Simd::width) {
+    Simd::store(data + i, op(Simd(), Simd::load(data + i)));
+  }
+  for (; i < n; i++) {
+    data[i] = op(Scalar(), data[i]);
+  }
+}
+
+// out[k] = sqrt(re[k]^2 + im[k]^2) * gain
+inline void magnitudes(const float *re, const float *im, float *out, int n,
+                       float gain) {
+  int i = 0;
+  for (; i + Simd::width <= n; i += Simd::width) {
+    Simd::F r = Simd::load(re + i), m = Simd::load(im + i);
+    Simd::F power = Simd::add(Simd::mul(r, r), Simd::mul(m, m));
+    Simd::store(out + i, Simd::mul(Simd::sqrt(power), Simd::set(gain)));
+  }
+  for (; i < n; i++) {
+    out[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]) * gain;
+  }
+}
+
+// 20 * log10(max(x, 1e-10))
+inline void decibels(float *data, int n) {
+  transform(data, n, [](auto v, auto x) {
+    typedef decltype(v) V;
+    // 20 * log10(2)
+    return V::mul(log2<V>(V::max(x, V::set(1e-10f))), V::set(6.02059991f));
+  });
+}
+
+// tanh(pow(x, exponent)) for x >= 0
+inline void curve(float *data, int n, float exponent) {
+  transform(data, n, [exponent](auto v, auto x) {
+    typedef decltype(v) V;
+    auto y = exp2<V>(
+        V::mul(log2<V>(V::max(x, V::set(1e-30f))), V::set(exponent)));
+    // tanh(y) = 1 - 2 / (e^(2y) + 1), and 2 / ln(2) = 2.885...
+    auto e2y = exp2<V>(V::mul(y, V::set(2.88539008f)));
+    return V::sub(V::set(1.0f),
+                  V::div(V::set(2.0f), V::add(e2y, V::set(1.0f))));
+  });
+}
+
+} // namespace spectrum
+
+class SpectrumAnalyzer {
+public:
+  enum Window { RECTANGLE, HANN, HAMMING, BLACKMAN };
+  enum Scaling { MAGNITUDE, DECIBELS, CURVE };
+
+  // Forward FFT of real input. forward() reads size() samples and writes
+  // size() / 2 + 1 bins as separate real and imaginary parts.
+  class Backend {
+  public:
+    virtual ~Backend() {}
+    // Power of two. Called before forward(), not on the audio thread.
+    virtual void size(int n) = 0;
+    virtual void forward(const float *in, float *re, float *im) = 0;
+  };
+
+  // The default backend. Packs even and odd samples into the real and
+  // imaginary parts of a complex FFT of half the size, then splits the
+  // result into the spectrum of the real input.
+  class Radix4Backend : public Backend {
+  public:
+    void size(int n) override {
+      mSize = n;
+      int half = n / 2;
+      mRe.resize(half);
+      mIm.resize(half);
+      mCos.resize(half);
+      mSin.resize(half);
+      for (int i = 0; i < half; i++) {
+        mCos[i] = float(std::cos(2.0 * M_PI * i / half));
+        mSin[i] = float(-std::sin(2.0 * M_PI * i / half));
+      }
+      mSplitCos.resize(half + 1);
+      mSplitSin.resize(half + 1);
+      for (int k = 0; k <= half; k++) {
+        mSplitCos[k] = float(std::cos(2.0 * M_PI * k / n));
+        mSplitSin[k] = float(-std::sin(2.0 * M_PI * k / n));
+      }
+      mReverse.resize(half);
+      int bits = 0;
+      while ((1 << bits) < half) {
+        bits++;
+      }
+      for (int i = 0; i < half; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+          r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        mReverse[i] = r;
+      }
+      mRadix2First = bits % 2 == 1;
+    }
+
+    void forward(const float *in, float *re, float *im) override {
+      int half = mSize / 2;
+      for (int i = 0; i < half; i++) {
+        int r = mReverse[i];
+        mRe[r] = in[2 * i];
+        mIm[r] = in[2 * i + 1];
+      }
+      complexForward(half);
+
+      // X[k] = (Z[k] + conj(Z[half - k])) / 2
+      //        - i W^k (Z[k] - conj(Z[half - k])) / 2,  W = e^(-2 pi i / n)
+      for (int k = 0; k <= half; k++) {
+        int a = k % half, b = (half - k) % half;
+        float evenRe = 0.5f * (mRe[a] + mRe[b]);
+        float evenIm = 0.5f * (mIm[a] - mIm[b]);
+        float oddRe = 0.5f * (mIm[a] + mIm[b]);
+        float oddIm = -0.5f * (mRe[a] - mRe[b]);
+        float c = mSplitCos[k], s = mSplitSin[k];
+        re[k] = evenRe + c * oddRe - s * oddIm;
+        im[k] = evenIm + c * oddIm + s * oddRe;
+      }
+    }
+
+  private:
+    // In place decimation in time FFT of mRe, mIm, already in bit reversed
+    // order
+    void complexForward(int n) {
+      float *re = mRe.data(), *im = mIm.data();
+      int length = 1;
+      if (mRadix2First) {
+        for (int i = 0; i < n; i += 2) {
+          float r = re[i + 1], m = im[i + 1];
+          re[i + 1] = re[i] - r;
+          im[i + 1] = im[i] - m;
+          re[i] += r;
+          im[i] += m;
+        }
+        length = 2;
+      }
+      // Each pass combines four transforms of length into one of 4 * length.
+      // In bit reversed order the four quarters hold the samples 0, 2, 1
+      // and 3 mod 4.
+      for (; length < n; length *= 4) {
+        int stride = n / (4 * length);
+        for (int start = 0; start < n; start += 4 * length) {
+          float *r0 = re + start, *i0 = im + start;
+          for (int k = 0; k < length; k++) {
+            int w1 = k * stride, w2 = 2 * w1, w3 = 3 * w1;
+            float ar = r0[k], ai = i0[k];
+            float br, bi, cr, ci, dr, di;
+            // x[4n + 1] is in the third quarter, x[4n + 2] in the second
+            multiply(r0[k + 2 * length], i0[k + 2 * length], w1, br, bi);
+            multiply(r0[k + length], i0[k + length], w2, cr, ci);
+            multiply(r0[k + 3 * length], i0[k + 3 * length], w3, dr, di);
+            float sum0r = ar + cr, sum0i = ai + ci;
+            float dif0r = ar - cr, dif0i = ai - ci;
+            float sum1r = br + dr, sum1i = bi + di;
+            float dif1r = br - dr, dif1i = bi - di;
+            r0[k] = sum0r + sum1r;
+            i0[k] = sum0i + sum1i;
+            // -i * dif1
+            r0[k + length] = dif0r + dif1i;
+            i0[k + length] = dif0i - dif1r;
+            r0[k + 2 * length] = sum0r - sum1r;
+            i0[k + 2 * length] = sum0i - sum1i;
+            r0[k + 3 * length] = dif0r - dif1i;
+            i0[k + 3 * length] = dif0i + dif1r;
+          }
+        }
+      }
+    }
+
+    void multiply(float r, float i, int w, float &outR, float &outI) const {
+      float c = mCos[w], s = mSin[w];
+      outR = r * c - i * s;
+      outI = r * s + i * c;
+    }
+
+    int mSize{0};
+    bool mRadix2First{false};
+    std::vector<float> mRe, mIm;
+    std::vector<float> mCos, mSin;           // e^(-2 pi i j / (n / 2))
+    std::vector<float> mSplitCos, mSplitSin; // e^(-2 pi i k / n)
+    std::vector<int> mReverse;
+  };
+
+  SpectrumAnalyzer(int size = 1024, int hop = 0, Window window = HANN) {
+    configure(size, hop, window);
+  }
+
+  // size is rounded up to a power of two, at least 4. hop defaults to
+  // size / 4.
+  void configure(int size, int hop = 0, Window window = HANN) {
+    mSize = 4;
+    while (mSize < size) {
+      mSize *= 2;
+    }
+    mHop = hop > 0 ? hop : mSize / 4;
+    mWindowType = window;
+    mWindow.resize(mSize);
+    double sum = 0.0;
+    for (int i = 0; i < mSize; i++) {
+      double phase = 2.0 * M_PI * i / mSize;
+      switch (window) {
+      case RECTANGLE:
+        mWindow[i] = 1.0f;
+        break;
+      case HANN:
+        mWindow[i] = float(0.5 - 0.5 * std::cos(phase));
+        break;
+      case HAMMING:
+        mWindow[i] = float(0.54 - 0.46 * std::cos(phase));
+        break;
+      case BLACKMAN:
+        mWindow[i] = float(0.42 - 0.5 * std::cos(phase) +
+                           0.08 * std::cos(2.0 * phase));
+        break;
+      }
+      sum += mWindow[i];
+    }
+    mGain = float(2.0 / sum);
+    mInput.assign(2 * mSize, 0.0f);
+    mFrame.resize(mSize);
+    mRe.resize(numBins());
+    mIm.resize(numBins());
+    for (auto &buffer : mBuffers) {
+      buffer.assign(numBins(), 0.0f);
+    }
+    mBack = 0;
+    mMiddle.store(1, std::memory_order_relaxed);
+    mFront = 2;
+    mWritePos = 0;
+    mSinceFrame = 0;
+    mFilled = 0;
+    if (!mBackend) {
+      mBackend.reset(new Radix4Backend);
+    }
+    mBackend->size(mSize);
+  }
+
+  // Replaces the FFT. Not for the audio thread.
+  void backend(std::unique_ptr<Backend> backend) {
+    mBackend = std::move(backend);
+    mBackend->size(mSize);
+  }
+
+  void scaling(Scaling scaling, float curveExponent = 1.3f) {
+    mScaling = scaling;
+    mCurveExponent = curveExponent;
+  }
+
+  // Audio thread. Adds n samples. Returns the number of new spectra, the
+  // last of which spectrum() returns from then on.
+  int process(const float *samples, int n) {
+    int frames = 0;
+    while (n > 0) {
+      // Copy up to the next frame or the end of the input buffer
+      int count = std::min(std::min(n, mHop - mSinceFrame), mSize - mWritePos);
+      write(samples, count);
+      samples += count;
+      n -= count;
+      mSinceFrame += count;
+      mFilled = std::min(mFilled + count, mSize);
+      if (mSinceFrame >= mHop) {
+        mSinceFrame = 0;
+        if (mFilled == mSize) {
+          analyze();
+          frames++;
+        }
+      }
+    }
+    return frames;
+  }
+
+  // Graphics thread. The latest finished spectrum, numBins() values. The
+  // pointer stays valid until the next call.
+  const float *spectrum() {
+    if (mMiddle.load(std::memory_order_relaxed) & newFlag) {
+      mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & ~newFlag;
+    }
+    return mBuffers[mFront].data();
+  }
+
+  int numBins() const { return mSize / 2 + 1; }
+  int size() const { return mSize; }
+  int hop() const { return mHop; }
+  Window window() const { return mWindowType; }
+
+private:
+  static const int newFlag = 4;
+
+  // Each sample is written twice, so the last size() samples are always
+  // contiguous at mInput[mWritePos]. mWritePos + n must not pass size().
+  void write(const float *samples, int n) {
+    std::memcpy(&mInput[mWritePos], samples, n * sizeof(float));
+    std::memcpy(&mInput[mWritePos + mSize], samples, n * sizeof(float));
+    mWritePos = (mWritePos + n) & (mSize - 1);
+  }
+
+  void analyze() {
+    const float *input = mInput.data() + mWritePos;
+    for (int i = 0; i < mSize; i++) {
+      mFrame[i] = input[i] * mWindow[i];
+    }
+    mBackend->forward(mFrame.data(), mRe.data(), mIm.data());
+    float *out = mBuffers[mBack].data();
+    spectrum::magnitudes(mRe.data(), mIm.data(), out, numBins(), mGain);
+    // DC and Nyquist have no mirror image
+    out[0] *= 0.5f;
+    out[numBins() - 1] *= 0.5f;
+    switch (mScaling) {
+    case MAGNITUDE:
+      break;
+    case DECIBELS:
+      spectrum::decibels(out, numBins());
+      break;
+    case CURVE:
+      spectrum::curve(out, numBins(), mCurveExponent);
+      break;
+    }
+    mBack = mMiddle.exchange(mBack | newFlag, std::memory_order_acq_rel) &
+            ~newFlag;
+  }
+
+  int mSize{0};
+  int mHop{0};
+  Window mWindowType{HANN};
+  std::vector<float> mWindow;
+  float mGain{1.0f};
+  Scaling mScaling{MAGNITUDE};
+  float mCurveExponent{1.3f};
+  std::unique_ptr<Backend> mBackend;
+
+  std::vector<float> mInput; // 2 * size(), see process()
+  int mWritePos{0};
+  int mSinceFrame{0};
+  int mFilled{0};
+  std::vector<float> mFrame, mRe, mIm;
+
+  // Spectrum buffers. mBack is owned by the audio thread, mFront by the
+  // graphics thread, and mMiddle holds the latest spectrum, or'ed with
+  // newFlag until the graphics thread takes it.
+  std::vector<float> mBuffers[3];
+  int mBack{0};
+  std::atomic<int> mMiddle{1};
+  int mFront{2};
+};
+
+#endif // SpectrumAnalyzer_H
@@ -0,0 +1,198 @@
+#pragma once
+#ifndef SpectrumPool_H
+#define SpectrumPool_H
+
+// Spectra of voice outputs, computed on worker threads.
+//
+// A voice that draws its own spectrum gets an Analysis from the pool in
+// init(). In onProcess() it writes its output to the analysis, which only
+// copies the samples into a lock-free ring. Worker threads read the rings,
+// run a gam::STFT per analysis and publish each new spectrum. The graphics
+// thread reads the latest spectrum with spectrum().
+//
+// Spectra are triple buffered: the worker fills one buffer, the graphics
+// thread reads another, and the third holds the latest finished spectrum. The
+// two sides swap buffers with one atomic exchange, so neither waits for the
+// other and the graphics thread never sees a half-written spectrum.
+//
+// The audio thread never locks, allocates or waits. If the workers fall
+// behind, the samples that don't fit in the ring are dropped and counted in
+// overruns().
+//
+// Usage:
+//   SpectrumPool::Analysis *mAnalysis;
+//   mAnalysis = SpectrumPool::get().add(4096); // In init()
+//   ...
+//   mAnalysis->write(samples, n);              // In onProcess(AudioIOData &)
+//   ...
+//   const float *spectrum = mAnalysis->spectrum(); // In onProcess(Graphics &)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Gamma/DFT.h"
+
+class SpectrumPool {
+public:
+  class Analysis {
+  public:
+    Analysis(unsigned fftSize, unsigned hopSize)
+        : mStft(fftSize, hopSize, 0, gam::HANN, gam::MAG_FREQ),
+          mRing(ringSize) {
+      for (auto &buffer : mBuffers) {
+        buffer.assign(mStft.numBins(), 0.0f);
+      }
+    }
+
+    // Audio thread. Queues n samples for analysis.
+    void write(const float *samples, int n) {
+      uint64_t writeCount = mWriteCount.load(std::memory_order_relaxed);
+      uint64_t space =
+          ringSize - (writeCount - mReadCount.load(std::memory_order_acquire));
+      if (uint64_t(n) > space) {
+        mOverruns.fetch_add(n - space, std::memory_order_relaxed);
+        n = int(space);
+      }
+      for (int i = 0; i < n; i++) {
+        mRing[(writeCount + i) & (ringSize - 1)] = samples[i];
+      }
+      mWriteCount.store(writeCount + n, std::memory_order_release);
+    }
+
+    // Graphics thread. The latest spectrum, numBins() values. The pointer
+    // stays valid until the next call.
+    const float *spectrum() {
+      if (mMiddle.load(std::memory_order_relaxed) & newFlag) {
+        mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) &
+                 ~newFlag;
+      }
+      return mBuffers[mFront].data();
+    }
+
+    unsigned numBins() const { return mStft.numBins(); }
+
+    // Samples dropped because the workers fell behind
+    uint64_t overruns() const {
+      return mOverruns.load(std::memory_order_relaxed);
+    }
+
+  private:
+    friend class SpectrumPool;
+
+    static const uint64_t ringSize = 1 << 15; // Power of 2
+    static const int newFlag = 4;
+
+    // Worker thread. Analyzes the queued samples, returns how many.
+    size_t process() {
+      uint64_t readCount = mReadCount.load(std::memory_order_relaxed);
+      uint64_t writeCount = mWriteCount.load(std::memory_order_acquire);
+      for (uint64_t i = readCount; i < writeCount; i++) {
+        if (mStft(mRing[i & (ringSize - 1)])) {
+          std::vector<float> &back = mBuffers[mBack];
+          for (unsigned k = 0; k < mStft.numBins(); ++k) {
+            // Here we simply scale the complex sample
+            back[k] = std::tanh(std::pow(mStft.bin(k).real(), 1.3f));
+          }
+          mBack = mMiddle.exchange(mBack | newFlag,
+                                   std::memory_order_acq_rel) &
+                  ~newFlag;
+        }
+      }
+      mReadCount.store(writeCount, std::memory_order_release);
+      return size_t(writeCount - readCount);
+    }
+
+    gam::STFT mStft; // Worker thread only
+    std::vector<float> mRing;
+    std::atomic<uint64_t> mWriteCount{0};
+    std::atomic<uint64_t> mReadCount{0};
+    std::atomic<uint64_t> mOverruns{0};
+
+    // Spectrum buffers. mBack is owned by the worker, mFront by the graphics
+    // thread, and mMiddle holds the latest spectrum, or'ed with newFlag until
+    // the graphics thread takes it.
+    std::vector<float> mBuffers[3];
+    int mBack{0};
+    std::atomic<int> mMiddle{1};
+    int mFront{2};
+  };
+
+  // The pool, with its workers started the first time it is used
+  static SpectrumPool &get() {
+    static SpectrumPool pool(
+        std::max(1u, std::thread::hardware_concurrency() / 2));
+    return pool;
+  }
+
+  explicit SpectrumPool(unsigned numWorkers) {
+    mWorkers.resize(numWorkers);
+    for (auto &worker : mWorkers) {
+      worker.reset(new Worker);
+      worker->thread = std::thread(&SpectrumPool::workerFunction, this,
+                                   worker.get());
+    }
+  }
+
+  ~SpectrumPool() {
+    mRunning = false;
+    for (auto &worker : mWorkers) {
+      worker->thread.join();
+    }
+  }
+
+  // Adds an analysis of fftSize points every hopSize samples (default
+  // fftSize / 4). Not for the audio thread. The analysis lives as long as
+  // the pool.
+  Analysis *add(unsigned fftSize, unsigned hopSize = 0) {
+    Worker &worker = *mWorkers[mNextWorker];
+    mNextWorker = (mNextWorker + 1) % mWorkers.size();
+    std::lock_guard<std::mutex> lk(worker.mutex);
+    worker.analyses.emplace_back(
+        new Analysis(fftSize, hopSize > 0 ? hopSize : fftSize / 4));
+    return worker.analyses.back().get();
+  }
+
+  size_t numWorkers() const { return mWorkers.size(); }
+
+private:
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex; // Guards analyses, never taken by the audio thread
+    std::vector<std::unique_ptr<Analysis>> analyses;
+  };
+
+  void workerFunction(Worker *worker) {
+    // Analyses are never removed, so the worker keeps its own list and only
+    // holds the lock to pick up new ones. add() never waits for a pass.
+    std::vector<Analysis *> analyses;
+    while (mRunning) {
+      {
+        std::lock_guard<std::mutex> lk(worker->mutex);
+        for (size_t i = analyses.size(); i < worker->analyses.size(); i++) {
+          analyses.push_back(worker->analyses[i].get());
+        }
+      }
+      size_t processed = 0;
+      for (Analysis *analysis : analyses) {
+        processed += analysis->process();
+      }
+      if (processed == 0) {
+        // The audio thread doesn't notify, so poll
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  size_t mNextWorker{0};
+  std::atomic<bool> mRunning{true};
+};
+
+#endif // SpectrumPool_H
@@ -1,5 +1,7 @@
 // Just Instrument Classes
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio> // for printing to stdout
 
 #include "Gamma/Analysis.h"
@@ -19,17 +21,121 @@
 #include "al/io/al_MIDI.hpp"
 #include "al/math/al_Random.hpp"
 
+#include "BlockProcessing.h"
+#include "ControlRateReson.h"
+#include "MeshCache.h"
+#include "ParamHandle.h"
+#include "SineBank.h"
+#include "SpectrumPool.h"
+#include "WavetableBank.h"
+
 using namespace gam;
 using namespace al;
 using namespace std;
 #define FFT_SIZE 4048
-// tables for oscillator
-gam::ArrayPow2<float> tbSaw(2048), tbSqr(2048), tbImp(2048), tbSin(2048), tbDin(2048),
-    tbPls(2048), tb__1(2048), tb__2(2048), tb__3(2048), tb__4(2048);
 Vec3f randomVec3f(float scale)
 {
   return Vec3f(al::rnd::uniformS(), al::rnd::uniformS(), al::rnd::uniformS()) * scale;
 }
+
+// Adds the mesh the wavetable voices (OscEnv, Vib, FMWT and OscTrm) draw for
+// each value of their "table" parameter
+void addWaveformMesh(Mesh &m, int table)
+{
+  // A[] and C[] are the partial amplitudes and harmonic numbers of each
+  // table in WavetableBank.h. The meshes are drawn from them.
+  float scaler = 0.15;
+  float hscaler = 1;
+  switch (table)
+  {
+  case 0:
+    addCone(m, 1, Vec3f(0, 0, 5), 40, 1); // tbSaw
+    break;
+  case 1:
+    addCube(m); // tbSquare
+    break;
+  case 2:
+    addPrism(m, 1, 1, 1, 100); // tbImp
+    break;
+  case 3:
+    addSphere(m, 0.3, 16, 100); // tbSin
+    break;
+  case 4:
+    addWireBox(m, 2); // tbPls
+    break;
+  case 5:
+  { // tb__1
+    float A[] = {1, 0.4, 0.65, 0.3, 0.18, 0.08, 0, 0};
+    float C[] = {1, 4, 7, 11, 15, 18, 0, 0};
+    for (int i = 0; i < 7; i++)
+    {
+      addWireBox(m, scaler * A[i] * C[i], scaler * A[i + 1] * C[i + 1], 1 + 0.3 * i);
+      // addSphere(m, scaler * A[i], 16, 30);
+    }
+    break;
+  }
+  case 6:
+  { // tb__2, inharmonic partials
+    float A[] = {0.5, 0.8, 0.7, 1, 0.3, 0.4, 0.2, 0.12};
+    float C[] = {3, 4, 7, 8, 11, 12, 15, 16};
+    for (int i = 0; i < 7; i++)
+    {
+      addWireBox(m, scaler * A[i] * C[i], scaler * A[i + 1] * C[i + 1], 1 + 0.3 * i);
+    }
+    break;
+  }
+  case 7:
+  { // tb__3, inharmonic partials
+    float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08, 0, 0};
+    float C[] = {10, 27, 54, 81, 108, 135, 0, 0};
+    for (int i = 0; i < 7; i++)
+    {
+      addWireBox(m, scaler * A[i] * C[i], scaler * A[i + 1] * C[i + 1], 1 + 0.3 * i);
+    }
+    break;
+  }
+  case 8:
+  { // tb__4, harmonics 20-27
+    float A[] = {0.2, 0.4, 0.6, 1, 0.7, 0.5, 0.3, 0.1};
+    for (int i = 0; i < 7; i++)
+    {
+      addWireBox(m, hscaler * A[i], hscaler * A[i + 1], 1 + 0.3 * i);
+    }
+    break;
+  }
+  // Write your own waveform! Add it to WavetableBank.h too.
+  // case 9:
+  // {
+  //   float A[] = {1, 1, 1, 1, 1, 1};
+  //   float C[] = {2, 3, 5, 7, 11, 13}; // prime numbers?
+  //   addPrism(m, scaler * A[0] * C[0], scaler * A[1] * C[1], 1, 100, 27);
+  //   addPrism(m, scaler * A[2] * C[2], scaler * A[3] * C[3], 2, 100, 27 * 2);
+  //   addPrism(m, scaler * A[4] * C[4], scaler * A[5] * C[5], 3, 100, 27 * 3);
+  //   break;
+  // }
+  }
+
+  // Scale and generate normals
+  m.scale(0.4);
+  int Nv = m.vertices().size();
+  for (int k = 0; k < Nv; ++k)
+  {
+    m.color(HSV(float(k) / Nv, 0.3, 1));
+  }
+  if (m.primitive() == Mesh::TRIANGLES)
+  {
+    m.decompress();
+  }
+  m.generateNormals();
+}
+
+// The mesh for a value of the "table" parameter, shared by all wavetable
+// voices
+const Mesh &waveformMesh(int table)
+{
+  return MeshCache::get().mesh("waveform " + std::to_string(table),
+                               [table](Mesh &m) { addWaveformMesh(m, table); });
+}
 // 01_SineEnv
 class SineEnv : public SynthVoice
 {
@@ -41,13 +147,16 @@ public:
   // envelope follower to connect audio output to graphics
   gam::EnvFollow<> mEnvFollow;
   // Draw parameters
-  Mesh mMesh;
+  const Mesh *mMesh;
   double a = 0;
   double b = 0;
   double timepose = 0;
   Vec3f note_position;
   Vec3f note_direction;
 
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pPan;
+
   // Additional members
   // Initialize voice. This function will only be called once per voice when
   // it is created. Voices will be reused if they are idle.
@@ -59,9 +168,7 @@ public:
     mAmpEnv.sustainPoint(2); // Make point 2 sustain until a release is issued
 
     // We have the mesh be a sphere
-    addSphere(mMesh, 0.3, 50, 50);
-    mMesh.decompress();
-    mMesh.generateNormals();
+    mMesh = &MeshCache::get().sphere(0.3, 50, 50);
 
     // This is a quick way to create parameters for the voice. Trigger
     // parameters are meant to be set only when the voice starts, i.e. they
@@ -69,11 +176,11 @@ public:
     // change them while you are prototyping, but their changes will only be
     // stored and aplied when a note is triggered.)
 
-    createInternalTriggerParameter("amplitude", 0.3, 0.0, 1.0);
-    createInternalTriggerParameter("frequency", 60, 20, 5000);
-    createInternalTriggerParameter("attackTime", 1.0, 0.01, 3.0);
-    createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0);
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
+    pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.3, 0.0, 1.0));
+    pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+    pAttackTime.bind(createInternalTriggerParameter("attackTime", 1.0, 0.01, 3.0));
+    pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0));
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
 
     // Initalize MIDI device input
   }
@@ -87,19 +194,23 @@ public:
     // voice, rather than having to trigger a new voice to hear the changes.
     // Parameters will update values once per audio callback because they
     // are outside the sample processing loop.
-    mOsc.freq(getInternalParameterValue("frequency"));
-    mAmpEnv.lengths()[0] = getInternalParameterValue("attackTime");
-    mAmpEnv.lengths()[2] = getInternalParameterValue("releaseTime");
-    mPan.pos(getInternalParameterValue("pan"));
-    while (io())
-    {
-      float s1 = mOsc() * mAmpEnv() * getInternalParameterValue("amplitude");
-      float s2;
-      mEnvFollow(s1);
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+    mOsc.freq(pFrequency.get());
+    mAmpEnv.lengths()[0] = pAttackTime.get();
+    mAmpEnv.lengths()[2] = pReleaseTime.get();
+    mPan.pos(pPan.get());
+    float amp = pAmplitude.get();
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
+      block::generate(mOsc, s1, n);
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, amp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
     // We need to let the synth know that this voice is done
     // by calling the free(). This takes the voice out of the
     // rendering chain
@@ -115,8 +226,8 @@ public:
     timepose += 0.02;
     // Get the paramter values on every video frame, to apply changes to the
     // current instance
-    float frequency = getInternalParameterValue("frequency");
-    float amplitude = getInternalParameterValue("amplitude");
+    float frequency = pFrequency.get();
+    float amplitude = pAmplitude.get();
     // Now draw
     g.pushMatrix();
     g.depthTesting(true);
@@ -126,7 +237,7 @@ public:
     g.rotate(b, Vec3f(1));
     g.scale(0.3 + mAmpEnv() * 0.2, 0.3 + mAmpEnv() * 0.5, amplitude);
     g.color(HSV(frequency / 1000, 0.5 + mAmpEnv() * 0.1, 0.3 + 0.5 * mAmpEnv()));
-    g.draw(mMesh);
+    g.draw(*mMesh);
     g.popMatrix();
   }
 
@@ -135,7 +246,7 @@ public:
   // the voice from the processing chain.
   void onTriggerOn() override
   {
-    float angle = getInternalParameterValue("frequency") / 200;
+    float angle = pFrequency.get() / 200;
     mAmpEnv.reset();
     a = al::rnd::uniform();
     b = al::rnd::uniform();
@@ -159,13 +270,16 @@ class OscEnv : public SynthVoice {
   int mtable;
   // Additional members
   static const int numb_waveform = 9;
-  Mesh mMesh[numb_waveform];
+  const Mesh *mMesh[numb_waveform];
   bool wireframe = false;
-  bool vertexLight = false;
   double a_rotate = 0;
   double b_rotate = 0;
   double timepose = 0;
 
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pSustain,
+      pCurve, pPan, pTable;
+
   // Initialize voice. This function will nly be called once per voice
   void init() override {
     // Intialize envelope
@@ -174,115 +288,39 @@ class OscEnv : public SynthVoice {
                    0);  // These tables are not normalized, so scale to 0.3
     mAmpEnv.sustainPoint(2);  // Make point 2 sustain until a release is issued
 
-    createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0);
-    createInternalTriggerParameter("frequency", 60, 20, 5000);
-    createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseTime", 1.0, 0.1, 10.0);
-    createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0);
-    createInternalTriggerParameter("curve", 4.0, -10.0, 10.0);
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
-    createInternalTriggerParameter("table", 0, 0, 8);
-
-    // Table & Visual meshes
-    // Now We have the mesh according to the waveform
-    gam::addSinesPow<1>(tbSaw, 9, 1);
-    addCone(mMesh[0],1, Vec3f(0,0,5), 40, 1); //tbSaw
-
-    gam::addSinesPow<1>(tbSqr, 9, 2);
-    addCube(mMesh[1]);  // tbSquare
-
-    gam::addSinesPow<0>(tbImp, 9, 1);
-    addPrism(mMesh[2],1,1,1,100); // tbImp
-
-    gam::addSine(tbSin);
-    addSphere(mMesh[3], 0.3, 16, 100); // tbSin
-
-// About: addSines (dst, amps, cycs, numh)
-// \param[out] dst		destination array
-// \param[in] amps		harmonic amplitudes of series, size must be numh - A[]
-// \param[in] cycs		harmonic numbers of series, size must be numh - C[]
-// \param[in] numh		total number of harmonics
-    float scaler = 0.15;
-    float hscaler = 1;
-
-    { //tbPls
-      float A[] = {1, 1, 1, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tbPls, A, 8); 
-      addWireBox(mMesh[4],2);    // tbPls
-    }
-    { // tb__1 
-      float A[] = {1, 0.4, 0.65, 0.3, 0.18, 0.08, 0, 0};
-      float C[] = {1, 4, 7, 11, 15, 18, 0, 0 };
-      gam::addSines(tb__1, A, C, 6);
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[5], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-
-        // addSphere(mMesh[5],scaler * A[i], 16, 30); // tb__1
-      }
-    }
-    { // inharmonic partials
-      float A[] = {0.5, 0.8, 0.7, 1, 0.3, 0.4, 0.2, 0.12};
-      float C[] = {3, 4, 7, 8, 11, 12, 15, 16}; 
-      gam::addSines(tb__2, A, C, 8); // tb__2
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[6], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-      }
-    }
-    { // inharmonic partials
-      float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08, 0 , 0};
-      float C[] = {10, 27, 54, 81, 108, 135, 0, 0};
-      gam::addSines(tb__3, A, C, 6); // tb__3
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[7], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-      }
-    }
-  { // harmonics 20-27
-      float A[] = {0.2, 0.4, 0.6, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tb__4, A, 8, 20); // tb__4
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[8], hscaler * A[i], hscaler * A[i+1], 1 + 0.3*i);
-      }
-    }
-    // { // Write your own waveform!
-    //   float A[] = {1, 1, 1, 1, 1, 1};
-    //   float C[] = {2, 3, 5, 7, 11, 13}; // prime numbers?
-    //   gam::addSines(tb__3, A, C, 6);
-    //   addPrism(mMesh[7], scaler * A[0]*C[0], scaler * A[1]*C[1], 1, 100, 27);// tb__2
-    //   addPrism(mMesh[7], scaler * A[2]*C[2], scaler * A[3]*C[3], 2, 100, 27*2);// tb__2
-    //   addPrism(mMesh[7], scaler * A[4]*C[4], scaler * A[5]*C[5], 3, 100, 27*3); // tb__3
-    // }
-
-
-//int addSurfaceLoop(Mesh& m, int Nx, int Ny, int loopMode, double width, double height, double x, double y) 
+    pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0));
+    pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+    pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+    pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 1.0, 0.1, 10.0));
+    pSustain.bind(createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0));
+    pCurve.bind(createInternalTriggerParameter("curve", 4.0, -10.0, 10.0));
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
+    pTable.bind(createInternalTriggerParameter("table", 0, 0, 8));
 
+    // The oscillator tables are shared by all voices and built once
+    WavetableBank::get();
 
-    // Scale and generate normals
+    // Visual meshes, shared by all voices
     for (int i = 0; i < numb_waveform; ++i) {
-      mMesh[i].scale(0.4);
-
-      int Nv = mMesh[i].vertices().size();
-      for (int k = 0; k < Nv; ++k) {
-        mMesh[i].color(HSV(float(k) / Nv, 0.3, 1));
-      }
-
-      if (!vertexLight && mMesh[i].primitive() == Mesh::TRIANGLES) {
-        mMesh[i].decompress();
-      }
-      mMesh[i].generateNormals();
+      mMesh[i] = &waveformMesh(i);
     }
   }
 
   virtual void onProcess(AudioIOData& io) override {
     updateFromParameters();
-    while (io()) {
-      float s1 =
-          0.1 * mOsc() * mAmpEnv() * getInternalParameterValue("amplitude");
-      float s2;
-      mEnvFollow(s1);
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+    float amp = pAmplitude.get();
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
+      block::generate(mOsc, s1, n);
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, 0.1f * amp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
     // We need to let the synth know that this voice is done
     // by calling the free(). This takes the voice out of the
     // rendering chain
@@ -293,9 +331,9 @@ class OscEnv : public SynthVoice {
     a_rotate += 0.81;
     b_rotate += 0.78;
     timepose -= 0.06;
-    float frequency = getInternalParameterValue("frequency");
-    float amplitude = getInternalParameterValue("amplitude");
-    int shape = getInternalParameterValue("table");
+    float frequency = pFrequency.get();
+    float amplitude = pAmplitude.get();
+    int shape = pTable.get();
 
     // static Light light;
     g.polygonMode(wireframe ? GL_LINE : GL_FILL);
@@ -305,12 +343,12 @@ class OscEnv : public SynthVoice {
     // g.light(light);
     g.pushMatrix();
     g.depthTesting(true);
-    g.translate( timepose, getInternalParameterValue("frequency") / 200 - 3 , -15);
+    g.translate( timepose, pFrequency.get() / 200 - 3 , -15);
     g.rotate(a_rotate, Vec3f(0, 1, 1));
     g.rotate(b_rotate, Vec3f(1));    
     g.scale(0.5 + mAmpEnv() * 2, 0.5 + mAmpEnv() * 2, 0.03 + 0.1*mAmpEnv() );
     g.color(HSV(frequency / 1000, 0.6 + mAmpEnv() * 0.1, 0.6 + 0.5 * mAmpEnv()));
-    g.draw(mMesh[shape]);
+    g.draw(*mMesh[shape]);
     g.popMatrix();
   } 
 
@@ -324,45 +362,18 @@ class OscEnv : public SynthVoice {
   virtual void onTriggerOff() override { mAmpEnv.triggerRelease(); }
 
   void updateFromParameters() {
-    mOsc.freq(getInternalParameterValue("frequency"));
-    mAmpEnv.attack(getInternalParameterValue("attackTime"));
-    mAmpEnv.decay(getInternalParameterValue("attackTime"));
-    mAmpEnv.release(getInternalParameterValue("releaseTime"));
-    mAmpEnv.sustain(getInternalParameterValue("sustain"));
-    mAmpEnv.curve(getInternalParameterValue("curve"));
-    mPan.pos(getInternalParameterValue("pan"));
+    mOsc.freq(pFrequency.get());
+    mAmpEnv.attack(pAttackTime.get());
+    mAmpEnv.decay(pAttackTime.get());
+    mAmpEnv.release(pReleaseTime.get());
+    mAmpEnv.sustain(pSustain.get());
+    mAmpEnv.curve(pCurve.get());
+    mPan.pos(pPan.get());
   }
   void updateWaveform(){
-        // Map table number to table in memory
-    switch (int(getInternalParameterValue("table"))) {
-      case 0:
-        mOsc.source(tbSaw);
-        break;
-      case 1:
-        mOsc.source(tbSqr);
-        break;
-      case 2:
-        mOsc.source(tbImp);
-        break;
-      case 3:
-        mOsc.source(tbSin);
-        break;
-      case 4:
-        mOsc.source(tbPls);
-        break;
-      case 5:
-        mOsc.source(tb__1);
-        break;
-      case 6:
-        mOsc.source(tb__2);
-        break;
-      case 7:
-        mOsc.source(tb__3);
-        break;
-      case 8:
-        mOsc.source(tb__4);
-        break;
-    }
+    // Band-limited table for the note's frequency
+    mOsc.source(
+        WavetableBank::get().table(int(pTable.get()), pFrequency.get()));
   }
 
 };
@@ -380,15 +391,18 @@ class Vib : public SynthVoice {
   int mtable;
   // Additional members
   static const int numb_waveform = 9;
-  Mesh mMesh[numb_waveform];
+  const Mesh *mMesh[numb_waveform];
   bool wireframe = false;
-  bool vertexLight = false;
   double a_rotate = 0;
   double b_rotate = 0;
   double timepose = 0;
   float vibValue;
   float outFreq;
   
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pSustain,
+      pCurve, pPan, pTable, pVibRate1, pVibRate2, pVibRise, pVibDepth;
+
   // Initialize voice. This function will nly be called once per voice
   void init() override {
     // Intialize envelope
@@ -398,114 +412,54 @@ class Vib : public SynthVoice {
     mAmpEnv.sustainPoint(2);  // Make point 2 sustain until a release is issued
     mVibEnv.curve(0);
 
-    createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0);
-    createInternalTriggerParameter("frequency", 60, 20, 5000);
-    createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseTime", 1.0, 0.1, 10.0);
-    createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0);
-    createInternalTriggerParameter("curve", 4.0, -10.0, 10.0);
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
-    createInternalTriggerParameter("table", 0, 0, 8);
-    createInternalTriggerParameter("vibRate1", 3.5, 0.2, 20);
-    createInternalTriggerParameter("vibRate2", 5.8, 0.2, 20);
-    createInternalTriggerParameter("vibRise", 0.5, 0.1, 2);
-    createInternalTriggerParameter("vibDepth", 0.005, 0.0, 0.3);
-
-    // Table & Visual meshes
-    // Now We have the mesh according to the waveform
-    gam::addSinesPow<1>(tbSaw, 9, 1);
-    addCone(mMesh[0],1, Vec3f(0,0,5), 40, 1); //tbSaw
-
-    gam::addSinesPow<1>(tbSqr, 9, 2);
-    addCube(mMesh[1]);  // tbSquare
-
-    gam::addSinesPow<0>(tbImp, 9, 1);
-    addPrism(mMesh[2],1,1,1,100); // tbImp
-
-    gam::addSine(tbSin);
-    addSphere(mMesh[3], 0.3, 16, 100); // tbSin
-
-// About: addSines (dst, amps, cycs, numh)
-// \param[out] dst		destination array
-// \param[in] amps		harmonic amplitudes of series, size must be numh - A[]
-// \param[in] cycs		harmonic numbers of series, size must be numh - C[]
-// \param[in] numh		total number of harmonics
-    float scaler = 0.15;
-    float hscaler = 1;
-
-    { //tbPls
-      float A[] = {1, 1, 1, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tbPls, A, 8); 
-      addWireBox(mMesh[4],2);    // tbPls
-    }
-    { // tb__1 
-      float A[] = {1, 0.4, 0.65, 0.3, 0.18, 0.08, 0, 0};
-      float C[] = {1, 4, 7, 11, 15, 18, 0, 0 };
-      gam::addSines(tb__1, A, C, 6);
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[5], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-
-        // addSphere(mMesh[5],scaler * A[i], 16, 30); // tb__1
-      }
-    }
-    { // inharmonic partials
-      float A[] = {0.5, 0.8, 0.7, 1, 0.3, 0.4, 0.2, 0.12};
-      float C[] = {3, 4, 7, 8, 11, 12, 15, 16}; 
-      gam::addSines(tb__2, A, C, 8); // tb__2
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[6], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-      }
-    }
-    { // inharmonic partials
-      float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08, 0 , 0};
-      float C[] = {10, 27, 54, 81, 108, 135, 0, 0};
-      gam::addSines(tb__3, A, C, 6); // tb__3
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[7], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-      }
-    }
-  { // harmonics 20-27
-      float A[] = {0.2, 0.4, 0.6, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tb__4, A, 8, 20); // tb__4
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[8], hscaler * A[i], hscaler * A[i+1], 1 + 0.3*i);
-      }
-    }
-
-    // Scale and generate normals
+    pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0));
+    pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+    pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+    pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 1.0, 0.1, 10.0));
+    pSustain.bind(createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0));
+    pCurve.bind(createInternalTriggerParameter("curve", 4.0, -10.0, 10.0));
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
+    pTable.bind(createInternalTriggerParameter("table", 0, 0, 8));
+    pVibRate1.bind(createInternalTriggerParameter("vibRate1", 3.5, 0.2, 20));
+    pVibRate2.bind(createInternalTriggerParameter("vibRate2", 5.8, 0.2, 20));
+    pVibRise.bind(createInternalTriggerParameter("vibRise", 0.5, 0.1, 2));
+    pVibDepth.bind(createInternalTriggerParameter("vibDepth", 0.005, 0.0, 0.3));
+
+    // The oscillator tables are shared by all voices and built once
+    WavetableBank::get();
+
+    // Visual meshes, shared by all voices
     for (int i = 0; i < numb_waveform; ++i) {
-      mMesh[i].scale(0.4);
-
-      int Nv = mMesh[i].vertices().size();
-      for (int k = 0; k < Nv; ++k) {
-        mMesh[i].color(HSV(float(k) / Nv, 0.3, 1));
-      }
-
-      if (!vertexLight && mMesh[i].primitive() == Mesh::TRIANGLES) {
-        mMesh[i].decompress();
-      }
-      mMesh[i].generateNormals();
+      mMesh[i] = &waveformMesh(i);
     }
   }
 
   //
   virtual void onProcess(AudioIOData& io) override {
     updateFromParameters();
-    float oscFreq = getInternalParameterValue("frequency");
-    float vibDepth = getInternalParameterValue("vibDepth");
+    float oscFreq = pFrequency.get();
+    float vibDepth = pVibDepth.get();
+    float amp = pAmplitude.get();
     outFreq = oscFreq + vibValue * vibDepth * oscFreq;
-    while (io()) {
-      mVib.freq(mVibEnv());
-      vibValue = mVib();
-       mOsc.freq(outFreq);
-      float s1 =
-          0.1 * mOsc() * mAmpEnv() * getInternalParameterValue("amplitude");
-      float s2;
-      mEnvFollow(s1);
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+    // The vibrato is applied once per block, so only its last value is
+    // needed
+    mOsc.freq(outFreq);
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
+      for (int i = 0; i < n; i++) {
+        mVib.freq(mVibEnv());
+        vibValue = mVib();
+      }
+      block::generate(mOsc, s1, n);
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, 0.1f * amp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
     // We need to let the synth know that this voice is done
     // by calling the free(). This takes the voice out of the
     // rendering chain
@@ -516,7 +470,7 @@ class Vib : public SynthVoice {
     a_rotate += 0.81;
     b_rotate += 0.78;
     timepose -= 0.06;
-    int shape = getInternalParameterValue("table");
+    int shape = pTable.get();
     // static Light light;
     g.polygonMode(wireframe ? GL_LINE : GL_FILL);
     // light.pos(0, 0, 0);
@@ -530,7 +484,7 @@ class Vib : public SynthVoice {
     g.rotate(b_rotate, Vec3f(1));    
     g.scale(0.5 + mAmpEnv() * 2, 0.5 + mAmpEnv() * 2, 0.03 + 0.1*mAmpEnv() );
     g.color(HSV(outFreq / 1000, 0.6 + mAmpEnv() * 0.1, 0.6 + 0.5 * mAmpEnv()));
-    g.draw(mMesh[shape]);
+    g.draw(*mMesh[shape]);
     g.popMatrix();
   } 
 
@@ -548,52 +502,25 @@ class Vib : public SynthVoice {
   }
 
   void updateFromParameters() {
-    mOsc.freq(getInternalParameterValue("frequency"));
-    mAmpEnv.attack(getInternalParameterValue("attackTime"));
-    mAmpEnv.decay(getInternalParameterValue("attackTime"));
-    mAmpEnv.release(getInternalParameterValue("releaseTime"));
-    mAmpEnv.sustain(getInternalParameterValue("sustain"));
-    mAmpEnv.curve(getInternalParameterValue("curve"));
-    mPan.pos(getInternalParameterValue("pan"));
-    mVibEnv.levels(getInternalParameterValue("vibRate1"),
-                   getInternalParameterValue("vibRate2"),
-                   getInternalParameterValue("vibRate2"),
-                   getInternalParameterValue("vibRate1"));
-    mVibEnv.lengths()[0] = getInternalParameterValue("vibRise");
-    mVibEnv.lengths()[1] = getInternalParameterValue("vibRise");
-    mVibEnv.lengths()[3] = getInternalParameterValue("vibRise");
+    mOsc.freq(pFrequency.get());
+    mAmpEnv.attack(pAttackTime.get());
+    mAmpEnv.decay(pAttackTime.get());
+    mAmpEnv.release(pReleaseTime.get());
+    mAmpEnv.sustain(pSustain.get());
+    mAmpEnv.curve(pCurve.get());
+    mPan.pos(pPan.get());
+    mVibEnv.levels(pVibRate1.get(),
+                   pVibRate2.get(),
+                   pVibRate2.get(),
+                   pVibRate1.get());
+    mVibEnv.lengths()[0] = pVibRise.get();
+    mVibEnv.lengths()[1] = pVibRise.get();
+    mVibEnv.lengths()[3] = pVibRise.get();
   }
   void updateWaveform(){
-        // Map table number to table in memory
-    switch (int(getInternalParameterValue("table"))) {
-      case 0:
-        mOsc.source(tbSaw);
-        break;
-      case 1:
-        mOsc.source(tbSqr);
-        break;
-      case 2:
-        mOsc.source(tbImp);
-        break;
-      case 3:
-        mOsc.source(tbSin);
-        break;
-      case 4:
-        mOsc.source(tbPls);
-        break;
-      case 5:
-        mOsc.source(tb__1);
-        break;
-      case 6:
-        mOsc.source(tb__2);
-        break;
-      case 7:
-        mOsc.source(tb__3);
-        break;
-      case 8:
-        mOsc.source(tb__4);
-        break;
-    }
+    // Band-limited for the top of the vibrato
+    mOsc.source(WavetableBank::get().table(
+        int(pTable.get()), pFrequency.get() * (1 + pVibDepth.get())));
   }
 
 };
@@ -613,13 +540,18 @@ public:
   double a = 0;
   double b = 0;
   double timepose = 10;
-  Mesh ball;
+  const Mesh *ball;
 
   // Additional members
   float mVibFrq;
   float mVibDepth;
   float mVibRise;
 
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pFrequency, pAmplitude, pAttackTime, pReleaseTime, pSustain,
+      pIdx1, pIdx2, pIdx3, pCarMul, pModMul, pVibRate1, pVibRate2, pVibRise,
+      pVibDepth, pPan;
+
   void init() override
   {
     mAmpEnv.curve(0); // linear segments
@@ -629,31 +561,29 @@ public:
     mModEnv.levels(0, 1, 1, 0);
     mVibEnv.levels(0, 1, 1, 0);
     //      mVibEnv.curve(0);
-    addSphere(ball, 1, 100, 100);
-    ball.decompress();
-    ball.generateNormals();
+    ball = &MeshCache::get().sphere(1, 100, 100);
 
     // We have the mesh be a sphere
-    createInternalTriggerParameter("frequency", 440, 10, 4000.0);
-    createInternalTriggerParameter("amplitude", 0.05, 0.0, 1.0);
-    createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseTime", 0.5, 0.1, 10.0);
-    createInternalTriggerParameter("sustain", 0.65, 0.1, 1.0);
+    pFrequency.bind(createInternalTriggerParameter("frequency", 440, 10, 4000.0));
+    pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.05, 0.0, 1.0));
+    pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+    pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 0.5, 0.1, 10.0));
+    pSustain.bind(createInternalTriggerParameter("sustain", 0.65, 0.1, 1.0));
 
     // FM index
-    createInternalTriggerParameter("idx1", 0.01, 0.0, 10.0);
-    createInternalTriggerParameter("idx2", 7, 0.0, 10.0);
-    createInternalTriggerParameter("idx3", 5, 0.0, 10.0);
+    pIdx1.bind(createInternalTriggerParameter("idx1", 0.01, 0.0, 10.0));
+    pIdx2.bind(createInternalTriggerParameter("idx2", 7, 0.0, 10.0));
+    pIdx3.bind(createInternalTriggerParameter("idx3", 5, 0.0, 10.0));
 
-    createInternalTriggerParameter("carMul", 1, 0.0, 20.0);
-    createInternalTriggerParameter("modMul", 1.0007, 0.0, 20.0);
+    pCarMul.bind(createInternalTriggerParameter("carMul", 1, 0.0, 20.0));
+    pModMul.bind(createInternalTriggerParameter("modMul", 1.0007, 0.0, 20.0));
 
-    createInternalTriggerParameter("vibRate1", 0.01, 0.0, 10.0);
-    createInternalTriggerParameter("vibRate2", 0.5, 0.0, 10.0);
-    createInternalTriggerParameter("vibRise", 0, 0.0, 10.0);
-    createInternalTriggerParameter("vibDepth", 0, 0.0, 10.0);
+    pVibRate1.bind(createInternalTriggerParameter("vibRate1", 0.01, 0.0, 10.0));
+    pVibRate2.bind(createInternalTriggerParameter("vibRate2", 0.5, 0.0, 10.0));
+    pVibRise.bind(createInternalTriggerParameter("vibRise", 0, 0.0, 10.0));
+    pVibDepth.bind(createInternalTriggerParameter("vibDepth", 0, 0.0, 10.0));
 
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
   }
 
   //
@@ -661,22 +591,29 @@ public:
   {
     mVib.freq(mVibEnv());
     float carBaseFreq =
-        getInternalParameterValue("frequency") * getInternalParameterValue("carMul");
+        pFrequency.get() * pCarMul.get();
     float modScale =
-        getInternalParameterValue("frequency") * getInternalParameterValue("modMul");
-    float amp = getInternalParameterValue("amplitude");
-    while (io())
-    {
-      mVib.freq(mVibEnv());
-      car.freq((1 + mVib() * mVibDepth) * carBaseFreq +
-               mod() * mModEnv() * modScale);
-      float s1 = car() * mAmpEnv() * amp;
-      float s2;
-      mEnvFollow(s1);
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+        pFrequency.get() * pModMul.get();
+    float amp = pAmplitude.get();
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
+      // The carrier frequency changes every sample, so it stays a loop
+      for (int i = 0; i < n; i++)
+      {
+        mVib.freq(mVibEnv());
+        car.freq((1 + mVib() * mVibDepth) * carBaseFreq +
+                 mod() * mModEnv() * modScale);
+        s1[i] = car();
+      }
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, amp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
     if (mAmpEnv.done() && (mEnvFollow.value() < 0.001))
       free();
   }
@@ -689,13 +626,13 @@ public:
     g.pushMatrix();
     g.depthTesting(true);
     g.lighting(true);
-    g.translate(timepose, getInternalParameterValue("frequency") / 200 - 3, -15);
+    g.translate(timepose, pFrequency.get() / 200 - 3, -15);
     g.rotate(mVib() + a, Vec3f(0, 1, 0));
     g.rotate(mVibDepth + b, Vec3f(1));
-    float scaling = getInternalParameterValue("amplitude") / 10;
-    g.scale(scaling + getInternalParameterValue("modMul") / 10, scaling + getInternalParameterValue("carMul") / 30, scaling + mEnvFollow.value() * 5);
-    g.color(HSV(getInternalParameterValue("modMul") / 20, getInternalParameterValue("carMul") / 20, 0.5 + getInternalParameterValue("attackTime")));
-    g.draw(ball);
+    float scaling = pAmplitude.get() / 10;
+    g.scale(scaling + pModMul.get() / 10, scaling + pCarMul.get() / 30, scaling + mEnvFollow.value() * 5);
+    g.color(HSV(pModMul.get() / 20, pCarMul.get() / 20, 0.5 + pAttackTime.get()));
+    g.draw(*ball);
     g.popMatrix();
   }
 
@@ -710,7 +647,7 @@ public:
     updateFromParameters();
 
     float modFreq =
-        getInternalParameterValue("frequency") * getInternalParameterValue("modMul");
+        pFrequency.get() * pModMul.get();
     mod.freq(modFreq);
   }
   void onTriggerOff() override
@@ -722,28 +659,28 @@ public:
 
   void updateFromParameters()
   {
-    mModEnv.levels()[0] = getInternalParameterValue("idx1");
-    mModEnv.levels()[1] = getInternalParameterValue("idx2");
-    mModEnv.levels()[2] = getInternalParameterValue("idx2");
-    mModEnv.levels()[3] = getInternalParameterValue("idx3");
-
-    mAmpEnv.attack(getInternalParameterValue("attackTime"));
-    mAmpEnv.release(getInternalParameterValue("releaseTime"));
-    mAmpEnv.sustain(getInternalParameterValue("sustain"));
-
-    mModEnv.lengths()[0] = getInternalParameterValue("attackTime");
-    mModEnv.lengths()[3] = getInternalParameterValue("releaseTime");
-
-    mVibEnv.levels(getInternalParameterValue("vibRate1"),
-                   getInternalParameterValue("vibRate2"),
-                   getInternalParameterValue("vibRate2"),
-                   getInternalParameterValue("vibRate1"));
-    mVibEnv.lengths()[0] = getInternalParameterValue("vibRise");
-    mVibEnv.lengths()[1] = getInternalParameterValue("vibRise");
-    mVibEnv.lengths()[3] = getInternalParameterValue("vibRise");
-    mVibDepth = getInternalParameterValue("vibDepth");
+    mModEnv.levels()[0] = pIdx1.get();
+    mModEnv.levels()[1] = pIdx2.get();
+    mModEnv.levels()[2] = pIdx2.get();
+    mModEnv.levels()[3] = pIdx3.get();
+
+    mAmpEnv.attack(pAttackTime.get());
+    mAmpEnv.release(pReleaseTime.get());
+    mAmpEnv.sustain(pSustain.get());
+
+    mModEnv.lengths()[0] = pAttackTime.get();
+    mModEnv.lengths()[3] = pReleaseTime.get();
+
+    mVibEnv.levels(pVibRate1.get(),
+                   pVibRate2.get(),
+                   pVibRate2.get(),
+                   pVibRate1.get());
+    mVibEnv.lengths()[0] = pVibRise.get();
+    mVibEnv.lengths()[1] = pVibRise.get();
+    mVibEnv.lengths()[3] = pVibRise.get();
+    mVibDepth = pVibDepth.get();
     
-    mPan.pos(getInternalParameterValue("pan"));
+    mPan.pos(pPan.get());
   }
 };
 
@@ -769,9 +706,13 @@ public:
   float mVibRise;
   int mtable;
   static const int numb_waveform = 9;
-  Mesh mMesh[numb_waveform];
+  const Mesh *mMesh[numb_waveform];
   bool wireframe = false;
-  bool vertexLight = false;
+
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pFrequency, pAmplitude, pAttackTime, pReleaseTime, pSustain,
+      pIdx1, pIdx2, pIdx3, pCarMul, pModMul, pVibRate1, pVibRate2, pVibRise,
+      pVibDepth, pPan, pTable;
 
   void init() override
   {
@@ -782,102 +723,34 @@ public:
     mAmpEnv.sustainPoint(2);
 
     // We have the mesh be a sphere
-    createInternalTriggerParameter("frequency", 440, 10, 4000.0);
-    createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0);
-    createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseTime", 0.3, 0.1, 10.0);
-    createInternalTriggerParameter("sustain", 0.65, 0.1, 1.0);
+    pFrequency.bind(createInternalTriggerParameter("frequency", 440, 10, 4000.0));
+    pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0));
+    pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+    pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 0.3, 0.1, 10.0));
+    pSustain.bind(createInternalTriggerParameter("sustain", 0.65, 0.1, 1.0));
 
     // FM index
-    createInternalTriggerParameter("idx1", 0.01, 0.0, 10.0);
-    createInternalTriggerParameter("idx2", 7, 0.0, 10.0);
-    createInternalTriggerParameter("idx3", 5, 0.0, 10.0);
-
-    createInternalTriggerParameter("carMul", 1, 0.0, 20.0);
-    createInternalTriggerParameter("modMul", 1.0007, 0.0, 20.0);
-
-    createInternalTriggerParameter("vibRate1", 0.01, 0.0, 10.0);
-    createInternalTriggerParameter("vibRate2", 0.5, 0.0, 10.0);
-    createInternalTriggerParameter("vibRise", 0, 0.0, 10.0);
-    createInternalTriggerParameter("vibDepth", 0, 0.0, 10.0);
-
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
-    createInternalTriggerParameter("table", 0, 0, 8);
-
-    // Table & Visual meshes
-    // Now We have the mesh according to the waveform
-    gam::addSinesPow<1>(tbSaw, 9, 1);
-    addCone(mMesh[0],1, Vec3f(0,0,5), 40, 1); //tbSaw
-
-    gam::addSinesPow<1>(tbSqr, 9, 2);
-    addCube(mMesh[1]);  // tbSquare
-
-    gam::addSinesPow<0>(tbImp, 9, 1);
-    addPrism(mMesh[2],1,1,1,100); // tbImp
-
-    gam::addSine(tbSin);
-    addSphere(mMesh[3], 0.3, 16, 100); // tbSin
-
-// About: addSines (dst, amps, cycs, numh)
-// \param[out] dst		destination array
-// \param[in] amps		harmonic amplitudes of series, size must be numh - A[]
-// \param[in] cycs		harmonic numbers of series, size must be numh - C[]
-// \param[in] numh		total number of harmonics
-    float scaler = 0.15;
-    float hscaler = 1;
-
-    { //tbPls
-      float A[] = {1, 1, 1, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tbPls, A, 8); 
-      addWireBox(mMesh[4],2);    // tbPls
-    }
-    { // tb__1 
-      float A[] = {1, 0.4, 0.65, 0.3, 0.18, 0.08, 0, 0};
-      float C[] = {1, 4, 7, 11, 15, 18, 0, 0 };
-      gam::addSines(tb__1, A, C, 6);
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[5], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-
-        // addSphere(mMesh[5],scaler * A[i], 16, 30); // tb__1
-      }
-    }
-    { // inharmonic partials
-      float A[] = {0.5, 0.8, 0.7, 1, 0.3, 0.4, 0.2, 0.12};
-      float C[] = {3, 4, 7, 8, 11, 12, 15, 16}; 
-      gam::addSines(tb__2, A, C, 8); // tb__2
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[6], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-      }
-    }
-    { // inharmonic partials
-      float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08, 0 , 0};
-      float C[] = {10, 27, 54, 81, 108, 135, 0, 0};
-      gam::addSines(tb__3, A, C, 6); // tb__3
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[7], scaler * A[i]*C[i], scaler * A[i+1]*C[i+1], 1 + 0.3*i);
-      }
-    }
-  { // harmonics 20-27
-      float A[] = {0.2, 0.4, 0.6, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tb__4, A, 8, 20); // tb__4
-      for (int i = 0; i < 7; i++){
-        addWireBox(mMesh[8], hscaler * A[i], hscaler * A[i+1], 1 + 0.3*i);
-      }
-    }
+    pIdx1.bind(createInternalTriggerParameter("idx1", 0.01, 0.0, 10.0));
+    pIdx2.bind(createInternalTriggerParameter("idx2", 7, 0.0, 10.0));
+    pIdx3.bind(createInternalTriggerParameter("idx3", 5, 0.0, 10.0));
 
-    // Scale and generate normals
-    for (int i = 0; i < numb_waveform; ++i) {
-      mMesh[i].scale(0.4);
+    pCarMul.bind(createInternalTriggerParameter("carMul", 1, 0.0, 20.0));
+    pModMul.bind(createInternalTriggerParameter("modMul", 1.0007, 0.0, 20.0));
 
-      int Nv = mMesh[i].vertices().size();
-      for (int k = 0; k < Nv; ++k) {
-        mMesh[i].color(HSV(float(k) / Nv, 0.3, 1));
-      }
+    pVibRate1.bind(createInternalTriggerParameter("vibRate1", 0.01, 0.0, 10.0));
+    pVibRate2.bind(createInternalTriggerParameter("vibRate2", 0.5, 0.0, 10.0));
+    pVibRise.bind(createInternalTriggerParameter("vibRise", 0, 0.0, 10.0));
+    pVibDepth.bind(createInternalTriggerParameter("vibDepth", 0, 0.0, 10.0));
 
-      if (!vertexLight && mMesh[i].primitive() == Mesh::TRIANGLES) {
-        mMesh[i].decompress();
-      }
-      mMesh[i].generateNormals();
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
+    pTable.bind(createInternalTriggerParameter("table", 0, 0, 8));
+
+    // The oscillator tables are shared by all voices and built once
+    WavetableBank::get();
+
+    // Visual meshes, shared by all voices
+    for (int i = 0; i < numb_waveform; ++i) {
+      mMesh[i] = &waveformMesh(i);
     }
 
 
@@ -888,21 +761,28 @@ public:
   {
     mVib.freq(mVibEnv());
     float carBaseFreq =
-        getInternalParameterValue("frequency") * getInternalParameterValue("carMul");
-    float modScale = getInternalParameterValue("frequency") * getInternalParameterValue("modMul");
-    float amp = getInternalParameterValue("amplitude") * 0.01;
-    while (io())
-    {
-      mVib.freq(mVibEnv());
-      car.freq((1 + mVib() * mVibDepth) * carBaseFreq +
-               mod() * mModEnv() * modScale);
-      float s1 = car() * mAmpEnv() * amp;
-      float s2;
-      mEnvFollow(s1);
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+        pFrequency.get() * pCarMul.get();
+    float modScale = pFrequency.get() * pModMul.get();
+    float amp = pAmplitude.get() * 0.01;
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
+      // The carrier frequency changes every sample, so it stays a loop
+      for (int i = 0; i < n; i++)
+      {
+        mVib.freq(mVibEnv());
+        car.freq((1 + mVib() * mVibDepth) * carBaseFreq +
+                 mod() * mModEnv() * modScale);
+        s1[i] = car();
+      }
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, amp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
     if (mAmpEnv.done() && (mEnvFollow.value() < 0.001))
       free();
   }
@@ -912,20 +792,20 @@ public:
     a += 0.29;
     b += 0.23;
     timepose -= 0.06;
-    int shape = getInternalParameterValue("table");
+    int shape = pTable.get();
     g.polygonMode(wireframe ? GL_LINE : GL_FILL);
     // light.pos(0, 0, 0);
     gl::depthTesting(true);
     g.pushMatrix();
     g.depthTesting(true);
     g.lighting(true);
-    g.translate(timepose, getInternalParameterValue("frequency") / 200 - 3, -15);
+    g.translate(timepose, pFrequency.get() / 200 - 3, -15);
     g.rotate(mVib() + a, Vec3f(0, 1, 0));
     g.rotate(mVib() * mVibDepth + b, Vec3f(1));
-    float scaling = getInternalParameterValue("amplitude") * 10;
-    g.scale(scaling + getInternalParameterValue("modMul") / 2, scaling + getInternalParameterValue("carMul") / 20, scaling + mEnvFollow.value() * 5);
-    g.color(HSV(getInternalParameterValue("modMul") / 20, getInternalParameterValue("carMul") / 20, 0.5 + getInternalParameterValue("attackTime")));
-    g.draw(mMesh[shape]);
+    float scaling = pAmplitude.get() * 10;
+    g.scale(scaling + pModMul.get() / 2, scaling + pCarMul.get() / 20, scaling + mEnvFollow.value() * 5);
+    g.color(HSV(pModMul.get() / 20, pCarMul.get() / 20, 0.5 + pAttackTime.get()));
+    g.draw(*mMesh[shape]);
     g.popMatrix();
   }
 
@@ -941,7 +821,7 @@ public:
     updateWaveform();
 
     float modFreq =
-        getInternalParameterValue("frequency") * getInternalParameterValue("modMul");
+        pFrequency.get() * pModMul.get();
     mod.freq(modFreq);
   }
   void onTriggerOff() override
@@ -953,60 +833,33 @@ public:
 
   void updateFromParameters()
   {
-    mModEnv.levels()[0] = getInternalParameterValue("idx1");
-    mModEnv.levels()[1] = getInternalParameterValue("idx2");
-    mModEnv.levels()[2] = getInternalParameterValue("idx2");
-    mModEnv.levels()[3] = getInternalParameterValue("idx3");
-
-    mAmpEnv.attack(getInternalParameterValue("attackTime"));
-    mAmpEnv.release(getInternalParameterValue("releaseTime"));
-    mAmpEnv.sustain(getInternalParameterValue("sustain"));
-
-    mModEnv.lengths()[0] = getInternalParameterValue("attackTime");
-    mModEnv.lengths()[3] = getInternalParameterValue("releaseTime");
-
-    mVibEnv.levels(getInternalParameterValue("vibRate1"),
-                   getInternalParameterValue("vibRate2"),
-                   getInternalParameterValue("vibRate2"),
-                   getInternalParameterValue("vibRate1"));
-    mVibEnv.lengths()[0] = getInternalParameterValue("vibRise");
-    mVibEnv.lengths()[1] = getInternalParameterValue("vibRise");
-    mVibEnv.lengths()[3] = getInternalParameterValue("vibRise");
-    mVibDepth = getInternalParameterValue("vibDepth");
+    mModEnv.levels()[0] = pIdx1.get();
+    mModEnv.levels()[1] = pIdx2.get();
+    mModEnv.levels()[2] = pIdx2.get();
+    mModEnv.levels()[3] = pIdx3.get();
+
+    mAmpEnv.attack(pAttackTime.get());
+    mAmpEnv.release(pReleaseTime.get());
+    mAmpEnv.sustain(pSustain.get());
+
+    mModEnv.lengths()[0] = pAttackTime.get();
+    mModEnv.lengths()[3] = pReleaseTime.get();
+
+    mVibEnv.levels(pVibRate1.get(),
+                   pVibRate2.get(),
+                   pVibRate2.get(),
+                   pVibRate1.get());
+    mVibEnv.lengths()[0] = pVibRise.get();
+    mVibEnv.lengths()[1] = pVibRise.get();
+    mVibEnv.lengths()[3] = pVibRise.get();
+    mVibDepth = pVibDepth.get();
     
-    mPan.pos(getInternalParameterValue("pan"));
+    mPan.pos(pPan.get());
   }
   void updateWaveform(){
-        // Map table number to table in memory
-    switch (int(getInternalParameterValue("table"))) {
-      case 0:
-        car.source(tbSaw);
-        break;
-      case 1:
-        car.source(tbSqr);
-        break;
-      case 2:
-        car.source(tbImp);
-        break;
-      case 3:
-        car.source(tbSin);
-        break;
-      case 4:
-        car.source(tbPls);
-        break;
-      case 5:
-        car.source(tb__1);
-        break;
-      case 6:
-        car.source(tb__2);
-        break;
-      case 7:
-        car.source(tb__3);
-        break;
-      case 8:
-        car.source(tb__4);
-        break;
-    }
+    // Band-limited table for the note's frequency
+    car.source(WavetableBank::get().table(int(pTable.get()),
+                                          pFrequency.get() * pCarMul.get()));
   }
 
 
@@ -1027,12 +880,15 @@ public:
     // Additional members
     int mtable;
     static const int numb_waveform = 9;
-    Mesh mMesh[numb_waveform];
+    const Mesh *mMesh[numb_waveform];
     bool wireframe = false;
-    bool vertexLight = false;
     double a_rotate = 0;
     double b_rotate = 0;
     double timepose = 0;
+    // Handles to the trigger parameters, bound in init()
+    ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pSustain,
+        pCurve, pPan, pTable, pTrm1, pTrm2, pTrmRise, pTrmDepth;
+
     // Initialize voice. This function will nly be called once per voice
     virtual void init()
     {
@@ -1041,100 +897,26 @@ public:
         mAmpEnv.levels(0, 0.3, 0.3, 0); // These tables are not normalized, so scale to 0.3
         mTrmEnv.curve(0);
         mTrmEnv.levels(0, 1, 1, 0);
-        createInternalTriggerParameter("amplitude", 0.03, 0.0, 1.0);
-        createInternalTriggerParameter("frequency", 60, 20, 5000);
-        createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-        createInternalTriggerParameter("releaseTime", 2.0, 0.1, 10.0);
-        createInternalTriggerParameter("sustain", 0.6, 0.0, 1.0);
-        createInternalTriggerParameter("curve", 4.0, -10.0, 10.0);
-        createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
-        createInternalTriggerParameter("table", 0, 0, 8);
-        createInternalTriggerParameter("trm1", 3.5, 0.2, 20);
-        createInternalTriggerParameter("trm2", 5.8, 0.2, 20);
-        createInternalTriggerParameter("trmRise", 0.5, 0.1, 2);
-        createInternalTriggerParameter("trmDepth", 0.1, 0.0, 1.0);
-
-        // Table & Visual meshes
-        // Now We have the mesh according to the waveform
-        gam::addSinesPow<1>(tbSaw, 9, 1);
-        addCone(mMesh[0], 1, Vec3f(0, 0, 5), 40, 1); // tbSaw
-
-        gam::addSinesPow<1>(tbSqr, 9, 2);
-        addCube(mMesh[1]); // tbSquare
-
-        gam::addSinesPow<0>(tbImp, 9, 1);
-        addPrism(mMesh[2], 1, 1, 1, 100); // tbImp
-
-        gam::addSine(tbSin);
-        addSphere(mMesh[3], 0.3, 16, 100); // tbSin
-
-        // About: addSines (dst, amps, cycs, numh)
-        // \param[out] dst		destination array
-        // \param[in] amps		harmonic amplitudes of series, size must be numh - A[]
-        // \param[in] cycs		harmonic numbers of series, size must be numh - C[]
-        // \param[in] numh		total number of harmonics
-        float scaler = 0.15;
-        float hscaler = 1;
-
-        { // tbPls
-            float A[] = {1, 1, 1, 1, 0.7, 0.5, 0.3, 0.1};
-            gam::addSines(tbPls, A, 8);
-            addWireBox(mMesh[4], 2); // tbPls
-        }
-        { // tb__1
-            float A[] = {1, 0.4, 0.65, 0.3, 0.18, 0.08, 0, 0};
-            float C[] = {1, 4, 7, 11, 15, 18, 0, 0};
-            gam::addSines(tb__1, A, C, 6);
-            for (int i = 0; i < 7; i++)
-            {
-                addWireBox(mMesh[5], scaler * A[i] * C[i], scaler * A[i + 1] * C[i + 1], 1 + 0.3 * i);
-
-                // addSphere(mMesh[5],scaler * A[i], 16, 30); // tb__1
-            }
-        }
-        { // inharmonic partials
-            float A[] = {0.5, 0.8, 0.7, 1, 0.3, 0.4, 0.2, 0.12};
-            float C[] = {3, 4, 7, 8, 11, 12, 15, 16};
-            gam::addSines(tb__2, A, C, 8); // tb__2
-            for (int i = 0; i < 7; i++)
-            {
-                addWireBox(mMesh[6], scaler * A[i] * C[i], scaler * A[i + 1] * C[i + 1], 1 + 0.3 * i);
-            }
-        }
-        { // inharmonic partials
-            float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08, 0, 0};
-            float C[] = {10, 27, 54, 81, 108, 135, 0, 0};
-            gam::addSines(tb__3, A, C, 6); // tb__3
-            for (int i = 0; i < 7; i++)
-            {
-                addWireBox(mMesh[7], scaler * A[i] * C[i], scaler * A[i + 1] * C[i + 1], 1 + 0.3 * i);
-            }
-        }
-        { // harmonics 20-27
-            float A[] = {0.2, 0.4, 0.6, 1, 0.7, 0.5, 0.3, 0.1};
-            gam::addSines(tb__4, A, 8, 20); // tb__4
-            for (int i = 0; i < 7; i++)
-            {
-                addWireBox(mMesh[8], hscaler * A[i], hscaler * A[i + 1], 1 + 0.3 * i);
-            }
-        }
-
-        // Scale and generate normals
+        pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.03, 0.0, 1.0));
+        pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+        pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+        pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 2.0, 0.1, 10.0));
+        pSustain.bind(createInternalTriggerParameter("sustain", 0.6, 0.0, 1.0));
+        pCurve.bind(createInternalTriggerParameter("curve", 4.0, -10.0, 10.0));
+        pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
+        pTable.bind(createInternalTriggerParameter("table", 0, 0, 8));
+        pTrm1.bind(createInternalTriggerParameter("trm1", 3.5, 0.2, 20));
+        pTrm2.bind(createInternalTriggerParameter("trm2", 5.8, 0.2, 20));
+        pTrmRise.bind(createInternalTriggerParameter("trmRise", 0.5, 0.1, 2));
+        pTrmDepth.bind(createInternalTriggerParameter("trmDepth", 0.1, 0.0, 1.0));
+
+        // The oscillator tables are shared by all voices and built once
+        WavetableBank::get();
+
+        // Visual meshes, shared by all voices
         for (int i = 0; i < numb_waveform; ++i)
         {
-            mMesh[i].scale(0.4);
-
-            int Nv = mMesh[i].vertices().size();
-            for (int k = 0; k < Nv; ++k)
-            {
-                mMesh[i].color(HSV(float(k) / Nv, 0.3, 1));
-            }
-
-            if (!vertexLight && mMesh[i].primitive() == Mesh::TRIANGLES)
-            {
-                mMesh[i].decompress();
-            }
-            mMesh[i].generateNormals();
+            mMesh[i] = &waveformMesh(i);
         }
     }
 
@@ -1142,22 +924,28 @@ public:
     virtual void onProcess(AudioIOData &io) override
     {
         // updateFromParameters();
-        float oscFreq = getInternalParameterValue("frequency");
-        float amp = getInternalParameterValue("amplitude");
-        float trmDepth = getInternalParameterValue("trmDepth");
-        while (io())
-        {
-
-            mTrm.freq(mTrmEnv());
-            // float trmAmp = mAmp - mTrm()*mTrmDepth; // Replaced with line below
-            float trmAmp = (mTrm() * 0.5 + 0.5) * trmDepth + (1 - trmDepth); // Corrected
-            float s1 = mOsc() * mAmpEnv() * trmAmp * amp;
-            float s2;
-            mEnvFollow(s1);
-            mPan(s1, s1, s2);
-            io.out(0) += s1;
-            io.out(1) += s2;
-        }
+        float oscFreq = pFrequency.get();
+        float amp = pAmplitude.get();
+        float trmDepth = pTrmDepth.get();
+        float g1, g2;
+        mPan(1.f, g1, g2);
+        block::forEachChunk(io, [&](int frame, int n) {
+            float s1[block::chunkSize], env[block::chunkSize];
+            float trmAmp[block::chunkSize];
+            for (int i = 0; i < n; i++)
+            {
+                mTrm.freq(mTrmEnv());
+                trmAmp[i] = (mTrm() * 0.5 + 0.5) * trmDepth + (1 - trmDepth);
+            }
+            block::generate(mOsc, s1, n);
+            block::generate(mAmpEnv, env, n);
+            block::multiply(s1, env, n);
+            block::multiply(s1, trmAmp, n);
+            block::scale(s1, amp, n);
+            block::follow(mEnvFollow, s1, n);
+            block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame,
+                             s1, g1, g2, n);
+        });
         // We need to let the synth know that this voice is done
         // by calling the free(). This takes the voice out of the
         // rendering chain
@@ -1170,8 +958,8 @@ public:
         a_rotate += 0.81;
         b_rotate += 0.78;
         timepose -= 0.06;
-        float frequency = getInternalParameterValue("frequency");
-        int shape = getInternalParameterValue("table");
+        float frequency = pFrequency.get();
+        int shape = pTable.get();
 
         // static Light light;
         g.polygonMode(wireframe ? GL_LINE : GL_FILL);
@@ -1181,13 +969,13 @@ public:
         // g.light(light);
         g.pushMatrix();
         g.depthTesting(true);
-        g.translate(timepose, getInternalParameterValue("frequency") / 200 - 3, -15);
+        g.translate(timepose, pFrequency.get() / 200 - 3, -15);
         g.rotate(a_rotate, Vec3f(0, 1, 1));
         g.rotate(b_rotate, Vec3f(1));
         g.scale(0.2 + mAmpEnv() * 0.2 + 0.01 * mTrm(), 0.3 + mAmpEnv() * 0.5 + 0.01 * mTrm(), 0.1 + 0.01 * mTrm());
         g.scale(3 + mAmpEnv() * 0.5, 3 + mAmpEnv() * 0.5, 5 + mAmpEnv());
         g.color(HSV(frequency / 1000, 0.6 + mAmpEnv() * 0.1, 0.6 + 0.5 * mAmpEnv()));
-        g.draw(mMesh[shape]);
+        g.draw(*mMesh[shape]);
         g.popMatrix();
     }
 
@@ -1210,56 +998,28 @@ public:
 
     void updateFromParameters()
     {
-        mOsc.freq(getInternalParameterValue("frequency"));
-        mAmpEnv.attack(getInternalParameterValue("attackTime"));
-        mAmpEnv.decay(getInternalParameterValue("attackTime"));
-        mAmpEnv.release(getInternalParameterValue("releaseTime"));
-        mAmpEnv.sustain(getInternalParameterValue("sustain"));
-        mAmpEnv.curve(getInternalParameterValue("curve"));
-        mPan.pos(getInternalParameterValue("pan"));
-
-        mTrmEnv.levels(getInternalParameterValue("trm1"),
-                       getInternalParameterValue("trm2"),
-                       getInternalParameterValue("trm2"),
-                       getInternalParameterValue("trm1"));
-
-        mTrmEnv.attack(getInternalParameterValue("trmRise"));
-        mTrmEnv.decay(getInternalParameterValue("trmRise"));
-        mTrmEnv.release(getInternalParameterValue("trmRise"));
+        mOsc.freq(pFrequency.get());
+        mAmpEnv.attack(pAttackTime.get());
+        mAmpEnv.decay(pAttackTime.get());
+        mAmpEnv.release(pReleaseTime.get());
+        mAmpEnv.sustain(pSustain.get());
+        mAmpEnv.curve(pCurve.get());
+        mPan.pos(pPan.get());
+
+        mTrmEnv.levels(pTrm1.get(),
+                       pTrm2.get(),
+                       pTrm2.get(),
+                       pTrm1.get());
+
+        mTrmEnv.attack(pTrmRise.get());
+        mTrmEnv.decay(pTrmRise.get());
+        mTrmEnv.release(pTrmRise.get());
     }
     void updateWaveform()
     {
-        // Map table number to table in memory
-        switch (int(getInternalParameterValue("table")))
-        {
-        case 0:
-            mOsc.source(tbSaw);
-            break;
-        case 1:
-            mOsc.source(tbSqr);
-            break;
-        case 2:
-            mOsc.source(tbImp);
-            break;
-        case 3:
-            mOsc.source(tbSin);
-            break;
-        case 4:
-            mOsc.source(tbPls);
-            break;
-        case 5:
-            mOsc.source(tb__1);
-            break;
-        case 6:
-            mOsc.source(tb__2);
-            break;
-        case 7:
-            mOsc.source(tb__3);
-            break;
-        case 8:
-            mOsc.source(tb__4);
-            break;
-        }
+        // Band-limited table for the note's frequency
+        mOsc.source(
+            WavetableBank::get().table(int(pTable.get()), pFrequency.get()));
     }
 };
 
@@ -1274,7 +1034,7 @@ public:
   gam::EnvFollow<> mEnvFollow;
   gam::Pan<> mPan;
   int mtable;
-  Mesh mMesh;
+  const Mesh *mMesh;
   float a = 0.f; // current rotation angle
   bool wireframe = false;
   bool vertexLight = false;
@@ -1282,12 +1042,14 @@ public:
   double b_rotate = 0;
   double timepose = 0;
   Vec3f spinner;
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pSustain,
+      pPan, pAmFunc, pAm1, pAm2, pAmRise, pAmRatio;
+
   // Initialize voice. This function will nly be called once per voice
   virtual void init()
   {
-    addSphere(mMesh, 1, 100, 100);
-    mMesh.decompress();
-    mMesh.generateNormals();
+    mMesh = &MeshCache::get().sphere(1, 100, 100);
     mAmpEnv.levels(0, 1, 1, 0);
     //    mAmpEnv.sustainPoint(1);
 
@@ -1297,42 +1059,46 @@ public:
 
     // We have the mesh be a sphere
 
-    createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0);
-    createInternalTriggerParameter("frequency", 440, 10, 4000.0);
-    createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseTime", 4, 0.1, 10.0);
-    createInternalTriggerParameter("sustain", 0.3, 0.1, 1.0);
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
-    createInternalTriggerParameter("amFunc", 0.0, 0.0, 3.0);
-    createInternalTriggerParameter("am1", 0.75, 0.0, 1.0);
-    createInternalTriggerParameter("am2", 0.75, 0.0, 1.0);
-    createInternalTriggerParameter("amRise", 0.75, 0.1, 1.0);
-    createInternalTriggerParameter("amRatio", 0.75, 0.0, 2.0);
+    pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0));
+    pFrequency.bind(createInternalTriggerParameter("frequency", 440, 10, 4000.0));
+    pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+    pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 4, 0.1, 10.0));
+    pSustain.bind(createInternalTriggerParameter("sustain", 0.3, 0.1, 1.0));
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
+    pAmFunc.bind(createInternalTriggerParameter("amFunc", 0.0, 0.0, 3.0));
+    pAm1.bind(createInternalTriggerParameter("am1", 0.75, 0.0, 1.0));
+    pAm2.bind(createInternalTriggerParameter("am2", 0.75, 0.0, 1.0));
+    pAmRise.bind(createInternalTriggerParameter("amRise", 0.75, 0.1, 1.0));
+    pAmRatio.bind(createInternalTriggerParameter("amRatio", 0.75, 0.0, 2.0));
+
+    // The AM tables are shared by all voices and built once
+    WavetableBank::get();
   }
 
   virtual void onProcess(AudioIOData &io) override
   {
-    mOsc.freq(getInternalParameterValue("frequency"));
-
-    float amp = getInternalParameterValue("amplitude");
-    float amRatio = getInternalParameterValue("amRatio");
-    while (io())
-    {
-
-      mAM.freq(mOsc.freq() * amRatio); // set AM freq according to ratio
-      float amAmt = mAMEnv();          // AM amount envelope
-
-      float s1 = mOsc();                            // non-modulated signal
-      s1 = s1 * (1 - amAmt) + (s1 * mAM()) * amAmt; // mix modulated and non-modulated
-      // s1 = (s1 * mAM()) * amAmt; // Ring modulation
-      s1 *= mAmpEnv() * amp;
-
-      float s2;
-      mEnvFollow(s1);
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+    mOsc.freq(pFrequency.get());
+
+    float amp = pAmplitude.get();
+    float amRatio = pAmRatio.get();
+    mAM.freq(mOsc.freq() * amRatio); // set AM freq according to ratio
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
+      for (int i = 0; i < n; i++)
+      {
+        float amAmt = mAMEnv();
+        float s = mOsc();
+        s1[i] = s * (1 - amAmt) + (s * mAM()) * amAmt;
+      }
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, amp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
     // We need to let the synth know that this voice is done
     // by calling the free(). This takes the voice out of the
     // rendering chain
@@ -1342,10 +1108,9 @@ public:
 
   virtual void onProcess(Graphics &g)
   {
-    float frequency = getInternalParameterValue("frequency");
-    float amplitude = getInternalParameterValue("amplitude");
-    float pan = getInternalParameterValue("pan");
-    int shape = getInternalParameterValue("table");
+    float frequency = pFrequency.get();
+    float amplitude = pAmplitude.get();
+    float pan = pPan.get();
     float radius = frequency / 300;
     b_rotate += 1.1;
     timepose -= 0.04;
@@ -1362,51 +1127,42 @@ public:
     g.rotate(b_rotate, spinner);
     g.scale(0.05 * mAM() + 0.3);
     // center the model
-    g.color(HSV(mOsc.freq() * getInternalParameterValue("amRatio") / 1000 + mAM() * 0.01, 0.5 + mAmpEnv() * 0.5, 0.05 + 5 * mAmpEnv()));
-    g.draw(mMesh);
+    g.color(HSV(mOsc.freq() * pAmRatio.get() / 1000 + mAM() * 0.01, 0.5 + mAmpEnv() * 0.5, 0.05 + 5 * mAmpEnv()));
+    g.draw(*mMesh);
     g.popMatrix();
   }
 
   virtual void onTriggerOn() override
   {
-    mAmpEnv.attack(getInternalParameterValue("attackTime"));
+    mAmpEnv.attack(pAttackTime.get());
     mAmpEnv.lengths()[1] = 0.001;
-    mAmpEnv.release(getInternalParameterValue("releaseTime"));
+    mAmpEnv.release(pReleaseTime.get());
 
-    mAmpEnv.levels()[1] = getInternalParameterValue("sustain");
-    mAmpEnv.levels()[2] = getInternalParameterValue("sustain");
+    mAmpEnv.levels()[1] = pSustain.get();
+    mAmpEnv.levels()[2] = pSustain.get();
 
-    mAMEnv.levels(getInternalParameterValue("am1"),
-                  getInternalParameterValue("am2"),
-                  getInternalParameterValue("am2"),
-                  getInternalParameterValue("am1"));
+    mAMEnv.levels(pAm1.get(),
+                  pAm2.get(),
+                  pAm2.get(),
+                  pAm1.get());
 
-    mAMEnv.lengths(getInternalParameterValue("amRise"),
-                   1 - getInternalParameterValue("amRise"));
+    mAMEnv.lengths(pAmRise.get(),
+                   1 - pAmRise.get());
 
-    mPan.pos(getInternalParameterValue("pan"));
+    mPan.pos(pPan.get());
 
     mAmpEnv.reset();
     mAMEnv.reset();
     timepose = 0; // Initiate timeline
     b_rotate = al::rnd::uniform(0, 360);
     spinner = randomVec3f(1);
-    // Map table number to table in memory
-    switch (int(getInternalParameterValue("amFunc")))
-    {
-    case 0:
-      mAM.source(tbSin);
-      break;
-    case 1:
-      mAM.source(tbSqr);
-      break;
-    case 2:
-      mAM.source(tbPls);
-      break;
-    case 3:
-      mAM.source(tbDin);
-      break;
-    }
+    // Map the AM function number to a table, band limited for the AM
+    // frequency
+    static const int amTables[] = {WavetableBank::SINE, WavetableBank::SQUARE,
+                                   WavetableBank::PULSE, WavetableBank::DIN};
+    int amFunc = std::min(std::max(int(pAmFunc.get()), 0), 3);
+    mAM.source(WavetableBank::get().table(amTables[amFunc],
+                                          pFrequency.get() * pAmRatio.get()));
   }
 
   virtual void onTriggerOff() override
@@ -1420,16 +1176,10 @@ public:
 class AddSyn : public SynthVoice
 {
 public:
-  gam::Sine<> mOsc;
-  gam::Sine<> mOsc1;
-  gam::Sine<> mOsc2;
-  gam::Sine<> mOsc3;
-  gam::Sine<> mOsc4;
-  gam::Sine<> mOsc5;
-  gam::Sine<> mOsc6;
-  gam::Sine<> mOsc7;
-  gam::Sine<> mOsc8;
-  gam::Sine<> mOsc9;
+  // Partials, grouped by the envelope they follow
+  SineBank<3> mOscStri;
+  SineBank<2> mOscLow;
+  SineBank<4> mOscUp;
   gam::ADSR<> mEnvStri;
   gam::ADSR<> mEnvLow;
   gam::ADSR<> mEnvUp;
@@ -1437,12 +1187,19 @@ public:
   gam::EnvFollow<> mEnvFollow;
 
   // Additional members
-  Mesh ball;
+  const Mesh *ball;
   double a = 0;
   double b = 0;
   double timepose = 0;
   Vec3f note_position;
   Vec3f note_direction;
+
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pAmp, pFrequency, pAmpStri, pAttackStri, pReleaseStri,
+      pSustainStri, pAmpLow, pAttackLow, pReleaseLow, pSustainLow, pAmpUp,
+      pAttackUp, pReleaseUp, pSustainUp, pFreqStri1, pFreqStri2, pFreqStri3,
+      pFreqLow1, pFreqLow2, pFreqUp1, pFreqUp2, pFreqUp3, pFreqUp4, pPan;
+
   virtual void init()
   {
 
@@ -1461,67 +1218,77 @@ public:
     mEnvUp.sustain(2); // Make point 2 sustain until a release is issued
 
     // We have the mesh be a sphere
-    addSphere(ball, 1, 100, 100);
-    ball.decompress();
-    ball.generateNormals();
-
-    createInternalTriggerParameter("amp", 0.01, 0.0, 0.3);
-    createInternalTriggerParameter("frequency", 60, 20, 5000);
-    createInternalTriggerParameter("ampStri", 0.5, 0.0, 1.0);
-    createInternalTriggerParameter("attackStri", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseStri", 0.1, 0.1, 10.0);
-    createInternalTriggerParameter("sustainStri", 0.8, 0.0, 1.0);
-    createInternalTriggerParameter("ampLow", 0.5, 0.0, 1.0);
-    createInternalTriggerParameter("attackLow", 0.001, 0.01, 3.0);
-    createInternalTriggerParameter("releaseLow", 0.1, 0.1, 10.0);
-    createInternalTriggerParameter("sustainLow", 0.8, 0.0, 1.0);
-    createInternalTriggerParameter("ampUp", 0.6, 0.0, 1.0);
-    createInternalTriggerParameter("attackUp", 0.01, 0.01, 3.0);
-    createInternalTriggerParameter("releaseUp", 0.075, 0.1, 10.0);
-    createInternalTriggerParameter("sustainUp", 0.9, 0.0, 1.0);
-    createInternalTriggerParameter("freqStri1", 1.0, 0.1, 10);
-    createInternalTriggerParameter("freqStri2", 2.001, 0.1, 10);
-    createInternalTriggerParameter("freqStri3", 3.0, 0.1, 10);
-    createInternalTriggerParameter("freqLow1", 4.009, 0.1, 10);
-    createInternalTriggerParameter("freqLow2", 5.002, 0.1, 10);
-    createInternalTriggerParameter("freqUp1", 6.0, 0.1, 10);
-    createInternalTriggerParameter("freqUp2", 7.0, 0.1, 10);
-    createInternalTriggerParameter("freqUp3", 8.0, 0.1, 10);
-    createInternalTriggerParameter("freqUp4", 9.0, 0.1, 10);
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
+    ball = &MeshCache::get().sphere(1, 100, 100);
+
+    pAmp.bind(createInternalTriggerParameter("amp", 0.01, 0.0, 0.3));
+    pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+    pAmpStri.bind(createInternalTriggerParameter("ampStri", 0.5, 0.0, 1.0));
+    pAttackStri.bind(createInternalTriggerParameter("attackStri", 0.1, 0.01, 3.0));
+    pReleaseStri.bind(createInternalTriggerParameter("releaseStri", 0.1, 0.1, 10.0));
+    pSustainStri.bind(createInternalTriggerParameter("sustainStri", 0.8, 0.0, 1.0));
+    pAmpLow.bind(createInternalTriggerParameter("ampLow", 0.5, 0.0, 1.0));
+    pAttackLow.bind(createInternalTriggerParameter("attackLow", 0.001, 0.01, 3.0));
+    pReleaseLow.bind(createInternalTriggerParameter("releaseLow", 0.1, 0.1, 10.0));
+    pSustainLow.bind(createInternalTriggerParameter("sustainLow", 0.8, 0.0, 1.0));
+    pAmpUp.bind(createInternalTriggerParameter("ampUp", 0.6, 0.0, 1.0));
+    pAttackUp.bind(createInternalTriggerParameter("attackUp", 0.01, 0.01, 3.0));
+    pReleaseUp.bind(createInternalTriggerParameter("releaseUp", 0.075, 0.1, 10.0));
+    pSustainUp.bind(createInternalTriggerParameter("sustainUp", 0.9, 0.0, 1.0));
+    pFreqStri1.bind(createInternalTriggerParameter("freqStri1", 1.0, 0.1, 10));
+    pFreqStri2.bind(createInternalTriggerParameter("freqStri2", 2.001, 0.1, 10));
+    pFreqStri3.bind(createInternalTriggerParameter("freqStri3", 3.0, 0.1, 10));
+    pFreqLow1.bind(createInternalTriggerParameter("freqLow1", 4.009, 0.1, 10));
+    pFreqLow2.bind(createInternalTriggerParameter("freqLow2", 5.002, 0.1, 10));
+    pFreqUp1.bind(createInternalTriggerParameter("freqUp1", 6.0, 0.1, 10));
+    pFreqUp2.bind(createInternalTriggerParameter("freqUp2", 7.0, 0.1, 10));
+    pFreqUp3.bind(createInternalTriggerParameter("freqUp3", 8.0, 0.1, 10));
+    pFreqUp4.bind(createInternalTriggerParameter("freqUp4", 9.0, 0.1, 10));
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
   }
 
   virtual void onProcess(AudioIOData &io) override
   {
     // Parameters will update values once per audio callback
-    float freq = getInternalParameterValue("frequency");
-    mOsc.freq(freq);
-    mOsc1.freq(getInternalParameterValue("freqStri1") * freq);
-    mOsc2.freq(getInternalParameterValue("freqStri2") * freq);
-    mOsc3.freq(getInternalParameterValue("freqStri3") * freq);
-    mOsc4.freq(getInternalParameterValue("freqLow1") * freq);
-    mOsc5.freq(getInternalParameterValue("freqLow2") * freq);
-    mOsc6.freq(getInternalParameterValue("freqUp1") * freq);
-    mOsc7.freq(getInternalParameterValue("freqUp2") * freq);
-    mOsc8.freq(getInternalParameterValue("freqUp3") * freq);
-    mOsc9.freq(getInternalParameterValue("freqUp4") * freq);
-    mPan.pos(getInternalParameterValue("pan"));
-    float ampStri = getInternalParameterValue("ampStri");
-    float ampUp = getInternalParameterValue("ampUp");
-    float ampLow = getInternalParameterValue("ampLow");
-    float amp = getInternalParameterValue("amp");
-    while (io())
-    {
-      float s1 = (mOsc1() + mOsc2() + mOsc3()) * mEnvStri() * ampStri;
-      s1 += (mOsc4() + mOsc5()) * mEnvLow() * ampLow;
-      s1 += (mOsc6() + mOsc7() + mOsc8() + mOsc9()) * mEnvUp() * ampUp;
-      s1 *= amp;
-      float s2;
-      mEnvFollow(s1);
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+    float freq = pFrequency.get();
+    mOscStri.freq(0, pFreqStri1.get() * freq);
+    mOscStri.freq(1, pFreqStri2.get() * freq);
+    mOscStri.freq(2, pFreqStri3.get() * freq);
+    mOscLow.freq(0, pFreqLow1.get() * freq);
+    mOscLow.freq(1, pFreqLow2.get() * freq);
+    mOscUp.freq(0, pFreqUp1.get() * freq);
+    mOscUp.freq(1, pFreqUp2.get() * freq);
+    mOscUp.freq(2, pFreqUp3.get() * freq);
+    mOscUp.freq(3, pFreqUp4.get() * freq);
+    mPan.pos(pPan.get());
+    float amp = pAmp.get();
+    float ampStri = pAmpStri.get() * amp;
+    float ampLow = pAmpLow.get() * amp;
+    float ampUp = pAmpUp.get() * amp;
+    for (int k = 0; k < 3; k++)
+      mOscStri.amp(k, ampStri);
+    for (int k = 0; k < 2; k++)
+      mOscLow.amp(k, ampLow);
+    for (int k = 0; k < 4; k++)
+      mOscUp.amp(k, ampUp);
+
+    // The partials are rendered a chunk at a time by the oscillator banks,
+    // with the envelopes written out per sample first.
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float envStri[block::chunkSize], envLow[block::chunkSize];
+      float envUp[block::chunkSize], s1[block::chunkSize];
+      block::generate(mEnvStri, envStri, n);
+      block::generate(mEnvLow, envLow, n);
+      block::generate(mEnvUp, envUp, n);
+      std::fill(s1, s1 + n, 0.f);
+      mOscStri.process(s1, envStri, n);
+      mOscLow.process(s1, envLow, n);
+      mOscUp.process(s1, envUp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
     // if(mEnvStri.done()) free();
     if (mEnvStri.done() && mEnvUp.done() && mEnvLow.done() && (mEnvFollow.value() < 0.001))
       free();
@@ -1534,7 +1301,7 @@ public:
     timepose += 0.02;
     // Get the paramter values on every video frame, to apply changes to the
     // current instance
-    float frequency = getInternalParameterValue("frequency");
+    float frequency = pFrequency.get();
     float amplitude = getInternalParameterValue("amplitude");
     // Now draw
     g.pushMatrix();
@@ -1546,34 +1313,38 @@ public:
     g.rotate(b, Vec3f(1));
     g.scale(0.3 + mEnvStri() * 0.2, 0.3 + mEnvStri() * 0.5, 1);
     g.color(HSV(frequency / 1000, 0.5 + mEnvStri() * 0.1, 0.3 + 0.5 * mEnvStri()));
-    g.draw(ball);
+    g.draw(*ball);
     g.popMatrix();
   }
 
   virtual void onTriggerOn() override
   {
 
-    mEnvStri.attack(getInternalParameterValue("attackStri"));
-    mEnvStri.decay(getInternalParameterValue("attackStri"));
-    mEnvStri.sustain(getInternalParameterValue("sustainStri"));
-    mEnvStri.release(getInternalParameterValue("releaseStri"));
+    mEnvStri.attack(pAttackStri.get());
+    mEnvStri.decay(pAttackStri.get());
+    mEnvStri.sustain(pSustainStri.get());
+    mEnvStri.release(pReleaseStri.get());
+
+    mEnvLow.attack(pAttackLow.get());
+    mEnvLow.decay(pAttackLow.get());
+    mEnvLow.sustain(pSustainLow.get());
+    mEnvLow.release(pReleaseLow.get());
 
-    mEnvLow.attack(getInternalParameterValue("attackLow"));
-    mEnvLow.decay(getInternalParameterValue("attackLow"));
-    mEnvLow.sustain(getInternalParameterValue("sustainLow"));
-    mEnvLow.release(getInternalParameterValue("releaseLow"));
+    mEnvUp.attack(pAttackUp.get());
+    mEnvUp.decay(pAttackUp.get());
+    mEnvUp.sustain(pSustainUp.get());
+    mEnvUp.release(pReleaseUp.get());
 
-    mEnvUp.attack(getInternalParameterValue("attackUp"));
-    mEnvUp.decay(getInternalParameterValue("attackUp"));
-    mEnvUp.sustain(getInternalParameterValue("sustainUp"));
-    mEnvUp.release(getInternalParameterValue("releaseUp"));
+    mPan.pos(pPan.get());
 
-    mPan.pos(getInternalParameterValue("pan"));
+    mOscStri.sampleRate(gam::sampleRate());
+    mOscLow.sampleRate(gam::sampleRate());
+    mOscUp.sampleRate(gam::sampleRate());
 
     mEnvStri.reset();
     mEnvLow.reset();
     mEnvUp.reset();
-    float angle = getInternalParameterValue("frequency") / 200;
+    float angle = pFrequency.get() / 200;
 
     a = al::rnd::uniform();
     b = al::rnd::uniform();
@@ -1601,16 +1372,23 @@ public:
     gam::EnvFollow<> mEnvFollow; // envelope follower to connect audio output to graphics
     gam::DSF<> mOsc;
     gam::NoiseWhite<> mNoise;
-    gam::Reson<> mRes;
-    gam::Env<2> mCFEnv;
+    ControlRateReson mRes;
+    gam::Env<2> mCFEnv; // Run at control rate in mRes.controlDomain()
     gam::Env<2> mBWEnv;
     // Additional members
-    Mesh mMesh;
+    const Mesh *mMesh;
     double a = 0;
     double b = 0;
     double timepose = 0;
     Vec3f note_position;
     Vec3f note_direction;
+    // Handles to the trigger parameters, bound in init()
+    ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pSustain,
+        pCurve, pNoise, pEnvDur, pCf1, pCf2, pCfRise, pBw1, pBw2, pBwRise,
+        pHmnum, pHmamp, pPan;
+    // Set when a parameter changes, so updateFromParameters() only runs then
+    std::atomic<bool> mParamsChanged{true};
+
     // Initialize voice. This function will nly be called once per voice
     void init() override
     {
@@ -1619,55 +1397,65 @@ public:
         mAmpEnv.sustainPoint(2);        // Make point 2 sustain until a release is issued
         mCFEnv.curve(0);
         mBWEnv.curve(0);
+        mCFEnv.domain(mRes.controlDomain());
+        mBWEnv.domain(mRes.controlDomain());
         mOsc.harmonics(12);
         // We have the mesh be a sphere
-        addSphere(mMesh, 1, 100, 100);
-        mMesh.decompress();
-        mMesh.generateNormals();
-
-        createInternalTriggerParameter("amplitude", 0.3, 0.0, 1.0);
-        createInternalTriggerParameter("frequency", 60, 20, 5000);
-        createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-        createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0);
-        createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0);
-        createInternalTriggerParameter("curve", 4.0, -10.0, 10.0);
-        createInternalTriggerParameter("noise", 0.0, 0.0, 1.0);
-        createInternalTriggerParameter("envDur", 1, 0.0, 5.0);
-        createInternalTriggerParameter("cf1", 400.0, 10.0, 5000);
-        createInternalTriggerParameter("cf2", 400.0, 10.0, 5000);
-        createInternalTriggerParameter("cfRise", 0.5, 0.1, 2);
-        createInternalTriggerParameter("bw1", 700.0, 10.0, 5000);
-        createInternalTriggerParameter("bw2", 900.0, 10.0, 5000);
-        createInternalTriggerParameter("bwRise", 0.5, 0.1, 2);
-        createInternalTriggerParameter("hmnum", 12.0, 5.0, 20.0);
-        createInternalTriggerParameter("hmamp", 1.0, 0.0, 1.0);
-        createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
+        mMesh = &MeshCache::get().sphere(1, 100, 100);
+
+        pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.3, 0.0, 1.0));
+        pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+        pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+        pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0));
+        pSustain.bind(createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0));
+        pCurve.bind(createInternalTriggerParameter("curve", 4.0, -10.0, 10.0));
+        pNoise.bind(createInternalTriggerParameter("noise", 0.0, 0.0, 1.0));
+        pEnvDur.bind(createInternalTriggerParameter("envDur", 1, 0.0, 5.0));
+        pCf1.bind(createInternalTriggerParameter("cf1", 400.0, 10.0, 5000));
+        pCf2.bind(createInternalTriggerParameter("cf2", 400.0, 10.0, 5000));
+        pCfRise.bind(createInternalTriggerParameter("cfRise", 0.5, 0.1, 2));
+        pBw1.bind(createInternalTriggerParameter("bw1", 700.0, 10.0, 5000));
+        pBw2.bind(createInternalTriggerParameter("bw2", 900.0, 10.0, 5000));
+        pBwRise.bind(createInternalTriggerParameter("bwRise", 0.5, 0.1, 2));
+        pHmnum.bind(createInternalTriggerParameter("hmnum", 12.0, 5.0, 20.0));
+        pHmamp.bind(createInternalTriggerParameter("hmamp", 1.0, 0.0, 1.0));
+        pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
+
+        for (ParamHandle *handle :
+             {&pFrequency, &pAttackTime, &pReleaseTime, &pSustain, &pCurve,
+              &pEnvDur, &pCf1, &pCf2, &pCfRise, &pBw1, &pBw2, &pBwRise, &pHmnum,
+              &pHmamp, &pPan})
+        {
+            handle->param->registerChangeCallback(
+                [this](float) { mParamsChanged = true; });
+        }
     }
 
     //
 
     virtual void onProcess(AudioIOData &io) override
     {
-        updateFromParameters();
-        float amp = getInternalParameterValue("amplitude");
-        float noiseMix = getInternalParameterValue("noise");
-        while (io())
+        if (mParamsChanged.exchange(false))
         {
-            // mix oscillator with noise
-            float s1 = mOsc() * (1 - noiseMix) + mNoise() * noiseMix;
-
-            // apply resonant filter
-            mRes.set(mCFEnv(), mBWEnv());
-            s1 = mRes(s1);
-
-            // appy amplitude envelope
-            s1 *= mAmpEnv() * amp;
-
-            float s2;
-            mPan(s1, s1, s2);
-            io.out(0) += s1;
-            io.out(1) += s2;
+            updateFromParameters();
         }
+        float amp = pAmplitude.get();
+        float noiseMix = pNoise.get();
+        float g1, g2;
+        mPan(1.f, g1, g2);
+        block::forEachChunk(io, [&](int frame, int n) {
+            float s1[block::chunkSize], env[block::chunkSize];
+            for (int i = 0; i < n; i++)
+            {
+                s1[i] = mOsc() * (1 - noiseMix) + mNoise() * noiseMix;
+            }
+            mRes.process(s1, n, mCFEnv, mBWEnv);
+            block::generate(mAmpEnv, env, n);
+            block::multiply(s1, env, n);
+            block::scale(s1, amp, n);
+            block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame,
+                             s1, g1, g2, n);
+        });
 
         if (mAmpEnv.done() && (mEnvFollow.value() < 0.001f))
             free();
@@ -1680,24 +1468,27 @@ public:
         timepose += 0.02;
         // Get the paramter values on every video frame, to apply changes to the
         // current instance
-        float frequency = getInternalParameterValue("frequency");
-        float amplitude = getInternalParameterValue("amplitude");
+        float frequency = pFrequency.get();
+        float amplitude = pAmplitude.get();
         // Now draw
         g.pushMatrix();
         g.depthTesting(true);
         g.lighting(true);
         // g.translate(note_position);
         g.translate(note_position + note_direction * timepose);
-        g.rotate(a, Vec3f(mCFEnv(), mBWEnv(), 0));
+        g.rotate(a, Vec3f(mCFEnv.value(), mBWEnv.value(), 0));
         g.rotate(b, Vec3f(mNoise()));
-        g.scale(mCFEnv()/ 10000, mBWEnv()/ 10000,  0.3 + 0.1*mNoise());
+        g.scale(mCFEnv.value()/ 10000, mBWEnv.value()/ 10000,  0.3 + 0.1*mNoise());
         g.color(HSV(frequency / 1000, 0.5 + mOsc() * 0.1, 0.3 + 0.1*mNoise()));
-        g.draw(mMesh);
+        g.draw(*mMesh);
         g.popMatrix();
     }
     virtual void onTriggerOn() override
     {
+        mParamsChanged = false;
         updateFromParameters();
+        mRes.sampleRate(gam::sampleRate());
+        mRes.reset();
         mAmpEnv.reset();
         mCFEnv.reset();
         mBWEnv.reset();
@@ -1705,7 +1496,7 @@ public:
         b = al::rnd::uniform();
         timepose = 0;
         note_position = {0, 0, -15};
-        float angle = getInternalParameterValue("frequency") / 200;
+        float angle = pFrequency.get() / 200;
         note_direction = {sin(angle), cos(angle), 0};
     }
 
@@ -1718,31 +1509,31 @@ public:
 
     void updateFromParameters()
     {
-        mOsc.freq(getInternalParameterValue("frequency"));
-        mOsc.harmonics(getInternalParameterValue("hmnum"));
-        mOsc.ampRatio(getInternalParameterValue("hmamp"));
-        mAmpEnv.attack(getInternalParameterValue("attackTime"));
+        mOsc.freq(pFrequency.get());
+        mOsc.harmonics(pHmnum.get());
+        mOsc.ampRatio(pHmamp.get());
+        mAmpEnv.attack(pAttackTime.get());
         //    mAmpEnv.decay(getInternalParameterValue("attackTime"));
-        mAmpEnv.release(getInternalParameterValue("releaseTime"));
-        mAmpEnv.levels()[1] = getInternalParameterValue("sustain");
-        mAmpEnv.levels()[2] = getInternalParameterValue("sustain");
-
-        mAmpEnv.curve(getInternalParameterValue("curve"));
-        mPan.pos(getInternalParameterValue("pan"));
-        mCFEnv.levels(getInternalParameterValue("cf1"),
-                      getInternalParameterValue("cf2"),
-                      getInternalParameterValue("cf1"));
-
-        mCFEnv.lengths()[0] = getInternalParameterValue("cfRise");
-        mCFEnv.lengths()[1] = 1 - getInternalParameterValue("cfRise");
-        mBWEnv.levels(getInternalParameterValue("bw1"),
-                      getInternalParameterValue("bw2"),
-                      getInternalParameterValue("bw1"));
-        mBWEnv.lengths()[0] = getInternalParameterValue("bwRise");
-        mBWEnv.lengths()[1] = 1 - getInternalParameterValue("bwRise");
-
-        mCFEnv.totalLength(getInternalParameterValue("envDur"));
-        mBWEnv.totalLength(getInternalParameterValue("envDur"));
+        mAmpEnv.release(pReleaseTime.get());
+        mAmpEnv.levels()[1] = pSustain.get();
+        mAmpEnv.levels()[2] = pSustain.get();
+
+        mAmpEnv.curve(pCurve.get());
+        mPan.pos(pPan.get());
+        mCFEnv.levels(pCf1.get(),
+                      pCf2.get(),
+                      pCf1.get());
+
+        mCFEnv.lengths()[0] = pCfRise.get();
+        mCFEnv.lengths()[1] = 1 - pCfRise.get();
+        mBWEnv.levels(pBw1.get(),
+                      pBw2.get(),
+                      pBw1.get());
+        mBWEnv.lengths()[0] = pBwRise.get();
+        mBWEnv.lengths()[1] = 1 - pBwRise.get();
+
+        mCFEnv.totalLength(pEnvDur.get());
+        mBWEnv.totalLength(pEnvDur.get());
     }
 };
 
@@ -1761,20 +1552,24 @@ public:
     gam::ADSR<> mAmpEnv;
     gam::EnvFollow<> mEnvFollow;
     gam::Env<2> mPanEnv;
-    gam::STFT stft = gam::STFT(FFT_SIZE, FFT_SIZE / 4, 0, gam::HANN, gam::MAG_FREQ);
     // This time, let's use spectrograms for each notes as the visual components.
+    // The spectrum is computed by SpectrumPool's worker threads, off the audio
+    // thread.
+    SpectrumPool::Analysis *mAnalysis;
     Mesh mSpectrogram;
-    vector<float> spectrum;
     double a = 0;
     double b = 0;
     double timepose = 10;
     // Additional members
-    Mesh mMesh;
+    const Mesh *mMesh;
+
+    // Handles to the trigger parameters, bound in init()
+    ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pSustain,
+        pPan1, pPan2, pPanRise;
 
     virtual void init() override
     {
-        // Declare the size of the spectrum
-        spectrum.resize(FFT_SIZE / 2 + 1);
+        mAnalysis = SpectrumPool::get().add(FFT_SIZE, FFT_SIZE / 4);
         mSpectrogram.primitive(Mesh::POINTS);
         mAmpEnv.levels(0, 1, 1, 0);
         mPanEnv.curve(4);
@@ -1782,15 +1577,15 @@ public:
         delay.maxDelay(1. / 27.5);
         delay.delay(1. / 440.0);
 
-        addDisc(mMesh, 1.0, 30);
-        createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0);
-        createInternalTriggerParameter("frequency", 60, 20, 5000);
-        createInternalTriggerParameter("attackTime", 0.001, 0.001, 1.0);
-        createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0);
-        createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0);
-        createInternalTriggerParameter("Pan1", 0.0, -1.0, 1.0);
-        createInternalTriggerParameter("Pan2", 0.0, -1.0, 1.0);
-        createInternalTriggerParameter("PanRise", 0.0, 0, 3.0); // range check
+        mMesh = &MeshCache::get().disc(1.0, 30);
+        pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.1, 0.0, 1.0));
+        pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+        pAttackTime.bind(createInternalTriggerParameter("attackTime", 0.001, 0.001, 1.0));
+        pReleaseTime.bind(createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0));
+        pSustain.bind(createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0));
+        pPan1.bind(createInternalTriggerParameter("Pan1", 0.0, -1.0, 1.0));
+        pPan2.bind(createInternalTriggerParameter("Pan2", 0.0, -1.0, 1.0));
+        pPanRise.bind(createInternalTriggerParameter("PanRise", 0.0, 0, 3.0)); // range check
     }
 
     //    void reset(){ env.reset(); }
@@ -1807,7 +1602,9 @@ public:
 
     virtual void onProcess(AudioIOData &io) override
     {
-
+        // Output queued for the STFT of this note
+        float analysis[64];
+        int numAnalysis = 0;
         while (io())
         {
             mPan.pos(mPanEnv());
@@ -1817,24 +1614,22 @@ public:
             mPan(s1, s1, s2);
             io.out(0) += s1;
             io.out(1) += s2;
-            // STFT for each notes
-            if (stft(s1))
-            { // Loop through all the frequency bins
-                for (unsigned k = 0; k < stft.numBins(); ++k)
-                {
-                    // Here we simply scale the complex sample
-                    spectrum[k] = tanh(pow(stft.bin(k).real(), 1.3));
-                }
+            analysis[numAnalysis++] = s1;
+            if (numAnalysis == 64)
+            {
+                mAnalysis->write(analysis, numAnalysis);
+                numAnalysis = 0;
             }
         }
+        mAnalysis->write(analysis, numAnalysis);
         if (mAmpEnv.done() && (mEnvFollow.value() < 0.001))
             free();
     }
 
     virtual void onProcess(Graphics &g) override
     {
-        float frequency = getInternalParameterValue("frequency");
-        float amplitude = getInternalParameterValue("amplitude");
+        float frequency = pFrequency.get();
+        float amplitude = pAmplitude.get();
         a += 0.29;
         b += 0.23;
         timepose -= 0.1;
@@ -1842,6 +1637,7 @@ public:
         mSpectrogram.reset();
         // mSpectrogram.primitive(Mesh::LINE_STRIP);
 
+        const float *spectrum = mAnalysis->spectrum();
         for (int i = 0; i < FFT_SIZE / 2; i++)
         {
             mSpectrogram.color(HSV(0.5 - spectrum[i] * 100));
@@ -1875,16 +1671,16 @@ public:
 
     void updateFromParameters()
     {
-        mPanEnv.levels(getInternalParameterValue("Pan1"),
-                       getInternalParameterValue("Pan2"),
-                       getInternalParameterValue("Pan1"));
-        mPanRise = getInternalParameterValue("PanRise");
-        delay.freq(getInternalParameterValue("frequency"));
-        mAmp = getInternalParameterValue("amplitude");
+        mPanEnv.levels(pPan1.get(),
+                       pPan2.get(),
+                       pPan1.get());
+        mPanRise = pPanRise.get();
+        delay.freq(pFrequency.get());
+        mAmp = pAmplitude.get();
         mAmpEnv.levels()[1] = 1.0;
-        mAmpEnv.levels()[2] = getInternalParameterValue("sustain");
-        mAmpEnv.lengths()[0] = getInternalParameterValue("attackTime");
-        mAmpEnv.lengths()[3] = getInternalParameterValue("releaseTime");
+        mAmpEnv.levels()[2] = pSustain.get();
+        mAmpEnv.lengths()[0] = pAttackTime.get();
+        mAmpEnv.lengths()[3] = pReleaseTime.get();
         mPanEnv.lengths()[0] = mPanRise;
         mPanEnv.lengths()[1] = mPanRise;
     }
@@ -0,0 +1,141 @@
+// Per-sample vs. per-block voice rendering
+//
+// First renders the oscillator, envelope and pan chain of SineEnv both ways:
+// pulling samples one at a time through io(), as the voices did before they
+// moved to the helpers in BlockProcessing.h, and with those helpers. Then
+// renders each voice class of _instrument_classes.cpp, which all use the
+// helpers now. Both for buffer sizes of 64, 256 and 1024 frames, reported in
+// samples per second.
+//
+// Usage (from the bin folder):
+//   block_processing_bench [seconds]
+//
+//   seconds  audio rendered per voice, path and buffer size (default: 20)
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "al/io/al_AudioIOData.hpp"
+#include "al/scene/al_PolySynth.hpp"
+
+#include "_instrument_classes.cpp"
+
+const double sampleRate = 48000.0;
+
+// The unit generators of SineEnv, rendered without a voice around them
+struct SineEnvChain {
+  gam::Sine<> mOsc{440};
+  gam::Env<3> mAmpEnv;
+  gam::Pan<> mPan;
+  gam::EnvFollow<> mEnvFollow;
+  float amp{0.3f};
+
+  SineEnvChain() {
+    mAmpEnv.curve(0);
+    mAmpEnv.levels(0, 1, 1, 0);
+    mAmpEnv.lengths(0.01, 1, 0.5);
+    mAmpEnv.sustainPoint(2);
+  }
+
+  void perSample(AudioIOData &io) {
+    while (io()) {
+      float s1 = mOsc() * mAmpEnv() * amp;
+      float s2;
+      mEnvFollow(s1);
+      mPan(s1, s1, s2);
+      io.out(0) += s1;
+      io.out(1) += s2;
+    }
+  }
+
+  void perBlock(AudioIOData &io) {
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
+      block::generate(mOsc, s1, n);
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, amp, n);
+      block::follow(mEnvFollow, s1, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
+  }
+};
+
+// Samples per second of render(io) called for blocks of blockSize frames
+template <class Render>
+double renderRate(unsigned int blockSize, double seconds, Render render) {
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(2);
+
+  long numBlocks = long(seconds * sampleRate / blockSize);
+  auto start = std::chrono::steady_clock::now();
+  for (long block = 0; block < numBlocks; block++) {
+    io.zeroOut();
+    io.frame(0);
+    render(io);
+  }
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return numBlocks * blockSize / elapsed;
+}
+
+template <class TVoice>
+void benchVoice(PolySynth &synth, const char *className,
+                unsigned int blockSize, double seconds) {
+  TVoice *voice = synth.getVoice<TVoice>();
+  voice->triggerOn();
+  double rate = renderRate(blockSize, seconds,
+                           [&](AudioIOData &io) { voice->onProcess(io); });
+  voice->free();
+  std::cout << std::setw(10) << className << std::setw(8) << blockSize
+            << std::setw(14) << rate / 1e6 << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 20.0;
+
+  gam::sampleRate(sampleRate);
+
+  std::cout << "Million samples per second for one voice" << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(10) << "chain" << std::setw(8) << "frames"
+            << std::setw(14) << "per sample" << std::setw(14) << "per block"
+            << std::setw(11) << "speedup" << std::endl;
+  for (unsigned int blockSize : {64, 256, 1024}) {
+    SineEnvChain a, b;
+    double perSample = renderRate(blockSize, seconds,
+                                  [&](AudioIOData &io) { a.perSample(io); });
+    double perBlock = renderRate(blockSize, seconds,
+                                 [&](AudioIOData &io) { b.perBlock(io); });
+    std::cout << std::setw(10) << "SineEnv" << std::setw(8) << blockSize
+              << std::setw(14) << perSample / 1e6 << std::setw(14)
+              << perBlock / 1e6 << std::setw(10) << perBlock / perSample
+              << "x" << std::endl;
+  }
+  std::cout << std::endl;
+
+  std::cout << std::setw(10) << "class" << std::setw(8) << "frames"
+            << std::setw(14) << "per block" << std::endl;
+  PolySynth synth;
+  for (unsigned int blockSize : {64, 256, 1024}) {
+    benchVoice<SineEnv>(synth, "SineEnv", blockSize, seconds);
+    benchVoice<OscEnv>(synth, "OscEnv", blockSize, seconds);
+    benchVoice<Vib>(synth, "Vib", blockSize, seconds);
+    benchVoice<FM>(synth, "FM", blockSize, seconds);
+    benchVoice<FMWT>(synth, "FMWT", blockSize, seconds);
+    benchVoice<OscTrm>(synth, "OscTrm", blockSize, seconds);
+    benchVoice<OscAM>(synth, "OscAM", blockSize, seconds);
+    benchVoice<Sub>(synth, "Sub", blockSize, seconds);
+    std::cout << std::endl;
+  }
+  return 0;
+}
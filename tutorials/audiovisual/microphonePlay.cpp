@@ -6,7 +6,7 @@
 #include "al/app/al_App.hpp"
 #include "al/graphics/al_Shapes.hpp"
 #include "al/math/al_Random.hpp"
-#include "Gamma/DFT.h"
+#include "SpectrumAnalyzer.h"
 
 using namespace al;
 using namespace std;
@@ -17,15 +17,12 @@ using namespace std;
 
 struct MyApp : public App
 {
-  // STFT variables
-  // Window size
+  // Spectrum analyzer
+  // Window size, a power of two
   // Hop size; number of samples between transforms
-  // Pad size; number of zero-valued samples appended to window
-  // Window type: HAMMING, HANN, WELCH, NYQUIST, or etc
-  // Format of frequency samples: COMPLEX, MAG_PHASE, or MAG_FREQ
-  gam::STFT stft = gam::STFT(FFT_SIZE, FFT_SIZE / 4, 0, gam::HANN, gam::MAG_FREQ);
+  // Window type: RECTANGLE, HANN, HAMMING or BLACKMAN
+  SpectrumAnalyzer analyzer{FFT_SIZE, FFT_SIZE / 4, SpectrumAnalyzer::HANN};
   Mesh mSpectrogram;
-  vector<float> spectrum;
   float i_waveformData[BLOCK_SIZE * CHANNEL_COUNT]{0}; // Waveform variables
   float o_waveformData[BLOCK_SIZE * CHANNEL_COUNT]{0}; // Waveform variables
   Mesh i_waveformMesh[2]{Mesh::LINE_STRIP, Mesh::LINE_STRIP};
@@ -40,8 +37,8 @@ struct MyApp : public App
       quit();
       return;
     }
-    // Declare the size of the spectrum
-    spectrum.resize(FFT_SIZE / 2 + 1);
+    // Plain magnitudes, without scaling
+    analyzer.scaling(SpectrumAnalyzer::MAGNITUDE);
     mSpectrogram.primitive(Mesh::LINE_STRIP);
     nav().pos(Vec3f(0, 0, 0));
   }
@@ -64,6 +61,7 @@ struct MyApp : public App
     }
     // Spectrogram
     mSpectrogram.reset();
+    const float *spectrum = analyzer.spectrum();
     for (int i = 0; i < FFT_SIZE / 2; i++)
     {
       mSpectrogram.color(HSV(0.5 - spectrum[i] * 100));
@@ -72,16 +70,10 @@ struct MyApp : public App
   }
   void onSound(AudioIOData &io) override
   {
+    // Spectrum of the whole input block
+    analyzer.process(io.inBuffer(0), io.framesPerBuffer());
     while (io())
     {
-      if (stft(io.in(0)))
-      { // Loop through all the frequency bins
-        for (unsigned k = 0; k < stft.numBins(); ++k)
-        {
-          // Here we simply scale the complex sample
-          spectrum[k] = stft.bin(k).real();
-        }
-      }
       // // Process the outputs - Randomized
       io.out(0) = al::rnd::uniform(io.in(0)*10);
       io.out(1) = al::rnd::uniform(io.in(1)*10);
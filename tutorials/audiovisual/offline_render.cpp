@@ -0,0 +1,238 @@
+// Offline renderer for .synthSequence files
+//
+// Renders a sequence written for the integrated instrument set
+// (_instrument_classes.cpp) straight to a WAV file, as fast as the CPU
+// allows. No audio device or window is opened.
+//
+// Usage (from the bin folder):
+//   offline_render [sequence] [output.wav] [blockSize] [sampleRate] [threads]
+//
+//   sequence   path to a .synthSequence file
+//              (default: Integrated-data/integrated.synthSequence)
+//   output.wav destination file (default: sequence name + ".wav")
+//   blockSize  frames per rendered block (default: 512)
+//   sampleRate (default: 48000)
+//   threads    voice rendering threads (default: 1, see ParallelPolySynth.h)
+//
+// At the end the achieved realtime factor (seconds of audio rendered per
+// second of wall clock time) is printed so it can be tracked over time.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "al/io/al_AudioIOData.hpp"
+#include "al/scene/al_PolySynth.hpp"
+#include "al/scene/al_SynthSequencer.hpp"
+
+#include "_instrument_classes.cpp"
+#include "ParallelPolySynth.h"
+#include "SequenceEndTime.h"
+
+// Minimal streaming writer for 32-bit float WAV files. The header is written
+// with empty sizes on open and patched on close, so renders of any length
+// can be written block by block.
+//
+// WAV sizes are 32 bits, so a render past 4 GB can't be described by a WAV
+// header. The header reserves a JUNK chunk for the 64-bit sizes of RF64 (EBU
+// Tech 3306), as the bounce of spatial_sequencer.cpp writes through
+// libsndfile. close() turns it into a ds64 chunk and the file into RF64 only
+// when the data doesn't fit; smaller files stay plain WAV.
+class WavFileWriter {
+public:
+  bool open(const std::string &path, int channels, int sampleRate) {
+    mFile.open(path, std::ios::binary);
+    if (!mFile.is_open()) {
+      return false;
+    }
+    mChannels = channels;
+    mDataBytes = 0;
+    writeHeader(sampleRate);
+    return true;
+  }
+
+  void write(const float *interleaved, uint32_t frames) {
+    uint64_t bytes = uint64_t(frames) * mChannels * sizeof(float);
+    mFile.write(reinterpret_cast<const char *>(interleaved), bytes);
+    mDataBytes += bytes;
+  }
+
+  void close() {
+    if (!mFile.is_open()) {
+      return;
+    }
+    uint64_t riffSize = headerSize - 8 + mDataBytes;
+    if (riffSize <= UINT32_MAX) {
+      uint32_t riffSize32 = uint32_t(riffSize);
+      uint32_t dataSize32 = uint32_t(mDataBytes);
+      mFile.seekp(4);
+      mFile.write(reinterpret_cast<const char *>(&riffSize32), 4);
+      mFile.seekp(headerSize - 4);
+      mFile.write(reinterpret_cast<const char *>(&dataSize32), 4);
+    } else {
+      uint32_t unknown = UINT32_MAX; // Sizes are in ds64
+      uint64_t frames = mDataBytes / (mChannels * sizeof(float));
+      uint32_t tableLength = 0;
+      mFile.seekp(0);
+      mFile.write("RF64", 4);
+      mFile.write(reinterpret_cast<const char *>(&unknown), 4);
+      mFile.seekp(12);
+      mFile.write("ds64", 4);
+      mFile.seekp(20);
+      mFile.write(reinterpret_cast<const char *>(&riffSize), 8);
+      mFile.write(reinterpret_cast<const char *>(&mDataBytes), 8);
+      mFile.write(reinterpret_cast<const char *>(&frames), 8);
+      mFile.write(reinterpret_cast<const char *>(&tableLength), 4);
+      mFile.seekp(headerSize - 4);
+      mFile.write(reinterpret_cast<const char *>(&unknown), 4);
+    }
+    mFile.close();
+  }
+
+private:
+  static const int ds64Size = 28;
+  static const int headerSize = 12 + 8 + ds64Size + 24 + 8;
+
+  void writeHeader(int sampleRate) {
+    uint32_t zero = 0;
+    uint32_t junkSize = ds64Size;
+    char junk[ds64Size] = {};
+    uint32_t fmtSize = 16;
+    uint16_t formatFloat = 3; // WAVE_FORMAT_IEEE_FLOAT
+    uint16_t channels = mChannels;
+    uint32_t rate = sampleRate;
+    uint32_t byteRate = sampleRate * mChannels * sizeof(float);
+    uint16_t blockAlign = mChannels * sizeof(float);
+    uint16_t bits = 32;
+    mFile.write("RIFF", 4);
+    mFile.write(reinterpret_cast<const char *>(&zero), 4);
+    mFile.write("WAVE", 4);
+    mFile.write("JUNK", 4); // Room for ds64
+    mFile.write(reinterpret_cast<const char *>(&junkSize), 4);
+    mFile.write(junk, ds64Size);
+    mFile.write("fmt ", 4);
+    mFile.write(reinterpret_cast<const char *>(&fmtSize), 4);
+    mFile.write(reinterpret_cast<const char *>(&formatFloat), 2);
+    mFile.write(reinterpret_cast<const char *>(&channels), 2);
+    mFile.write(reinterpret_cast<const char *>(&rate), 4);
+    mFile.write(reinterpret_cast<const char *>(&byteRate), 4);
+    mFile.write(reinterpret_cast<const char *>(&blockAlign), 2);
+    mFile.write(reinterpret_cast<const char *>(&bits), 2);
+    mFile.write("data", 4);
+    mFile.write(reinterpret_cast<const char *>(&zero), 4);
+  }
+
+  std::ofstream mFile;
+  int mChannels{2};
+  uint64_t mDataBytes{0};
+};
+
+int main(int argc, char *argv[]) {
+  std::string sequencePath = "Integrated-data/integrated.synthSequence";
+  if (argc > 1) {
+    sequencePath = argv[1];
+  }
+  std::string outPath;
+  if (argc > 2) {
+    outPath = argv[2];
+  } else {
+    outPath = sequencePath.substr(sequencePath.find_last_of("/\\") + 1);
+    outPath = outPath.substr(0, outPath.rfind(".synthSequence")) + ".wav";
+  }
+  unsigned int blockSize = argc > 3 ? std::stoi(argv[3]) : 512;
+  double sampleRate = argc > 4 ? std::stod(argv[4]) : 48000.0;
+  unsigned int numThreads = argc > 5 ? std::stoi(argv[5]) : 1;
+  const int channels = 2;
+
+  // Gamma objects read the sample rate when constructed, so this must be set
+  // before any voice is allocated.
+  gam::sampleRate(sampleRate);
+
+  std::string directory = ".";
+  std::string sequenceName = sequencePath;
+  size_t slash = sequencePath.find_last_of("/\\");
+  if (slash != std::string::npos) {
+    directory = sequencePath.substr(0, slash);
+    sequenceName = sequencePath.substr(slash + 1);
+  }
+
+  double endTime = sequenceEndTime(sequencePath);
+  if (endTime <= 0.0) {
+    std::cerr << "ERROR: no events found in " << sequencePath << std::endl;
+    return -1;
+  }
+
+  ParallelPolySynth synth{numThreads};
+  synth.registerSynthClass<SineEnv>();
+  synth.registerSynthClass<OscEnv>();
+  synth.registerSynthClass<Vib>();
+  synth.registerSynthClass<FM>();
+  synth.registerSynthClass<FMWT>();
+  synth.registerSynthClass<OscAM>();
+  synth.registerSynthClass<OscTrm>();
+  synth.registerSynthClass<AddSyn>();
+  synth.registerSynthClass<Sub>();
+  synth.registerSynthClass<PluckedString>();
+  // Voices past this many render serially
+  synth.prepare(blockSize, channels, 256);
+
+  SynthSequencer sequencer{TimeMasterMode::TIME_MASTER_AUDIO};
+  sequencer << synth;
+
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(channels);
+
+  WavFileWriter writer;
+  if (!writer.open(outPath, channels, sampleRate)) {
+    std::cerr << "ERROR: opening " << outPath << " for writing" << std::endl;
+    return -1;
+  }
+
+  sequencer.setDirectory(directory);
+  sequencer.playSequence(sequenceName);
+
+  std::cout << "Rendering " << sequencePath << " (" << endTime << " s) to "
+            << outPath << " using " << numThreads << " thread(s)" << std::endl;
+
+  // Voices keep sounding past the last event while they release. Stop once
+  // they are all freed, with a hard limit in case a voice never frees itself.
+  const double maxTail = 30.0;
+  std::vector<float> interleaved(blockSize * channels);
+  uint64_t framesRendered = 0;
+  auto startClock = std::chrono::steady_clock::now();
+  while (true) {
+    double time = framesRendered / sampleRate;
+    if (time >= endTime && (synth.getActiveVoices() == nullptr ||
+                            time >= endTime + maxTail)) {
+      break;
+    }
+    io.zeroOut();
+    io.frame(0);
+    sequencer.render(io);
+    for (int chan = 0; chan < channels; chan++) {
+      const float *out = io.outBuffer(chan);
+      for (unsigned int i = 0; i < blockSize; i++) {
+        interleaved[i * channels + chan] = out[i];
+      }
+    }
+    writer.write(interleaved.data(), blockSize);
+    framesRendered += blockSize;
+  }
+  auto endClock = std::chrono::steady_clock::now();
+  writer.close();
+
+  double wallSeconds =
+      std::chrono::duration<double>(endClock - startClock).count();
+  double audioSeconds = framesRendered / sampleRate;
+  std::cout << "Rendered " << audioSeconds << " s of audio in " << wallSeconds
+            << " s" << std::endl;
+  std::cout << "Realtime factor: " << audioSeconds / wallSeconds << "x"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,134 @@
+// Benchmark for ParallelPolySynth
+//
+// Triggers a dense cluster of AddSyn and FMWT voices, renders it once with
+// the serial PolySynth as reference and then with ParallelPolySynth from 1
+// to N threads. Every parallel render is compared sample by sample against
+// the reference, and the throughput for each thread count is reported.
+//
+// Usage (from the bin folder):
+//   parallel_render_bench [voices] [blocks] [blockSize] [maxThreads]
+//
+//   voices     number of AddSyn voices and of FMWT voices (default: 32)
+//   blocks     blocks rendered per run (default: 2000)
+//   blockSize  frames per block (default: 512)
+//   maxThreads highest thread count tested (default: hardware threads)
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "al/io/al_AudioIOData.hpp"
+#include "al/scene/al_PolySynth.hpp"
+
+#include "_instrument_classes.cpp"
+#include "ParallelPolySynth.h"
+
+const double sampleRate = 48000.0;
+
+// Trigger the same chord of voices on any synth so every run renders the
+// same material.
+void triggerVoices(PolySynth &synth, int numVoices) {
+  int id = 0;
+  for (int i = 0; i < numVoices; i++) {
+    float freq = 110.0f * ::pow(2.0f, (i % 36) / 12.0f);
+    float pan = -1.0f + 2.0f * i / numVoices;
+
+    auto *add = synth.getVoice<AddSyn>();
+    add->setInternalParameterValue("frequency", freq);
+    add->setInternalParameterValue("pan", pan);
+    add->setInternalParameterValue("releaseStri", 3.0);
+    synth.triggerOn(add, 0, id++);
+
+    auto *fm = synth.getVoice<FMWT>();
+    fm->setInternalParameterValue("frequency", freq * 1.5f);
+    fm->setInternalParameterValue("pan", -pan);
+    fm->setInternalParameterValue("table", i % 9);
+    synth.triggerOn(fm, 0, id++);
+  }
+}
+
+// Render the given number of blocks and return the elapsed wall time. The
+// left and right channels are appended to output.
+double renderBlocks(PolySynth &synth, int numBlocks, unsigned int blockSize,
+                    std::vector<float> &output) {
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(2);
+  output.clear();
+  output.reserve(size_t(numBlocks) * blockSize * 2);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int block = 0; block < numBlocks; block++) {
+    io.zeroOut();
+    io.frame(0);
+    synth.render(io);
+    for (int chan = 0; chan < 2; chan++) {
+      const float *out = io.outBuffer(chan);
+      output.insert(output.end(), out, out + blockSize);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char *argv[]) {
+  int numVoices = argc > 1 ? std::stoi(argv[1]) : 32;
+  int numBlocks = argc > 2 ? std::stoi(argv[2]) : 2000;
+  unsigned int blockSize = argc > 3 ? std::stoi(argv[3]) : 512;
+  unsigned int maxThreads =
+      argc > 4 ? std::stoi(argv[4]) : std::thread::hardware_concurrency();
+  if (maxThreads < 1) {
+    maxThreads = 1;
+  }
+
+  gam::sampleRate(sampleRate);
+  double audioSeconds = numBlocks * blockSize / sampleRate;
+
+  std::cout << 2 * numVoices << " voices, " << numBlocks << " blocks of "
+            << blockSize << " frames (" << audioSeconds << " s of audio)"
+            << std::endl;
+
+  std::vector<float> reference;
+  double serialTime;
+  {
+    PolySynth synth;
+    triggerVoices(synth, numVoices);
+    serialTime = renderBlocks(synth, numBlocks, blockSize, reference);
+  }
+  std::cout << "PolySynth (serial): " << serialTime << " s, "
+            << audioSeconds / serialTime << "x realtime" << std::endl;
+
+  bool allMatch = true;
+  std::vector<float> output;
+  for (unsigned int threads = 1; threads <= maxThreads; threads++) {
+    ParallelPolySynth synth{threads};
+    synth.prepare(blockSize, 2, 2 * numVoices);
+    triggerVoices(synth, numVoices);
+    double time = renderBlocks(synth, numBlocks, blockSize, output);
+
+    // Compare bit patterns, not values, so that -0.0/0.0 or NaN differences
+    // are caught as well.
+    bool match = output.size() == reference.size() &&
+                 std::memcmp(output.data(), reference.data(),
+                             output.size() * sizeof(float)) == 0;
+    allMatch = allMatch && match;
+
+    std::cout << "ParallelPolySynth " << threads << " thread(s): " << time
+              << " s, " << audioSeconds / time << "x realtime, speedup "
+              << serialTime / time << (match ? "" : "  OUTPUT DIFFERS")
+              << std::endl;
+  }
+
+  if (!allMatch) {
+    std::cerr << "ERROR: parallel output does not match the serial render"
+              << std::endl;
+    return -1;
+  }
+  std::cout << "All outputs bit-identical to the serial render" << std::endl;
+  return 0;
+}
@@ -0,0 +1,101 @@
+// Per-sample gam::STFT vs. block SpectrumAnalyzer
+//
+// Analyzes white noise with a hop of a quarter of the FFT size, for FFT sizes
+// of 1024 and 4096:
+//  - "STFT": gam::STFT(size, size / 4, 0, HANN, MAG_FREQ) fed one sample at a
+//    time, then tanh(pow(bin, 1.3)) per bin, as the visual tutorials used to
+//    do,
+//  - "magnitude": SpectrumAnalyzer fed 512-sample blocks, plain magnitudes,
+//  - "curve": the same with the tanh(pow(mag, 1.3)) scaling.
+// Reports spectra (frames) per second for each.
+//
+// Usage (from the bin folder):
+//   spectrum_analyzer_bench [seconds]
+//
+//   seconds  audio analyzed per FFT size and path (default: 60)
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Gamma/DFT.h"
+#include "Gamma/Domain.h"
+#include "al/math/al_Random.hpp"
+
+#include "SpectrumAnalyzer.h"
+
+const double sampleRate = 48000.0;
+const int blockSize = 512;
+
+std::vector<float> noise(double seconds) {
+  std::vector<float> samples(size_t(seconds * sampleRate));
+  for (auto &s : samples) {
+    s = al::rnd::uniformS();
+  }
+  return samples;
+}
+
+// Frames per second of the per-sample STFT
+double stftRate(int size, const std::vector<float> &samples) {
+  gam::STFT stft(size, size / 4, 0, gam::HANN, gam::MAG_FREQ);
+  std::vector<float> spectrum(stft.numBins());
+  long frames = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (float s : samples) {
+    if (stft(s)) {
+      for (unsigned k = 0; k < stft.numBins(); ++k) {
+        spectrum[k] = std::tanh(std::pow(stft.bin(k).real(), 1.3f));
+      }
+      frames++;
+    }
+  }
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return frames / elapsed;
+}
+
+// Frames per second of SpectrumAnalyzer fed whole blocks
+double analyzerRate(int size, SpectrumAnalyzer::Scaling scaling,
+                    const std::vector<float> &samples) {
+  SpectrumAnalyzer analyzer(size, size / 4, SpectrumAnalyzer::HANN);
+  analyzer.scaling(scaling, 1.3f);
+  long frames = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i + blockSize <= samples.size(); i += blockSize) {
+    frames += analyzer.process(samples.data() + i, blockSize);
+  }
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return frames / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 60.0;
+
+  gam::sampleRate(sampleRate);
+  std::vector<float> samples = noise(seconds);
+
+  std::cout << "SIMD width: " << spectrum::Simd::width
+            << " floats. Frames per second." << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(0);
+  std::cout << std::setw(8) << "size" << std::setw(12) << "STFT"
+            << std::setw(12) << "magnitude" << std::setw(12) << "curve"
+            << std::setw(10) << "speedup" << std::endl;
+  for (int size : {1024, 4096}) {
+    double stft = stftRate(size, samples);
+    double magnitude =
+        analyzerRate(size, SpectrumAnalyzer::MAGNITUDE, samples);
+    double curve = analyzerRate(size, SpectrumAnalyzer::CURVE, samples);
+    std::cout << std::setw(8) << size << std::setw(12) << stft
+              << std::setw(12) << magnitude << std::setw(12) << curve
+              << std::setw(9) << std::setprecision(1) << curve / stft << "x"
+              << std::setprecision(0) << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Audio callback time of PluckedString voices that draw their spectrum
+//
+// Renders 1, 8 and 32 PluckedString voices of _instrument_classes.cpp in real
+// time, 512 frames per callback, and times the callback:
+//  - "inline": a 4048-point gam::STFT per voice runs in the callback, as
+//    PluckedString used to do (the voices still queue their output too),
+//  - "pool": the voices only queue their output, and SpectrumPool's worker
+//    threads compute the spectra.
+// Reports mean and worst callback time, the mean as a share of the buffer
+// period, and the samples the workers had to drop.
+//
+// Usage (from the bin folder):
+//   spectrum_voice_bench [seconds]
+//
+//   seconds  audio rendered per voice count and path (default: 5)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "al/io/al_AudioIOData.hpp"
+#include "al/scene/al_PolySynth.hpp"
+
+#include "_instrument_classes.cpp"
+
+const double sampleRate = 48000.0;
+const unsigned int blockSize = 512;
+
+void bench(PolySynth &synth, int numVoices, bool inlineStft, double seconds) {
+  std::vector<PluckedString *> voices;
+  std::vector<std::unique_ptr<gam::STFT>> stfts;
+  std::vector<float> spectrum(FFT_SIZE / 2 + 1);
+  for (int i = 0; i < numVoices; i++) {
+    voices.push_back(synth.getVoice<PluckedString>());
+    voices.back()->triggerOn();
+    stfts.emplace_back(new gam::STFT(FFT_SIZE, FFT_SIZE / 4, 0, gam::HANN,
+                                     gam::MAG_FREQ));
+  }
+  uint64_t overruns = 0;
+  for (auto *voice : voices) {
+    overruns -= voice->mAnalysis->overruns();
+  }
+
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(2);
+
+  auto period = std::chrono::duration<double>(blockSize / sampleRate);
+  long numBlocks = long(seconds * sampleRate / blockSize);
+  double total = 0, worst = 0;
+  auto deadline = std::chrono::steady_clock::now();
+  for (long block = 0; block < numBlocks; block++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int v = 0; v < numVoices; v++) {
+      io.zeroOut();
+      io.frame(0);
+      voices[v]->onProcess(io);
+      if (inlineStft) {
+        const float *out = io.outBuffer(0);
+        for (unsigned i = 0; i < blockSize; i++) {
+          if ((*stfts[v])(out[i])) {
+            for (unsigned k = 0; k < stfts[v]->numBins(); ++k) {
+              spectrum[k] = std::tanh(std::pow(stfts[v]->bin(k).real(), 1.3f));
+            }
+          }
+        }
+      }
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    total += elapsed;
+    worst = std::max(worst, elapsed);
+    // Pace the callbacks like an audio device would
+    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        period);
+    std::this_thread::sleep_until(deadline);
+  }
+  for (auto *voice : voices) {
+    overruns += voice->mAnalysis->overruns();
+    voice->free();
+  }
+
+  double mean = total / numBlocks;
+  std::cout << std::setw(8) << numVoices << std::setw(8)
+            << (inlineStft ? "inline" : "pool") << std::setw(12) << mean
+            << std::setw(12) << worst << std::setw(10)
+            << 100.0 * mean / (period.count() * 1e6) << "%" << std::setw(11)
+            << overruns << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? std::stod(argv[1]) : 5.0;
+
+  gam::sampleRate(sampleRate);
+
+  std::cout << "SpectrumPool workers: " << SpectrumPool::get().numWorkers()
+            << ". Times in microseconds per callback." << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(8) << "voices" << std::setw(8) << "path"
+            << std::setw(12) << "mean" << std::setw(12) << "worst"
+            << std::setw(11) << "load" << std::setw(11) << "dropped"
+            << std::endl;
+  PolySynth synth;
+  for (int numVoices : {1, 8, 32}) {
+    bench(synth, numVoices, true, seconds);
+    bench(synth, numVoices, false, seconds);
+  }
+  return 0;
+}
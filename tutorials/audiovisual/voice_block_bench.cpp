@@ -0,0 +1,115 @@
+// Per-voice block cost of the integrated instrument classes
+//
+// For each voice class in _instrument_classes.cpp this measures the time one
+// onProcess(AudioIOData&) call takes for a block:
+//  - "by name": the voice as it was before ParamHandle, reading every
+//    trigger parameter with getInternalParameterValue() at the top of the
+//    block and then rendering it,
+//  - "by handle": the voice as it is now, reading its parameters through
+//    ParamHandle::get().
+// Both render the same notes, so the difference is the cost of the lookups.
+//
+// Usage (from the bin folder):
+//   voice_block_bench [blocks] [blockSize]
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "al/io/al_AudioIOData.hpp"
+#include "al/scene/al_PolySynth.hpp"
+
+#include "_instrument_classes.cpp"
+
+const double sampleRate = 48000.0;
+
+// Keeps the compiler from dropping the parameter reads
+volatile float sink;
+
+// TVoice reading its trigger parameters by name at the top of every block
+template <class TVoice> class ByName : public TVoice {
+public:
+  using TVoice::onProcess;
+
+  void onProcess(AudioIOData &io) override {
+    float acc = 0;
+    for (auto &name : names) {
+      acc += this->getInternalParameterValue(name);
+    }
+    sink = acc;
+    TVoice::onProcess(io);
+  }
+
+  std::vector<std::string> names;
+};
+
+// Nanoseconds per onProcess() call of a freshly triggered voice
+template <class TVoice>
+double blockTime(TVoice *voice, int numBlocks, unsigned int blockSize) {
+  AudioIOData io;
+  io.framesPerSecond(sampleRate);
+  io.framesPerBuffer(blockSize);
+  io.channelsOut(2);
+
+  voice->triggerOn();
+  auto start = std::chrono::steady_clock::now();
+  for (int block = 0; block < numBlocks; block++) {
+    io.zeroOut();
+    io.frame(0);
+    voice->onProcess(io);
+  }
+  double ns = std::chrono::duration<double, std::nano>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  voice->free();
+  return ns / numBlocks;
+}
+
+template <class TVoice>
+void benchVoice(PolySynth &synth, const char *className, int numBlocks,
+                unsigned int blockSize) {
+  auto *before = synth.getVoice<ByName<TVoice>>();
+  for (auto *meta : before->triggerParameters()) {
+    if (auto *param = dynamic_cast<Parameter *>(meta)) {
+      before->names.push_back(param->getName());
+    }
+  }
+  double byName = blockTime(before, numBlocks, blockSize);
+  double byHandle =
+      blockTime(synth.getVoice<TVoice>(), numBlocks, blockSize);
+
+  std::cout << std::setw(14) << className << std::setw(8)
+            << before->names.size() << std::setw(14) << byName
+            << std::setw(14) << byHandle << std::setw(10)
+            << byName / byHandle << "x" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  int numBlocks = argc > 1 ? std::stoi(argv[1]) : 2000;
+  unsigned int blockSize = argc > 2 ? std::stoi(argv[2]) : 512;
+
+  gam::sampleRate(sampleRate);
+
+  std::cout << numBlocks << " blocks of " << blockSize << " frames" << std::endl
+            << "Times are in nanoseconds per block and voice." << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::setw(14) << "class" << std::setw(8) << "params"
+            << std::setw(14) << "by name" << std::setw(14) << "by handle"
+            << std::setw(11) << "speedup" << std::endl;
+
+  PolySynth synth;
+  benchVoice<SineEnv>(synth, "SineEnv", numBlocks, blockSize);
+  benchVoice<OscEnv>(synth, "OscEnv", numBlocks, blockSize);
+  benchVoice<Vib>(synth, "Vib", numBlocks, blockSize);
+  benchVoice<FM>(synth, "FM", numBlocks, blockSize);
+  benchVoice<FMWT>(synth, "FMWT", numBlocks, blockSize);
+  benchVoice<OscTrm>(synth, "OscTrm", numBlocks, blockSize);
+  benchVoice<OscAM>(synth, "OscAM", numBlocks, blockSize);
+  benchVoice<AddSyn>(synth, "AddSyn", numBlocks, blockSize);
+  benchVoice<Sub>(synth, "Sub", numBlocks, blockSize);
+  benchVoice<PluckedString>(synth, "PluckedString", numBlocks, blockSize);
+  return 0;
+}
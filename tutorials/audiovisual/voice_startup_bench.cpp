@@ -0,0 +1,125 @@
+// Startup time and mesh memory of the integrated instrument set
+//
+// Preallocates voices of every class in _instrument_classes.cpp, as
+// 10_integrated does when it registers them, and reports for each class:
+//  - "before": allocation time when every voice also builds its own meshes,
+//    as the voices used to do in init(), and the memory those meshes take,
+//  - "after": allocation time with the meshes shared through MeshCache.
+// The totals compare the per-voice meshes with what MeshCache holds.
+//
+// Usage (from the bin folder):
+//   voice_startup_bench [voices]
+//
+//   voices  voices preallocated per class (default: 64)
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "al/scene/al_PolySynth.hpp"
+
+#include "_instrument_classes.cpp"
+
+const double sampleRate = 48000.0;
+
+// Meshes one voice of a class used to build, returns their size in bytes
+size_t sphereMesh(double radius, int slices, int stacks) {
+  Mesh m;
+  addSphere(m, radius, slices, stacks);
+  m.decompress();
+  m.generateNormals();
+  return MeshCache::bytes(m);
+}
+
+size_t waveformMeshes() {
+  size_t bytes = 0;
+  for (int i = 0; i < 9; i++) {
+    Mesh m;
+    addWaveformMesh(m, i);
+    bytes += MeshCache::bytes(m);
+  }
+  return bytes;
+}
+
+size_t discMesh() {
+  Mesh m;
+  addDisc(m, 1.0, 30);
+  return MeshCache::bytes(m);
+}
+
+struct Totals {
+  double before{0}, after{0};
+  size_t perVoiceBytes{0};
+};
+
+// Milliseconds to preallocate numVoices voices
+template <class TVoice>
+double allocate(int numVoices, const std::function<size_t()> &legacyMeshes,
+                size_t *legacyBytes) {
+  PolySynth synth;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < numVoices; i++) {
+    synth.allocatePolyphony<TVoice>(1);
+    if (legacyMeshes) {
+      *legacyBytes += legacyMeshes();
+    }
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+template <class TVoice>
+void benchVoice(const char *className, int numVoices,
+                const std::function<size_t()> &legacyMeshes, Totals &totals) {
+  // "after" runs first, so it includes building the shared meshes
+  double after = allocate<TVoice>(numVoices, nullptr, nullptr);
+  size_t bytes = 0;
+  double before = allocate<TVoice>(numVoices, legacyMeshes, &bytes);
+  totals.before += before;
+  totals.after += after;
+  totals.perVoiceBytes += bytes;
+  std::cout << std::setw(14) << className << std::setw(12) << before
+            << std::setw(12) << after << std::setw(14) << bytes / 1048576.0
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  int numVoices = argc > 1 ? std::stoi(argv[1]) : 64;
+
+  gam::sampleRate(sampleRate);
+
+  std::cout << numVoices << " voices per class. Times in milliseconds."
+            << std::endl
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(14) << "class" << std::setw(12) << "before"
+            << std::setw(12) << "after" << std::setw(14) << "meshes (MB)"
+            << std::endl;
+
+  Totals totals;
+  auto bigSphere = [] { return sphereMesh(1, 100, 100); };
+  benchVoice<SineEnv>("SineEnv", numVoices,
+                      [] { return sphereMesh(0.3, 50, 50); }, totals);
+  benchVoice<OscEnv>("OscEnv", numVoices, waveformMeshes, totals);
+  benchVoice<Vib>("Vib", numVoices, waveformMeshes, totals);
+  benchVoice<FM>("FM", numVoices, bigSphere, totals);
+  benchVoice<FMWT>("FMWT", numVoices, waveformMeshes, totals);
+  benchVoice<OscTrm>("OscTrm", numVoices, waveformMeshes, totals);
+  benchVoice<OscAM>("OscAM", numVoices, bigSphere, totals);
+  benchVoice<AddSyn>("AddSyn", numVoices, bigSphere, totals);
+  benchVoice<Sub>("Sub", numVoices, bigSphere, totals);
+  benchVoice<PluckedString>("PluckedString", numVoices, discMesh, totals);
+
+  std::cout << std::setw(14) << "total" << std::setw(12) << totals.before
+            << std::setw(12) << totals.after << std::endl
+            << std::endl;
+  std::cout << "Mesh memory before: " << totals.perVoiceBytes / 1048576.0
+            << " MB in per-voice meshes" << std::endl
+            << "Mesh memory after:  " << MeshCache::get().bytes() / 1048576.0
+            << " MB in " << MeshCache::get().numMeshes() << " shared meshes"
+            << std::endl;
+  return 0;
+}
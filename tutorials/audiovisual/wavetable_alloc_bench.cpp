@@ -0,0 +1,111 @@
+// Voice allocation time with shared wavetables
+//
+// Allocates voices of each _instrument_classes.cpp class that plays a
+// wavetable, one at a time like PolySynth does when it runs out of free
+// voices:
+//  - "before": each init() also adds the partials of every table again, as
+//    the voices used to do with the global tbSaw, tbSqr... tables,
+//  - "after": init() only makes sure WavetableBank is built.
+// Also reports the one-off cost of building the bank.
+//
+// Usage (from the bin folder):
+//   wavetable_alloc_bench [voices]
+//
+//   voices  voices allocated per class and path (default: 64)
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "al/scene/al_PolySynth.hpp"
+
+#include "_instrument_classes.cpp"
+
+const double sampleRate = 48000.0;
+
+// What every voice's init() used to do to the global tables
+void legacyTables() {
+  static gam::ArrayPow2<float> tbSaw(2048), tbSqr(2048), tbImp(2048),
+      tbSin(2048), tbPls(2048), tb__1(2048), tb__2(2048), tb__3(2048),
+      tb__4(2048);
+  gam::addSinesPow<1>(tbSaw, 9, 1);
+  gam::addSinesPow<1>(tbSqr, 9, 2);
+  gam::addSinesPow<0>(tbImp, 9, 1);
+  gam::addSine(tbSin);
+  {
+    float A[] = {1, 1, 1, 1, 0.7, 0.5, 0.3, 0.1};
+    gam::addSines(tbPls, A, 8);
+  }
+  {
+    float A[] = {1, 0.4, 0.65, 0.3, 0.18, 0.08};
+    float C[] = {1, 4, 7, 11, 15, 18};
+    gam::addSines(tb__1, A, C, 6);
+  }
+  {
+    float A[] = {0.5, 0.8, 0.7, 1, 0.3, 0.4, 0.2, 0.12};
+    float C[] = {3, 4, 7, 8, 11, 12, 15, 16};
+    gam::addSines(tb__2, A, C, 8);
+  }
+  {
+    float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08};
+    float C[] = {10, 27, 54, 81, 108, 135};
+    gam::addSines(tb__3, A, C, 6);
+  }
+  {
+    float A[] = {0.2, 0.4, 0.6, 1, 0.7, 0.5, 0.3, 0.1};
+    gam::addSines(tb__4, A, 8, 20);
+  }
+}
+
+// Milliseconds to allocate numVoices voices
+template <class TVoice> double allocate(bool before, int numVoices) {
+  PolySynth synth;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < numVoices; i++) {
+    synth.allocatePolyphony<TVoice>(1);
+    if (before) {
+      legacyTables();
+    }
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+template <class TVoice>
+void benchVoice(const char *className, int numVoices) {
+  double before = allocate<TVoice>(true, numVoices);
+  double after = allocate<TVoice>(false, numVoices);
+  std::cout << std::setw(10) << className << std::setw(12) << before
+            << std::setw(12) << after << std::setw(10) << before / after
+            << "x" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  int numVoices = argc > 1 ? std::stoi(argv[1]) : 64;
+
+  gam::sampleRate(sampleRate);
+
+  auto start = std::chrono::steady_clock::now();
+  WavetableBank &bank = WavetableBank::get();
+  double buildTime = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "WavetableBank: " << bank.numTables() << " tables built in "
+            << buildTime << " ms" << std::endl
+            << std::endl;
+
+  std::cout << "Milliseconds to allocate " << numVoices << " voices"
+            << std::endl
+            << std::endl;
+  std::cout << std::setw(10) << "class" << std::setw(12) << "before"
+            << std::setw(12) << "after" << std::setw(11) << "speedup"
+            << std::endl;
+  benchVoice<OscEnv>("OscEnv", numVoices);
+  benchVoice<Vib>("Vib", numVoices);
+  benchVoice<FMWT>("FMWT", numVoices);
+  benchVoice<OscTrm>("OscTrm", numVoices);
+  return 0;
+}
@@ -13,6 +13,8 @@
 #include "al/ui/al_ControlGUI.hpp"
 #include "al/ui/al_Parameter.hpp"
 
+#include "ParamHandle.h"
+
 using namespace gam;
 using namespace al;
 using namespace std;
@@ -38,6 +40,12 @@ public:
   // Additional members
   Mesh mMesh;
 
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pAmp, pFrequency, pAmpStri, pAttackStri, pReleaseStri,
+      pSustainStri, pAmpLow, pAttackLow, pReleaseLow, pSustainLow, pAmpUp,
+      pAttackUp, pReleaseUp, pSustainUp, pFreqStri1, pFreqStri2, pFreqStri3,
+      pFreqLow1, pFreqLow2, pFreqUp1, pFreqUp2, pFreqUp3, pFreqUp4, pPan;
+
   virtual void init() {
 
     // Intialize envelopes
@@ -57,50 +65,50 @@ public:
     // We have the mesh be a sphere
     addDisc(mMesh, 1.0, 30);
 
-    createInternalTriggerParameter("amp", 0.01, 0.0, 0.3);
-    createInternalTriggerParameter("frequency", 60, 20, 5000);
-    createInternalTriggerParameter("ampStri", 0.5, 0.0, 1.0);
-    createInternalTriggerParameter("attackStri", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseStri", 0.1, 0.1, 10.0);
-    createInternalTriggerParameter("sustainStri", 0.8, 0.0, 1.0);
-    createInternalTriggerParameter("ampLow", 0.5, 0.0, 1.0);
-    createInternalTriggerParameter("attackLow", 0.001, 0.01, 3.0);
-    createInternalTriggerParameter("releaseLow", 0.1, 0.1, 10.0);
-    createInternalTriggerParameter("sustainLow", 0.8, 0.0, 1.0);
-    createInternalTriggerParameter("ampUp", 0.6, 0.0, 1.0);
-    createInternalTriggerParameter("attackUp", 0.01, 0.01, 3.0);
-    createInternalTriggerParameter("releaseUp", 0.075, 0.1, 10.0);
-    createInternalTriggerParameter("sustainUp", 0.9, 0.0, 1.0);
-    createInternalTriggerParameter("freqStri1", 1.0, 0.1, 10);
-    createInternalTriggerParameter("freqStri2", 2.001, 0.1, 10);
-    createInternalTriggerParameter("freqStri3", 3.0, 0.1, 10);
-    createInternalTriggerParameter("freqLow1", 4.009, 0.1, 10);
-    createInternalTriggerParameter("freqLow2", 5.002, 0.1, 10);
-    createInternalTriggerParameter("freqUp1", 6.0, 0.1, 10);
-    createInternalTriggerParameter("freqUp2", 7.0, 0.1, 10);
-    createInternalTriggerParameter("freqUp3", 8.0, 0.1, 10);
-    createInternalTriggerParameter("freqUp4", 9.0, 0.1, 10);
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
+    pAmp.bind(createInternalTriggerParameter("amp", 0.01, 0.0, 0.3));
+    pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+    pAmpStri.bind(createInternalTriggerParameter("ampStri", 0.5, 0.0, 1.0));
+    pAttackStri.bind(createInternalTriggerParameter("attackStri", 0.1, 0.01, 3.0));
+    pReleaseStri.bind(createInternalTriggerParameter("releaseStri", 0.1, 0.1, 10.0));
+    pSustainStri.bind(createInternalTriggerParameter("sustainStri", 0.8, 0.0, 1.0));
+    pAmpLow.bind(createInternalTriggerParameter("ampLow", 0.5, 0.0, 1.0));
+    pAttackLow.bind(createInternalTriggerParameter("attackLow", 0.001, 0.01, 3.0));
+    pReleaseLow.bind(createInternalTriggerParameter("releaseLow", 0.1, 0.1, 10.0));
+    pSustainLow.bind(createInternalTriggerParameter("sustainLow", 0.8, 0.0, 1.0));
+    pAmpUp.bind(createInternalTriggerParameter("ampUp", 0.6, 0.0, 1.0));
+    pAttackUp.bind(createInternalTriggerParameter("attackUp", 0.01, 0.01, 3.0));
+    pReleaseUp.bind(createInternalTriggerParameter("releaseUp", 0.075, 0.1, 10.0));
+    pSustainUp.bind(createInternalTriggerParameter("sustainUp", 0.9, 0.0, 1.0));
+    pFreqStri1.bind(createInternalTriggerParameter("freqStri1", 1.0, 0.1, 10));
+    pFreqStri2.bind(createInternalTriggerParameter("freqStri2", 2.001, 0.1, 10));
+    pFreqStri3.bind(createInternalTriggerParameter("freqStri3", 3.0, 0.1, 10));
+    pFreqLow1.bind(createInternalTriggerParameter("freqLow1", 4.009, 0.1, 10));
+    pFreqLow2.bind(createInternalTriggerParameter("freqLow2", 5.002, 0.1, 10));
+    pFreqUp1.bind(createInternalTriggerParameter("freqUp1", 6.0, 0.1, 10));
+    pFreqUp2.bind(createInternalTriggerParameter("freqUp2", 7.0, 0.1, 10));
+    pFreqUp3.bind(createInternalTriggerParameter("freqUp3", 8.0, 0.1, 10));
+    pFreqUp4.bind(createInternalTriggerParameter("freqUp4", 9.0, 0.1, 10));
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
   }
 
   virtual void onProcess(AudioIOData &io) override {
     // Parameters will update values once per audio callback
-    float freq = getInternalParameterValue("frequency");
+    float freq = pFrequency.get();
     mOsc.freq(freq);
-    mOsc1.freq(getInternalParameterValue("freqStri1") * freq);
-    mOsc2.freq(getInternalParameterValue("freqStri2") * freq);
-    mOsc3.freq(getInternalParameterValue("freqStri3") * freq);
-    mOsc4.freq(getInternalParameterValue("freqLow1") * freq);
-    mOsc5.freq(getInternalParameterValue("freqLow2") * freq);
-    mOsc6.freq(getInternalParameterValue("freqUp1") * freq);
-    mOsc7.freq(getInternalParameterValue("freqUp2") * freq);
-    mOsc8.freq(getInternalParameterValue("freqUp3") * freq);
-    mOsc9.freq(getInternalParameterValue("freqUp4") * freq);
-    mPan.pos(getInternalParameterValue("pan"));
-    float ampStri = getInternalParameterValue("ampStri");
-    float ampUp = getInternalParameterValue("ampUp");
-    float ampLow = getInternalParameterValue("ampLow");
-    float amp = getInternalParameterValue("amp");
+    mOsc1.freq(pFreqStri1.get() * freq);
+    mOsc2.freq(pFreqStri2.get() * freq);
+    mOsc3.freq(pFreqStri3.get() * freq);
+    mOsc4.freq(pFreqLow1.get() * freq);
+    mOsc5.freq(pFreqLow2.get() * freq);
+    mOsc6.freq(pFreqUp1.get() * freq);
+    mOsc7.freq(pFreqUp2.get() * freq);
+    mOsc8.freq(pFreqUp3.get() * freq);
+    mOsc9.freq(pFreqUp4.get() * freq);
+    mPan.pos(pPan.get());
+    float ampStri = pAmpStri.get();
+    float ampUp = pAmpUp.get();
+    float ampLow = pAmpLow.get();
+    float amp = pAmp.get();
     while (io()) {
       float s1 = (mOsc1() + mOsc2() + mOsc3()) * mEnvStri() * ampStri;
       s1 += (mOsc4() + mOsc5()) * mEnvLow() * ampLow;
@@ -119,7 +127,7 @@ public:
   }
 
   virtual void onProcess(Graphics &g) {
-    float frequency = getInternalParameterValue("frequency");
+    float frequency = pFrequency.get();
     float amplitude = getInternalParameterValue("amplitude");
     g.pushMatrix();
     g.translate(amplitude, amplitude, -4);
@@ -133,22 +141,22 @@ public:
 
   virtual void onTriggerOn() override {
 
-    mEnvStri.attack(getInternalParameterValue("attackStri"));
-    mEnvStri.decay(getInternalParameterValue("attackStri"));
-    mEnvStri.sustain(getInternalParameterValue("sustainStri"));
-    mEnvStri.release(getInternalParameterValue("releaseStri"));
+    mEnvStri.attack(pAttackStri.get());
+    mEnvStri.decay(pAttackStri.get());
+    mEnvStri.sustain(pSustainStri.get());
+    mEnvStri.release(pReleaseStri.get());
 
-    mEnvLow.attack(getInternalParameterValue("attackLow"));
-    mEnvLow.decay(getInternalParameterValue("attackLow"));
-    mEnvLow.sustain(getInternalParameterValue("sustainLow"));
-    mEnvLow.release(getInternalParameterValue("releaseLow"));
+    mEnvLow.attack(pAttackLow.get());
+    mEnvLow.decay(pAttackLow.get());
+    mEnvLow.sustain(pSustainLow.get());
+    mEnvLow.release(pReleaseLow.get());
 
-    mEnvUp.attack(getInternalParameterValue("attackUp"));
-    mEnvUp.decay(getInternalParameterValue("attackUp"));
-    mEnvUp.sustain(getInternalParameterValue("sustainUp"));
-    mEnvUp.release(getInternalParameterValue("releaseUp"));
+    mEnvUp.attack(pAttackUp.get());
+    mEnvUp.decay(pAttackUp.get());
+    mEnvUp.sustain(pSustainUp.get());
+    mEnvUp.release(pReleaseUp.get());
 
-    mPan.pos(getInternalParameterValue("pan"));
+    mPan.pos(pPan.get());
 
     mEnvStri.reset();
     mEnvLow.reset();
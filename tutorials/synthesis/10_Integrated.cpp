@@ -1,4 +1,6 @@
 
+#include <atomic>
+
 #include "Gamma/Analysis.h"
 #include "Gamma/Effects.h"
 #include "Gamma/Envelope.h"
@@ -12,13 +14,14 @@
 #include "al/ui/al_ControlGUI.hpp"
 #include "al/ui/al_Parameter.hpp"
 
+#include "BlockProcessing.h"
+#include "ControlRateReson.h"
+#include "ParamHandle.h"
+#include "WavetableBank.h"
+
 // using namespace gam;
 using namespace al;
 using namespace std;
-// tables for oscillator
-gam::ArrayPow2<float> tbSaw(2048), tbSqr(2048), tbImp(2048), tbSin(2048),
-    tbPls(2048), tbDin(2048), tb__1(2048), tb__2(2048), tb__3(2048),
-    tb__4(2048);
 class OscEnv : public SynthVoice {
 public:
   // Unit generators
@@ -86,36 +89,10 @@ public:
   virtual void onTriggerOn() override {
     mAmpEnv.reset();
     updateFromParameters();
-    // Map table number to table in memory
-    switch (int(getInternalParameterValue("table"))) {
-    case 0:
-      mOsc.source(tbSaw);
-      break;
-    case 1:
-      mOsc.source(tbSqr);
-      break;
-    case 2:
-      mOsc.source(tbImp);
-      break;
-    case 3:
-      mOsc.source(tbSin);
-      break;
-    case 4:
-      mOsc.source(tbPls);
-      break;
-    case 5:
-      mOsc.source(tb__1);
-      break;
-    case 6:
-      mOsc.source(tb__2);
-      break;
-    case 7:
-      mOsc.source(tb__3);
-      break;
-    case 8:
-      mOsc.source(tb__4);
-      break;
-    }
+    // Band-limited table for the note's frequency
+    mOsc.source(WavetableBank::get().table(
+        int(getInternalParameterValue("table")),
+        getInternalParameterValue("frequency")));
   }
 
   virtual void onTriggerOff() override { mAmpEnv.triggerRelease(); }
@@ -206,36 +183,11 @@ public:
 
     mAmpEnv.reset();
     mVibEnv.reset();
-    // Map table number to table in memory
-    switch (int(getInternalParameterValue("table"))) {
-    case 0:
-      mOsc.source(tbSaw);
-      break;
-    case 1:
-      mOsc.source(tbSqr);
-      break;
-    case 2:
-      mOsc.source(tbImp);
-      break;
-    case 3:
-      mOsc.source(tbSin);
-      break;
-    case 4:
-      mOsc.source(tbPls);
-      break;
-    case 5:
-      mOsc.source(tb__1);
-      break;
-    case 6:
-      mOsc.source(tb__2);
-      break;
-    case 7:
-      mOsc.source(tb__3);
-      break;
-    case 8:
-      mOsc.source(tb__4);
-      break;
-    }
+    // Band-limited for the top of the vibrato
+    mOsc.source(WavetableBank::get().table(
+        int(getInternalParameterValue("table")),
+        getInternalParameterValue("frequency") *
+            (1 + getInternalParameterValue("vibDepth"))));
   }
 
   void onTriggerOff() override {
@@ -488,36 +440,10 @@ public:
     mAmpEnv.reset();
     mTrmEnv.reset();
 
-    // Map table number to table in memory
-    switch (int(getInternalParameterValue("table"))) {
-    case 0:
-      mOsc.source(tbSaw);
-      break;
-    case 1:
-      mOsc.source(tbSqr);
-      break;
-    case 2:
-      mOsc.source(tbImp);
-      break;
-    case 3:
-      mOsc.source(tbSin);
-      break;
-    case 4:
-      mOsc.source(tbPls);
-      break;
-    case 5:
-      mOsc.source(tb__1);
-      break;
-    case 6:
-      mOsc.source(tb__2);
-      break;
-    case 7:
-      mOsc.source(tb__3);
-      break;
-    case 8:
-      mOsc.source(tb__4);
-      break;
-    }
+    // Band-limited table for the note's frequency
+    mOsc.source(WavetableBank::get().table(
+        int(getInternalParameterValue("table")),
+        getInternalParameterValue("frequency")));
   }
 
   virtual void onTriggerOff() override {
@@ -641,21 +567,15 @@ public:
 
     mAmpEnv.reset();
     mAMEnv.reset();
-    // Map table number to table in memory
-    switch (int(getInternalParameterValue("amFunc"))) {
-    case 0:
-      mAM.source(tbSin);
-      break;
-    case 1:
-      mAM.source(tbSqr);
-      break;
-    case 2:
-      mAM.source(tbPls);
-      break;
-    case 3:
-      mAM.source(tbDin);
-      break;
-    }
+    // Map the AM function number to a table, band limited for the AM
+    // frequency
+    static const int amTables[] = {WavetableBank::SINE, WavetableBank::SQUARE,
+                                   WavetableBank::PULSE, WavetableBank::DIN};
+    int amFunc =
+        std::min(std::max(int(getInternalParameterValue("amFunc")), 0), 3);
+    mAM.source(WavetableBank::get().table(
+        amTables[amFunc], getInternalParameterValue("frequency") *
+                              getInternalParameterValue("amRatio")));
   }
 
   virtual void onTriggerOff() override {
@@ -820,9 +740,15 @@ public:
       mEnvFollow; // envelope follower to connect audio output to graphics
   gam::DSF<> mOsc;
   gam::NoiseWhite<> mNoise;
-  gam::Reson<> mRes;
-  gam::Env<2> mCFEnv;
+  ControlRateReson mRes;
+  gam::Env<2> mCFEnv; // Run at control rate in mRes.controlDomain()
   gam::Env<2> mBWEnv;
+  // Handles to the trigger parameters, bound in init()
+  ParamHandle pAmplitude, pFrequency, pAttackTime, pReleaseTime, pSustain,
+      pCurve, pNoise, pEnvDur, pCf1, pCf2, pCfRise, pBw1, pBw2, pBwRise,
+      pHmnum, pHmamp, pPan;
+  // Set when a parameter changes, so updateFromParameters() only runs then
+  std::atomic<bool> mParamsChanged{true};
   // Additional members
   Mesh mMesh;
 
@@ -834,59 +760,74 @@ public:
     mAmpEnv.sustainPoint(2); // Make point 2 sustain until a release is issued
     mCFEnv.curve(0);
     mBWEnv.curve(0);
+    mCFEnv.domain(mRes.controlDomain());
+    mBWEnv.domain(mRes.controlDomain());
     mOsc.harmonics(12);
     // We have the mesh be a sphere
     addDisc(mMesh, 1.0, 30);
 
-    createInternalTriggerParameter("amplitude", 0.3, 0.0, 1.0);
-    createInternalTriggerParameter("frequency", 60, 20, 5000);
-    createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0);
-    createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0);
-    createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0);
-    createInternalTriggerParameter("curve", 4.0, -10.0, 10.0);
-    createInternalTriggerParameter("noise", 0.0, 0.0, 1.0);
-    createInternalTriggerParameter("envDur", 1, 0.0, 5.0);
-    createInternalTriggerParameter("cf1", 400.0, 10.0, 5000);
-    createInternalTriggerParameter("cf2", 400.0, 10.0, 5000);
-    createInternalTriggerParameter("cfRise", 0.5, 0.1, 2);
-    createInternalTriggerParameter("bw1", 700.0, 10.0, 5000);
-    createInternalTriggerParameter("bw2", 900.0, 10.0, 5000);
-    createInternalTriggerParameter("bwRise", 0.5, 0.1, 2);
-    createInternalTriggerParameter("hmnum", 12.0, 5.0, 20.0);
-    createInternalTriggerParameter("hmamp", 1.0, 0.0, 1.0);
-    createInternalTriggerParameter("pan", 0.0, -1.0, 1.0);
+    pAmplitude.bind(createInternalTriggerParameter("amplitude", 0.3, 0.0, 1.0));
+    pFrequency.bind(createInternalTriggerParameter("frequency", 60, 20, 5000));
+    pAttackTime.bind(
+        createInternalTriggerParameter("attackTime", 0.1, 0.01, 3.0));
+    pReleaseTime.bind(
+        createInternalTriggerParameter("releaseTime", 3.0, 0.1, 10.0));
+    pSustain.bind(createInternalTriggerParameter("sustain", 0.7, 0.0, 1.0));
+    pCurve.bind(createInternalTriggerParameter("curve", 4.0, -10.0, 10.0));
+    pNoise.bind(createInternalTriggerParameter("noise", 0.0, 0.0, 1.0));
+    pEnvDur.bind(createInternalTriggerParameter("envDur", 1, 0.0, 5.0));
+    pCf1.bind(createInternalTriggerParameter("cf1", 400.0, 10.0, 5000));
+    pCf2.bind(createInternalTriggerParameter("cf2", 400.0, 10.0, 5000));
+    pCfRise.bind(createInternalTriggerParameter("cfRise", 0.5, 0.1, 2));
+    pBw1.bind(createInternalTriggerParameter("bw1", 700.0, 10.0, 5000));
+    pBw2.bind(createInternalTriggerParameter("bw2", 900.0, 10.0, 5000));
+    pBwRise.bind(createInternalTriggerParameter("bwRise", 0.5, 0.1, 2));
+    pHmnum.bind(createInternalTriggerParameter("hmnum", 12.0, 5.0, 20.0));
+    pHmamp.bind(createInternalTriggerParameter("hmamp", 1.0, 0.0, 1.0));
+    pPan.bind(createInternalTriggerParameter("pan", 0.0, -1.0, 1.0));
+
+    for (ParamHandle *handle :
+         {&pFrequency, &pAttackTime, &pReleaseTime, &pSustain, &pCurve,
+          &pEnvDur, &pCf1, &pCf2, &pCfRise, &pBw1, &pBw2, &pBwRise, &pHmnum,
+          &pHmamp, &pPan}) {
+      handle->param->registerChangeCallback(
+          [this](float) { mParamsChanged = true; });
+    }
   }
 
   //
 
   virtual void onProcess(AudioIOData &io) override {
-    updateFromParameters();
-    float amp = getInternalParameterValue("amplitude");
-    float noiseMix = getInternalParameterValue("noise");
-    while (io()) {
+    if (mParamsChanged.exchange(false)) {
+      updateFromParameters();
+    }
+    float amp = pAmplitude.get();
+    float noiseMix = pNoise.get();
+    float g1, g2;
+    mPan(1.f, g1, g2);
+    block::forEachChunk(io, [&](int frame, int n) {
+      float s1[block::chunkSize], env[block::chunkSize];
       // mix oscillator with noise
-      float s1 = mOsc() * (1 - noiseMix) + mNoise() * noiseMix;
-
+      for (int i = 0; i < n; i++) {
+        s1[i] = mOsc() * (1 - noiseMix) + mNoise() * noiseMix;
+      }
       // apply resonant filter
-      mRes.set(mCFEnv(), mBWEnv());
-      s1 = mRes(s1);
-
+      mRes.process(s1, n, mCFEnv, mBWEnv);
       // appy amplitude envelope
-      s1 *= mAmpEnv() * amp;
-
-      float s2;
-      mPan(s1, s1, s2);
-      io.out(0) += s1;
-      io.out(1) += s2;
-    }
+      block::generate(mAmpEnv, env, n);
+      block::multiply(s1, env, n);
+      block::scale(s1, amp, n);
+      block::mixStereo(io.outBuffer(0) + frame, io.outBuffer(1) + frame, s1,
+                       g1, g2, n);
+    });
 
     if (mAmpEnv.done() && (mEnvFollow.value() < 0.001f))
       free();
   }
 
   virtual void onProcess(Graphics &g) {
-    float frequency = getInternalParameterValue("frequency");
-    float amplitude = getInternalParameterValue("amplitude");
+    float frequency = pFrequency.get();
+    float amplitude = pAmplitude.get();
     g.pushMatrix();
     g.translate(amplitude, amplitude, -4);
     // g.scale(frequency/2000, frequency/4000, 1);
@@ -897,7 +838,10 @@ public:
     g.popMatrix();
   }
   virtual void onTriggerOn() override {
+    mParamsChanged = false;
     updateFromParameters();
+    mRes.sampleRate(gam::sampleRate());
+    mRes.reset();
     mAmpEnv.reset();
     mCFEnv.reset();
     mBWEnv.reset();
@@ -910,31 +854,27 @@ public:
   }
 
   void updateFromParameters() {
-    mOsc.freq(getInternalParameterValue("frequency"));
-    mOsc.harmonics(getInternalParameterValue("hmnum"));
-    mOsc.ampRatio(getInternalParameterValue("hmamp"));
-    mAmpEnv.attack(getInternalParameterValue("attackTime"));
+    mOsc.freq(pFrequency.get());
+    mOsc.harmonics(pHmnum.get());
+    mOsc.ampRatio(pHmamp.get());
+    mAmpEnv.attack(pAttackTime.get());
     //    mAmpEnv.decay(getInternalParameterValue("attackTime"));
-    mAmpEnv.release(getInternalParameterValue("releaseTime"));
-    mAmpEnv.levels()[1] = getInternalParameterValue("sustain");
-    mAmpEnv.levels()[2] = getInternalParameterValue("sustain");
-
-    mAmpEnv.curve(getInternalParameterValue("curve"));
-    mPan.pos(getInternalParameterValue("pan"));
-    mCFEnv.levels(getInternalParameterValue("cf1"),
-                  getInternalParameterValue("cf2"),
-                  getInternalParameterValue("cf1"));
-
-    mCFEnv.lengths()[0] = getInternalParameterValue("cfRise");
-    mCFEnv.lengths()[1] = 1 - getInternalParameterValue("cfRise");
-    mBWEnv.levels(getInternalParameterValue("bw1"),
-                  getInternalParameterValue("bw2"),
-                  getInternalParameterValue("bw1"));
-    mBWEnv.lengths()[0] = getInternalParameterValue("bwRise");
-    mBWEnv.lengths()[1] = 1 - getInternalParameterValue("bwRise");
-
-    mCFEnv.totalLength(getInternalParameterValue("envDur"));
-    mBWEnv.totalLength(getInternalParameterValue("envDur"));
+    mAmpEnv.release(pReleaseTime.get());
+    mAmpEnv.levels()[1] = pSustain.get();
+    mAmpEnv.levels()[2] = pSustain.get();
+
+    mAmpEnv.curve(pCurve.get());
+    mPan.pos(pPan.get());
+    mCFEnv.levels(pCf1.get(), pCf2.get(), pCf1.get());
+
+    mCFEnv.lengths()[0] = pCfRise.get();
+    mCFEnv.lengths()[1] = 1 - pCfRise.get();
+    mBWEnv.levels(pBw1.get(), pBw2.get(), pBw1.get());
+    mBWEnv.lengths()[0] = pBwRise.get();
+    mBWEnv.lengths()[1] = 1 - pBwRise.get();
+
+    mCFEnv.totalLength(pEnvDur.get());
+    mBWEnv.totalLength(pEnvDur.get());
   }
 };
 
@@ -1054,48 +994,8 @@ public:
     // Additive Synth Related
     initScaleToHarmonicSeries();
     initScaleTo12TET(110);
-    // Tremolo
-    gam::addSinesPow<1>(tbSaw, 9, 1);
-    gam::addSinesPow<1>(tbSqr, 9, 2);
-    gam::addSinesPow<0>(tbImp, 9, 1);
-    gam::addSine(tbSin);
-
-    {
-      float A[] = {1, 1, 1, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tbPls, A, 8);
-    }
-
-    {
-      float A[] = {1, 0.4, 0.65, 0.3, 0.18, 0.08};
-      float C[] = {1, 4, 7, 11, 15, 18};
-      gam::addSines(tb__1, A, C, 6);
-    }
-
-    // inharmonic partials
-    {
-      float A[] = {0.5, 0.8, 0.7, 1, 0.3, 0.4, 0.2, 0.12};
-      float C[] = {3, 4, 7, 8, 11, 12, 15, 16};
-      gam::addSines(tb__2, A, C, 8);
-    }
-
-    // inharmonic partials
-    {
-      float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08};
-      float C[] = {10, 27, 54, 81, 108, 135};
-      gam::addSines(tb__3, A, C, 6);
-    }
-
-    // harmonics 20-27
-    {
-      float A[] = {0.2, 0.4, 0.6, 1, 0.7, 0.5, 0.3, 0.1};
-      gam::addSines(tb__4, A, 8, 20);
-    }
-
-    {
-      float A[] = {1, 0.7, 0.45, 0.3, 0.15, 0.08};
-      float C[] = {10, 27, 54, 81, 108, 135};
-      addSines(tbDin, A, C, 6);
-    }
+    // Oscillator tables, shared by all voices
+    WavetableBank::get();
   }
   void onCreate() override {
     // Play example sequence. Comment this line to start from scratch